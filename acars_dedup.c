@@ -0,0 +1,161 @@
+/*
+ * ACARS duplicate suppression cache
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * ACARS duplicate suppression cache -- ring of recent keys plus a
+ * chained hash index
+ */
+
+#include <string.h>
+
+#include "acars_dedup.h"
+
+#define DEDUP_BUCKETS  (ACARS_DEDUP_ENTRIES * 2)   /* power of two */
+
+typedef struct {
+    uint64_t hash;
+    uint64_t ts;
+    int32_t next;        /* next entry in the same bucket, -1 = end */
+    uint8_t ul;
+    char reg[7];
+    char label[2];
+    char msg_num[4];
+} dedup_entry_t;
+
+static dedup_entry_t entries[ACARS_DEDUP_ENTRIES];
+static int32_t buckets[DEDUP_BUCKETS];
+static int head = 0;        /* oldest entry */
+static int count = 0;
+static uint64_t window_ns = 0;
+
+static uint64_t n_lookups = 0;
+static uint64_t n_hits = 0;
+static uint64_t n_evicted = 0;
+
+void acars_dedup_init(int window_sec)
+{
+    window_ns = window_sec > 0 ? (uint64_t)window_sec * 1000000000ULL : 0;
+    head = 0;
+    count = 0;
+    n_lookups = n_hits = n_evicted = 0;
+    for (int i = 0; i < DEDUP_BUCKETS; i++)
+        buckets[i] = -1;
+}
+
+/* ---- Key extraction ---- */
+
+/* FNV-1a, 64-bit */
+static uint64_t hash_bytes(const uint8_t *p, int len, uint64_t h)
+{
+    for (int i = 0; i < len; i++) {
+        h ^= p[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+static void make_key(const uint8_t *sbd, int len, int ul, dedup_entry_t *e)
+{
+    memset(e, 0, sizeof(*e));
+    e->ul = (uint8_t)ul;
+
+    /* Skip SOH and the optional 8-byte SBD header, which can differ
+     * between copies of the same message */
+    const uint8_t *p = sbd + 1;
+    int n = len - 1;
+    if (n >= 8 && p[0] == 0x03) {
+        p += 8;
+        n -= 8;
+    }
+
+    e->hash = hash_bytes(p, n, 0xcbf29ce484222325ULL ^ (uint64_t)ul);
+
+    /* mode(1) reg(7) ack(1) label(2) blk_id(1) STX msg_num(4) */
+    if (n >= 11) {
+        for (int i = 0; i < 7; i++)
+            e->reg[i] = (char)(p[1 + i] & 0x7f);
+        e->label[0] = (char)(p[9] & 0x7f);
+        e->label[1] = (char)(p[10] & 0x7f);
+    }
+    if (ul && n >= 17 && (p[12] & 0x7f) == 0x02) {
+        for (int i = 0; i < 4; i++)
+            e->msg_num[i] = (char)(p[13 + i] & 0x7f);
+    }
+}
+
+static int same_key(const dedup_entry_t *a, const dedup_entry_t *b)
+{
+    return a->hash == b->hash && a->ul == b->ul &&
+           memcmp(a->reg, b->reg, sizeof(a->reg)) == 0 &&
+           memcmp(a->label, b->label, sizeof(a->label)) == 0 &&
+           memcmp(a->msg_num, b->msg_num, sizeof(a->msg_num)) == 0;
+}
+
+/* ---- Ring ---- */
+
+static void pop_oldest(void)
+{
+    dedup_entry_t *e = &entries[head];
+    int32_t *link = &buckets[e->hash & (DEDUP_BUCKETS - 1)];
+    while (*link != -1 && *link != head)
+        link = &entries[*link].next;
+    if (*link == head)
+        *link = e->next;
+
+    head = (head + 1) % ACARS_DEDUP_ENTRIES;
+    count--;
+}
+
+int acars_dedup_check(const uint8_t *sbd, int len, int ul, uint64_t ts_ns)
+{
+    if (window_ns == 0 || len < 2)
+        return 0;
+
+    n_lookups++;
+
+    /* Expire from the old end; copies from another satellite can arrive
+     * slightly out of order, so only strictly older entries go */
+    while (count > 0 && ts_ns > entries[head].ts + window_ns)
+        pop_oldest();
+
+    dedup_entry_t key;
+    make_key(sbd, len, ul, &key);
+
+    uint32_t b = key.hash & (DEDUP_BUCKETS - 1);
+    for (int32_t i = buckets[b]; i != -1; i = entries[i].next) {
+        if (same_key(&entries[i], &key)) {
+            n_hits++;
+            return 1;
+        }
+    }
+
+    if (count == ACARS_DEDUP_ENTRIES) {
+        pop_oldest();
+        n_evicted++;
+    }
+
+    int slot = (head + count) % ACARS_DEDUP_ENTRIES;
+    key.ts = ts_ns;
+    key.next = buckets[b];
+    entries[slot] = key;
+    buckets[b] = slot;
+    count++;
+    return 0;
+}
+
+void acars_dedup_stats(uint64_t *lookups, uint64_t *hits, uint64_t *evicted)
+{
+    *lookups = n_lookups;
+    *hits = n_hits;
+    *evicted = n_evicted;
+}
+
+void acars_dedup_shutdown(void)
+{
+    window_ns = 0;
+    count = 0;
+}
@@ -0,0 +1,46 @@
+/*
+ * ACARS duplicate suppression cache
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * ACARS duplicate suppression cache
+ *
+ * The same ACARS message is often reassembled more than once: two
+ * satellites or beams carry the same downlink, and IDA retransmits
+ * blocks that were not acknowledged. Each message is keyed by a hash of
+ * its ACARS bytes (SBD header stripped, CRC included) plus the
+ * registration, label and message number. A key seen again within the
+ * window is a duplicate and is dropped before libacars parsing or any
+ * output.
+ *
+ * Entries live in a fixed ring in arrival order, so expiry only pops the
+ * oldest end; a hash table of chained ring indices gives O(1) lookup.
+ * When the ring is full the oldest entry is evicted early. Not thread
+ * safe: used only from the ACARS sink's worker thread.
+ */
+
+#ifndef __ACARS_DEDUP_H__
+#define __ACARS_DEDUP_H__
+
+#include <stdint.h>
+
+#define ACARS_DEDUP_DEFAULT_SEC  30
+#define ACARS_DEDUP_ENTRIES      4096
+
+/* Start the cache with the given window. window_sec <= 0 disables it. */
+void acars_dedup_init(int window_sec);
+
+/* Check an SBD payload starting with the ACARS SOH (0x01) at timestamp
+ * ts_ns. Returns 1 if the same message was seen within the window, else
+ * records it and returns 0. */
+int acars_dedup_check(const uint8_t *sbd, int len, int ul, uint64_t ts_ns);
+
+/* Lookups, hits and entries evicted before their window ran out */
+void acars_dedup_stats(uint64_t *lookups, uint64_t *hits, uint64_t *evicted);
+
+void acars_dedup_shutdown(void);
+
+#endif
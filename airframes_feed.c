@@ -0,0 +1,379 @@
+/*
+ * airframes.io TCP feeder
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * airframes.io TCP feeder -- backlog, non-blocking connect, backoff
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "airframes_feed.h"
+
+/* ---- State ---- */
+
+typedef struct {
+    char *data;
+    size_t len;
+} af_msg_t;
+
+static char *af_host = NULL;
+static int af_port = 0;
+static int af_active = 0;
+
+static pthread_t af_thread;
+static pthread_mutex_t af_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t af_cond = PTHREAD_COND_INITIALIZER;
+static int af_stop = 0;
+static atomic_ulong af_drain_deadline;  /* set by shutdown, 0 while running */
+
+/* Backlog ring (drop-oldest), guarded by af_lock */
+static af_msg_t af_ring[AF_BACKLOG_MAX];
+static int af_head = 0, af_count = 0;
+
+/* Feeder thread only */
+static int af_fd = -1;
+static unsigned long af_next_attempt = 0;
+static unsigned long af_backoff = AF_BACKOFF_MIN_MS;
+
+static atomic_ulong af_n_sent;
+static atomic_ulong af_n_dropped;
+static atomic_ulong af_n_connects;
+static atomic_ulong af_n_failures;
+
+static unsigned long af_now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* ---- Connection ---- */
+
+static void af_retry_later(const char *what, const char *why);
+
+static void af_disconnect(const char *why)
+{
+    if (af_fd < 0)
+        return;
+    close(af_fd);
+    af_fd = -1;
+    af_retry_later("disconnected", why);
+}
+
+/* Schedule the next attempt and double the backoff. The backoff only
+ * resets once a message has been delivered, so a server that accepts and
+ * immediately drops the connection is not hammered either. */
+static void af_retry_later(const char *what, const char *why)
+{
+    atomic_fetch_add(&af_n_failures, 1);
+    af_next_attempt = af_now_ms() + af_backoff;
+    fprintf(stderr, "ACARS: airframes %s:%d %s (%s), retry in %lus\n",
+            af_host, af_port, what, why, af_backoff / 1000);
+    af_backoff *= 2;
+    if (af_backoff > AF_BACKOFF_MAX_MS)
+        af_backoff = AF_BACKOFF_MAX_MS;
+}
+
+static void af_connect_failed(const char *why)
+{
+    af_retry_later("connect failed", why);
+}
+
+static void af_connect(void)
+{
+    char port_str[16];
+    snprintf(port_str, sizeof(port_str), "%d", af_port);
+
+    struct addrinfo hints = { .ai_family = AF_INET, .ai_socktype = SOCK_STREAM };
+    struct addrinfo *res = NULL;
+    int gai = getaddrinfo(af_host, port_str, &hints, &res);
+    if (gai != 0 || !res) {
+        af_connect_failed(gai ? gai_strerror(gai) : "no address");
+        return;
+    }
+
+    int fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    if (fd < 0) {
+        freeaddrinfo(res);
+        af_connect_failed(strerror(errno));
+        return;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    int r = connect(fd, res->ai_addr, res->ai_addrlen);
+    freeaddrinfo(res);
+    if (r != 0 && errno != EINPROGRESS) {
+        close(fd);
+        af_connect_failed(strerror(errno));
+        return;
+    }
+
+    if (r != 0) {
+        struct pollfd pfd = { .fd = fd, .events = POLLOUT };
+        int err = 0;
+        socklen_t errlen = sizeof(err);
+        r = poll(&pfd, 1, AF_CONNECT_MS);
+        if (r == 0) {
+            close(fd);
+            af_connect_failed("timed out");
+            return;
+        }
+        if (r < 0 || getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &errlen) != 0
+                  || err != 0) {
+            close(fd);
+            af_connect_failed(strerror(err ? err : errno));
+            return;
+        }
+    }
+
+    /* Disable Nagle for low-latency sends */
+    int flag = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+
+    af_fd = fd;
+    if (atomic_fetch_add(&af_n_connects, 1) == 0)
+        fprintf(stderr, "ACARS: airframes TCP stream -> %s:%d\n",
+                af_host, af_port);
+    else
+        fprintf(stderr, "ACARS: reconnected to airframes %s:%d\n",
+                af_host, af_port);
+}
+
+/* The server never sends anything; readable means closed or reset */
+static int af_peer_closed(void)
+{
+    struct pollfd pfd = { .fd = af_fd, .events = POLLIN };
+    if (poll(&pfd, 1, 0) <= 0)
+        return 0;
+    char c;
+    ssize_t n = recv(af_fd, &c, 1, MSG_DONTWAIT);
+    return n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK);
+}
+
+/* Write buf completely. Returns 0 on success, -1 if the connection
+ * failed, made no progress for AF_STALL_MS, or shutdown's drain period
+ * ran out. Polls in short slices so shutdown is never held up. */
+static int af_write_all(const char *buf, size_t len)
+{
+    size_t off = 0;
+    unsigned long last_progress = af_now_ms();
+
+    while (off < len) {
+        ssize_t n = send(af_fd, buf + off, len - off, MSG_NOSIGNAL);
+        if (n > 0) {
+            off += n;
+            last_progress = af_now_ms();
+            continue;
+        }
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            return -1;
+
+        struct pollfd pfd = { .fd = af_fd, .events = POLLOUT };
+        if (poll(&pfd, 1, 100) < 0 || (pfd.revents & (POLLERR | POLLHUP)))
+            return -1;
+
+        unsigned long now = af_now_ms();
+        unsigned long deadline = atomic_load(&af_drain_deadline);
+        if (now - last_progress >= AF_STALL_MS || (deadline && now >= deadline))
+            return -1;
+    }
+    return 0;
+}
+
+static int af_send_msg(const af_msg_t *m)
+{
+    if (af_write_all(m->data, m->len) != 0 || af_write_all("\n", 1) != 0) {
+        af_disconnect("write failed or stalled");
+        return -1;
+    }
+    atomic_fetch_add(&af_n_sent, 1);
+    af_backoff = AF_BACKOFF_MIN_MS;
+    return 0;
+}
+
+/* ---- Backlog ---- */
+
+static void af_push_locked(char *data, size_t len)
+{
+    if (af_count == AF_BACKLOG_MAX) {
+        free(af_ring[af_head].data);
+        af_head = (af_head + 1) % AF_BACKLOG_MAX;
+        af_count--;
+        atomic_fetch_add(&af_n_dropped, 1);
+    }
+    int tail = (af_head + af_count) % AF_BACKLOG_MAX;
+    af_ring[tail].data = data;
+    af_ring[tail].len = len;
+    af_count++;
+}
+
+static af_msg_t af_pop_locked(void)
+{
+    af_msg_t m = af_ring[af_head];
+    af_head = (af_head + 1) % AF_BACKLOG_MAX;
+    af_count--;
+    return m;
+}
+
+static void af_timedwait_locked(unsigned long ms)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += ms / 1000;
+    ts.tv_nsec += (ms % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    pthread_cond_timedwait(&af_cond, &af_lock, &ts);
+}
+
+/* ---- Feeder thread ---- */
+
+static void *af_thread_fn(void *arg)
+{
+    (void)arg;
+    af_msg_t pending = { NULL, 0 };     /* popped but not yet delivered */
+
+    while (1) {
+        pthread_mutex_lock(&af_lock);
+        unsigned long drain_deadline = atomic_load(&af_drain_deadline);
+        if (af_stop && (af_fd < 0 || (!pending.data && af_count == 0)
+                        || af_now_ms() >= drain_deadline)) {
+            pthread_mutex_unlock(&af_lock);
+            break;
+        }
+
+        if (af_fd < 0) {
+            unsigned long now = af_now_ms();
+            if (now < af_next_attempt) {
+                af_timedwait_locked(af_next_attempt - now);
+                pthread_mutex_unlock(&af_lock);
+                continue;
+            }
+            pthread_mutex_unlock(&af_lock);
+            af_connect();
+            continue;
+        }
+
+        if (!pending.data) {
+            if (af_count == 0) {
+                af_timedwait_locked(1000);
+                pthread_mutex_unlock(&af_lock);
+                if (af_peer_closed())
+                    af_disconnect("closed the connection");
+                continue;
+            }
+            pending = af_pop_locked();
+        }
+        pthread_mutex_unlock(&af_lock);
+
+        /* On failure the message is retried on the next connection */
+        if (af_send_msg(&pending) == 0) {
+            free(pending.data);
+            pending.data = NULL;
+        }
+    }
+
+    if (pending.data) {
+        free(pending.data);
+        atomic_fetch_add(&af_n_dropped, 1);
+    }
+    return NULL;
+}
+
+/* ---- Public API ---- */
+
+int airframes_feed_init(const char *host, int port)
+{
+    af_host = strdup(host);
+    af_port = port;
+    af_stop = 0;
+    atomic_store(&af_drain_deadline, 0);
+    af_fd = -1;
+    af_next_attempt = 0;
+    af_backoff = AF_BACKOFF_MIN_MS;
+
+    if (pthread_create(&af_thread, NULL, af_thread_fn, NULL) != 0) {
+        free(af_host);
+        af_host = NULL;
+        return -1;
+    }
+#ifdef __linux__
+    pthread_setname_np(af_thread, "airframes");
+#endif
+    af_active = 1;
+    return 0;
+}
+
+int airframes_feed_active(void)
+{
+    return af_active;
+}
+
+void airframes_feed_send(const char *msg, size_t len)
+{
+    if (!af_active)
+        return;
+
+    char *copy = malloc(len);
+    if (!copy)
+        return;
+    memcpy(copy, msg, len);
+
+    pthread_mutex_lock(&af_lock);
+    af_push_locked(copy, len);
+    pthread_cond_signal(&af_cond);
+    pthread_mutex_unlock(&af_lock);
+}
+
+void airframes_feed_shutdown(void)
+{
+    if (!af_active)
+        return;
+
+    pthread_mutex_lock(&af_lock);
+    atomic_store(&af_drain_deadline, af_now_ms() + AF_DRAIN_MS);
+    af_stop = 1;
+    pthread_cond_signal(&af_cond);
+    pthread_mutex_unlock(&af_lock);
+    pthread_join(af_thread, NULL);
+
+    /* Anything left in the backlog is lost */
+    while (af_count > 0) {
+        af_msg_t m = af_pop_locked();
+        free(m.data);
+        atomic_fetch_add(&af_n_dropped, 1);
+    }
+
+    if (af_fd >= 0) {
+        close(af_fd);
+        af_fd = -1;
+    }
+    fprintf(stderr, "ACARS: airframes feed %lu sent, %lu dropped, "
+            "%lu connects, %lu failures\n",
+            atomic_load(&af_n_sent), atomic_load(&af_n_dropped),
+            atomic_load(&af_n_connects), atomic_load(&af_n_failures));
+
+    free(af_host);
+    af_host = NULL;
+    af_active = 0;
+}
@@ -0,0 +1,47 @@
+/*
+ * airframes.io TCP feeder
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * airframes.io TCP feeder
+ *
+ * Newline-delimited JSON messages (iridium-toolkit format) are queued in a
+ * bounded in-memory backlog and written by a dedicated "airframes" thread,
+ * so a slow, stalled or unreachable server never blocks ACARS decoding.
+ *
+ * The thread connects without blocking (poll() with a timeout), retries
+ * with exponential backoff (reset after a successful delivery), and drops
+ * the connection when a write makes no progress for AF_STALL_MS. When the
+ * backlog is full the oldest message is dropped.
+ */
+
+#ifndef __AIRFRAMES_FEED_H__
+#define __AIRFRAMES_FEED_H__
+
+#include <stddef.h>
+
+#define AF_BACKLOG_MAX      1024        /* queued messages */
+#define AF_CONNECT_MS       5000        /* connect() timeout */
+#define AF_STALL_MS         10000       /* write without progress */
+#define AF_BACKOFF_MIN_MS   1000
+#define AF_BACKOFF_MAX_MS   60000
+#define AF_DRAIN_MS         2000        /* shutdown grace period */
+
+/* Start the feeder thread for host:port. Returns 0 on success. */
+int airframes_feed_init(const char *host, int port);
+
+/* Non-zero once airframes_feed_init() has succeeded */
+int airframes_feed_active(void);
+
+/* Queue one message (the newline is appended by the feeder). Never
+ * blocks on the network. */
+void airframes_feed_send(const char *msg, size_t len);
+
+/* Try to drain the backlog for up to AF_DRAIN_MS, stop the thread and
+ * print the sent/dropped/connect counters to stderr */
+void airframes_feed_shutdown(void);
+
+#endif
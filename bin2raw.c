@@ -0,0 +1,148 @@
+/*
+ * iridium-bin2raw: convert --output-format=bin streams to RAW text
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * iridium-bin2raw: convert --output-format=bin streams to RAW text
+ *
+ * Reads a binary frame stream (see frame_bin.h) from a file or stdin and
+ * writes the iridium-toolkit RAW lines iridium-sniffer would have printed,
+ * byte for byte:
+ *
+ *   iridium-bin2raw capture.bin | python3 iridium-toolkit/iridium-parser.py
+ */
+
+#include <err.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "frame_bin.h"
+
+static int read_full(FILE *f, void *buf, size_t len)
+{
+    return fread(buf, 1, len, f) == len;
+}
+
+/* Read one stream header. Returns 1 on success, 0 on clean EOF. */
+static int read_header(FILE *f, uint64_t *t0, char *info, size_t info_size)
+{
+    uint8_t hdr[FRAME_BIN_HEADER_LEN];
+
+    size_t n = fread(hdr, 1, sizeof(hdr), f);
+    if (n == 0)
+        return 0;
+    if (n != sizeof(hdr) || memcmp(hdr, FRAME_BIN_MAGIC, 4) != 0)
+        errx(1, "not an iridium-sniffer binary frame stream");
+
+    int version = fb_get16(hdr + 4);
+    if (version != FRAME_BIN_VERSION)
+        errx(1, "unsupported stream version %d (expected %d)",
+             version, FRAME_BIN_VERSION);
+
+    size_t info_len = fb_get16(hdr + 6);
+    *t0 = fb_get64(hdr + 8);
+
+    if (info_len >= info_size)
+        errx(1, "file_info too long (%zu bytes)", info_len);
+    if (!read_full(f, info, info_len))
+        errx(1, "truncated stream header");
+    info[info_len] = '\0';
+    return 1;
+}
+
+static void convert(FILE *f)
+{
+    static frame_bin_rec_t r;
+    static char line[FRAME_BIN_MAX_BITS + 256];
+    uint8_t rec[0x10000];
+    char info[0x10000];
+    uint64_t t0;
+
+    if (!read_header(f, &t0, info, sizeof(info)))
+        return;
+
+    for (;;) {
+        if (fread(rec, 1, 2, f) != 2)
+            break;
+
+        int rec_len = fb_get16(rec);
+
+        /* Concatenated captures: a new header restarts the stream */
+        if (memcmp(rec, FRAME_BIN_MAGIC, 2) == 0) {
+            uint8_t rest[2];
+            if (!read_full(f, rest, 2))
+                errx(1, "truncated record");
+            if (memcmp(rest, FRAME_BIN_MAGIC + 2, 2) == 0) {
+                uint8_t hdr_rest[FRAME_BIN_HEADER_LEN - 4];
+                if (!read_full(f, hdr_rest, sizeof(hdr_rest)))
+                    errx(1, "truncated stream header");
+                if (fb_get16(hdr_rest) != FRAME_BIN_VERSION)
+                    errx(1, "unsupported stream version %d",
+                         fb_get16(hdr_rest));
+                size_t info_len = fb_get16(hdr_rest + 2);
+                t0 = fb_get64(hdr_rest + 4);
+                if (!read_full(f, info, info_len))
+                    errx(1, "truncated stream header");
+                info[info_len] = '\0';
+                continue;
+            }
+            memcpy(rec + 2, rest, 2);
+            if (rec_len < 4 || !read_full(f, rec + 4, rec_len - 4))
+                errx(1, "truncated record");
+        } else {
+            if (rec_len < 3 || !read_full(f, rec + 2, rec_len - 2))
+                errx(1, "truncated record");
+        }
+
+        /* Unknown record types are skipped */
+        if (rec[2] != FRAME_BIN_REC_FRAME)
+            continue;
+
+        if (!frame_bin_decode_frame(rec, rec_len, &r))
+            errx(1, "malformed frame record");
+
+        double ts_ms = (double)(r.timestamp - t0) / 1000000.0;
+        int freq_hz = (int)(r.frequency + 0.5);
+
+        int len = snprintf(line, sizeof(line), FRAME_RAW_FMT,
+                           info, ts_ms, freq_hz,
+                           r.magnitude, r.noise, r.id,
+                           r.confidence, r.level, r.payload_symbols);
+        if (len < 0 || len >= (int)sizeof(line) - r.n_bits - 1)
+            errx(1, "line too long");
+        for (int i = 0; i < r.n_bits; i++)
+            line[len++] = '0' + r.bits[i];
+        line[len++] = '\n';
+        fwrite(line, 1, len, stdout);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1 && (strcmp(argv[1], "-h") == 0 ||
+                     strcmp(argv[1], "--help") == 0)) {
+        fprintf(stderr, "Usage: iridium-bin2raw [FILE...]\n"
+                "Convert iridium-sniffer --output-format=bin streams to "
+                "iridium-toolkit RAW text.\n"
+                "Reads stdin when no FILE is given.\n");
+        return 0;
+    }
+
+    if (argc < 2) {
+        convert(stdin);
+    } else {
+        for (int i = 1; i < argc; i++) {
+            FILE *f = fopen(argv[i], "rb");
+            if (!f)
+                err(1, "Cannot open '%s'", argv[i]);
+            convert(f);
+            fclose(f);
+        }
+    }
+
+    return 0;
+}
@@ -14,8 +14,10 @@
 #include <libbladeRF.h>
 
 #include "sdr.h"
+#include "sample_pool.h"
 
 const unsigned num_transfers = 7;
+static const unsigned buf_samples = 16384;
 
 extern sig_atomic_t running;
 extern pid_t self_pid;
@@ -81,6 +83,12 @@ struct bladerf *bladerf_setup(int id) {
     return bladerf;
 }
 
+/* Samples are converted to cf32; libbladeRF 2.5.0 reports half the count */
+size_t bladerf_block_bytes(void) {
+    return (size_t)buf_samples * (num_samples_workaround ? 2 : 1)
+           * sizeof(float) * 2;
+}
+
 void *bladerf_rx_cb(struct bladerf *bladerf, struct bladerf_stream *stream, struct bladerf_metadata *meta, void *samples, size_t num_samples, void *user_data) {
     unsigned i;
     int16_t *d = (int16_t *)samples;
@@ -89,7 +97,9 @@ void *bladerf_rx_cb(struct bladerf *bladerf, struct bladerf_stream *stream, stru
     if (num_samples_workaround)
         num_samples *= 2;
 
-    sample_buf_t *s = malloc(sizeof(*s) + num_samples * sizeof(float) * 2);
+    sample_buf_t *s = sample_buf_get(num_samples * sizeof(float) * 2, 0);
+    if (s == NULL)
+        return samples;
     s->format = SAMPLE_FMT_FLOAT;
     s->num = num_samples;
     float *out = (float *)s->samples;
@@ -99,7 +109,7 @@ void *bladerf_rx_cb(struct bladerf *bladerf, struct bladerf_stream *stream, stru
     if (running)
         push_samples(s);
     else
-        free(s);
+        sample_buf_release(s);
 
     return samples;
 }
@@ -111,7 +121,6 @@ void *bladerf_stream_thread(void *arg) {
     void **buffers = NULL;
     unsigned timeout;
     int status;
-    unsigned buf_samples = 16384;
 
     if ((status = bladerf_init_stream(&stream, bladerf, bladerf_rx_cb, &buffers, num_transfers, BLADERF_FORMAT_SC16_Q11, buf_samples, num_transfers, NULL)) != 0)
         errx(1, "Unable to initialize bladeRF stream: %s", bladerf_strerror(status));
@@ -9,6 +9,7 @@
 
 void bladerf_list(void);
 struct bladerf *bladerf_setup(int id);
+size_t bladerf_block_bytes(void);   /* after bladerf_setup() */
 void *bladerf_stream_thread(void *arg);
 
 #endif
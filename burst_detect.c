@@ -18,17 +18,24 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <unistd.h>
 
 #include <fftw3.h>
 
 #include "burst_detect.h"
 #include "fftw_lock.h"
+#include "fftw_wisdom.h"
+#include "huge_alloc.h"
 #include "iridium.h"
+#include "logging.h"
 #include "sdr.h"
+#include "sample_pool.h"
 #include "simd_kernels.h"
 #include "window_func.h"
 
-#include "blocking_queue.h"
+#include "burst_pq.h"
+#include "frame_seq.h"
+#include "lf_queue.h"
 
 #ifdef USE_GPU
 #include "burst_fft.h"
@@ -64,12 +71,16 @@ struct _burst_detector {
     int max_bursts;
     int max_burst_len;
     float threshold;        /* pre-computed: pow(10, dB/10) / history_size / ENBW */
+    float threshold_db;
     int history_size;
+    int peak_bin_min;       /* lowest bin searched for new peaks */
 
     /* FFT */
     fftwf_plan fft_plan;
     float complex *fft_in;
     float complex *fft_out;
+    int fft_measured;           /* plan from FFTW_MEASURE wisdom */
+    unsigned wisdom_gen;        /* fftw_wisdom_generation() last tried */
 
     /* Window */
     float *window;
@@ -79,6 +90,7 @@ struct _burst_detector {
     float *baseline_sum;        /* [fft_size] running sum */
     int history_index;
     int history_primed;
+    int history_cap;            /* rows allocated; history_size <= this */
 
     /* Per-FFT frame */
     float *magnitude_shifted;   /* [fft_size] DC-shifted mag^2 */
@@ -117,6 +129,33 @@ struct _burst_detector {
     size_t ringbuf_write;       /* write position (mod ringbuf_size) */
     uint64_t ringbuf_start;     /* absolute sample index of oldest sample */
 
+    /* Ring references held by queued bursts: the oldest sample index each
+     * one still needs, or PIN_FREE. Only the detector claims a slot; the
+     * downmix worker frees it. */
+    atomic_uint_fast64_t *pins;
+    int pin_cursor;
+    uint64_t n_ring_copies;     /* bursts copied out under ring pressure */
+    uint64_t n_ring_stalls;     /* writes that waited for a release */
+
+    /* Fixed copy slots (memory budget), or none to copy with malloc */
+    float complex *copy_mem;
+    size_t copy_slot_len;       /* samples per slot */
+    int n_copy_slots;
+    mpmc_queue_t copy_free;
+    uint64_t n_copy_drops;      /* bursts dropped with no slot or pin */
+
+    /* Settings changed from the control socket. The control thread stores
+     * the value, then sets its bit; the detector applies them between
+     * sample blocks. The values double as the current settings. */
+    atomic_uint ctl_pending;
+    atomic_int ctl_threshold_mdb;   /* milli-dB */
+    atomic_int ctl_history;
+    atomic_int ctl_max_bursts;
+
+    /* Average noise floor in milli-dBFS/Hz, published by the detector
+     * for other threads; they must not read baseline_sum directly */
+    atomic_int noise_floor_mdb;
+
     /* int8 -> float complex conversion buffer */
     float complex *convert_buf;
     size_t convert_buf_size;
@@ -136,13 +175,26 @@ struct _burst_detector {
 
 /* ---- Externs for threading integration ---- */
 
-extern Blocking_Queue samples_queue;
-extern Blocking_Queue burst_queue;
+extern spsc_queue_t samples_queue;
+extern burst_pq_t burst_queue;
 extern volatile sig_atomic_t running;
-extern int verbose;
+extern int live;
 extern atomic_ulong stat_n_detected;
 extern atomic_ulong stat_n_dropped;
 
+#define PIN_FREE UINT64_MAX
+
+#define CTL_THRESHOLD    0x1
+#define CTL_HISTORY      0x2
+#define CTL_MAX_BURSTS   0x4
+#define CTL_RESET_NOISE  0x8
+
+/* ENBW of the Blackman window */
+#define WINDOW_ENBW 1.72f
+
+/* Published noise floor before there is any data, in milli-dB */
+#define NOISE_FLOOR_NONE_MDB (-120000)
+
 /* ---- Helper: dynamic array push ---- */
 
 static void push_burst(active_burst_t **arr, int *count, int *cap, active_burst_t *b) {
@@ -171,29 +223,53 @@ static int peak_cmp_desc(const void *a, const void *b) {
 
 /* ---- Create burst detector ---- */
 
-burst_detector_t *burst_detector_create(burst_config_t *config) {
-    burst_detector_t *d = calloc(1, sizeof(*d));
-
-    d->center_frequency = config->center_frequency;
-    d->sample_rate = config->sample_rate;
-
+/* FFT size and burst lengths, with defaults for unset fields */
+static void resolve_lengths(const burst_config_t *config, int *fft_size,
+                            int *pre_len, int *post_len, int *max_len) {
     /* FFT size: ~1ms window, nearest power of 2 */
     if (config->fft_size > 0) {
-        d->fft_size = config->fft_size;
+        *fft_size = config->fft_size;
     } else {
         int n = (int)round(log2(config->sample_rate / 1000.0));
-        d->fft_size = 1 << n;
+        *fft_size = 1 << n;
     }
 
     /* Burst pre/post lengths */
-    d->burst_pre_len = config->burst_pre_len > 0
+    *pre_len = config->burst_pre_len > 0
         ? config->burst_pre_len
-        : 2 * d->fft_size;
+        : 2 * *fft_size;
 
-    d->burst_post_len = config->burst_post_len > 0
+    *post_len = config->burst_post_len > 0
         ? config->burst_post_len
         : (int)(config->sample_rate * 16e-3);
 
+    /* Max burst length in samples */
+    *max_len = config->max_burst_len > 0
+        ? config->max_burst_len
+        : (int)(config->sample_rate * (IR_MAX_BURST_MS / 1000.0));
+}
+
+size_t burst_detector_max_span(const burst_config_t *config) {
+    int fft_size, pre_len, post_len, max_len;
+    resolve_lengths(config, &fft_size, &pre_len, &post_len, &max_len);
+    return (size_t)max_len + pre_len + post_len + (size_t)fft_size * 4;
+}
+
+int burst_detector_fft_size(const burst_config_t *config) {
+    int fft_size, pre_len, post_len, max_len;
+    resolve_lengths(config, &fft_size, &pre_len, &post_len, &max_len);
+    return fft_size;
+}
+
+burst_detector_t *burst_detector_create(burst_config_t *config) {
+    burst_detector_t *d = calloc(1, sizeof(*d));
+
+    d->center_frequency = config->center_frequency;
+    d->sample_rate = config->sample_rate;
+
+    resolve_lengths(config, &d->fft_size, &d->burst_pre_len,
+                    &d->burst_post_len, &d->max_burst_len);
+
     /* Burst width in FFT bins */
     int burst_width_hz = config->burst_width > 0
         ? config->burst_width
@@ -207,40 +283,54 @@ burst_detector_t *burst_detector_create(burst_config_t *config) {
         d->max_bursts = (int)((config->sample_rate / (float)burst_width_hz) * 0.8f);
     }
 
-    /* Max burst length in samples */
-    d->max_burst_len = config->max_burst_len > 0
-        ? config->max_burst_len
-        : (int)(config->sample_rate * 0.09);
-
     d->history_size = config->history_size > 0
         ? config->history_size
         : IR_DEFAULT_HISTORY_SIZE;
+    d->history_cap = d->history_size;
 
     /* Threshold: convert from dB to linear, normalized */
     float threshold_db = config->threshold > 0
         ? config->threshold
         : IR_DEFAULT_THRESHOLD;
-
-    /* ENBW of Blackman window */
-    float window_enbw = 1.72f;
-    d->threshold = powf(10.0f, threshold_db / 10.0f) / d->history_size / window_enbw;
-
-    if (verbose) {
-        fprintf(stderr, "burst_detect: fft_size=%d, threshold=%.1f dB (linear=%e), "
-                "history=%d, burst_width=%d bins, max_bursts=%d, "
-                "pre_len=%d, post_len=%d, max_len=%d\n",
-                d->fft_size, threshold_db, d->threshold,
-                d->history_size, d->burst_width, d->max_bursts,
-                d->burst_pre_len, d->burst_post_len, d->max_burst_len);
+    d->threshold_db = threshold_db;
+    d->threshold = powf(10.0f, threshold_db / 10.0f) / d->history_size / WINDOW_ENBW;
+
+    atomic_init(&d->ctl_pending, 0);
+    atomic_init(&d->ctl_threshold_mdb, (int)lroundf(threshold_db * 1000.0f));
+    atomic_init(&d->ctl_history, d->history_size);
+    atomic_init(&d->ctl_max_bursts, d->max_bursts);
+    atomic_init(&d->noise_floor_mdb, NOISE_FLOOR_NONE_MDB);
+
+    /* Optional lower band edge (e.g. simplex-only): bins below it are still
+     * part of the noise estimate but never start a burst */
+    d->peak_bin_min = 0;
+    if (config->min_frequency > 0) {
+        double bin_hz = (double)config->sample_rate / d->fft_size;
+        int bin = d->fft_size / 2 +
+            (int)floor((config->min_frequency - config->center_frequency) / bin_hz);
+        if (bin > 0)
+            d->peak_bin_min = bin < d->fft_size ? bin : d->fft_size;
     }
 
+    log_msg(LOGC_DETECT, LOGL_INFO,
+            "burst_detect: fft_size=%d, threshold=%.1f dB (linear=%e), "
+            "history=%d, burst_width=%d bins, max_bursts=%d, "
+            "pre_len=%d, post_len=%d, max_len=%d",
+            d->fft_size, threshold_db, d->threshold,
+            d->history_size, d->burst_width, d->max_bursts,
+            d->burst_pre_len, d->burst_post_len, d->max_burst_len);
+    if (d->peak_bin_min > 0)
+        log_msg(LOGC_DETECT, LOGL_INFO,
+                "burst_detect: peak search from bin %d (%.0f Hz)",
+                d->peak_bin_min, config->min_frequency);
+
     /* Allocate FFT */
     d->fft_in = fftwf_alloc_complex(d->fft_size);
     d->fft_out = fftwf_alloc_complex(d->fft_size);
+    d->wisdom_gen = fftw_wisdom_generation();
     fftw_lock();
-    d->fft_plan = fftwf_plan_dft_1d(d->fft_size,
-                                     d->fft_in, d->fft_out,
-                                     FFTW_FORWARD, FFTW_MEASURE);
+    d->fft_plan = fftw_wisdom_plan(d->fft_size, d->fft_in, d->fft_out,
+                                   FFTW_FORWARD, &d->fft_measured);
     fftw_unlock();
 
     /* Window: Blackman scaled by 1/0.42 for accurate SNR */
@@ -249,8 +339,10 @@ burst_detector_t *burst_detector_create(burst_config_t *config) {
     for (int i = 0; i < d->fft_size; i++)
         d->window[i] /= 0.42f;
 
-    /* Noise floor arrays (aligned for SIMD) */
-    d->baseline_history = aligned_calloc_32(d->fft_size * d->history_size, sizeof(float));
+    /* Noise floor arrays (aligned for SIMD); the history is walked in
+     * full every FFT, so it goes on huge pages when it can */
+    d->baseline_history = huge_alloc(sizeof(float) * d->fft_size * d->history_size,
+                                     "detector history");
     d->baseline_sum = aligned_calloc_32(d->fft_size, sizeof(float));
     d->magnitude_shifted = aligned_calloc_32(d->fft_size, sizeof(float));
     d->relative_magnitude = aligned_calloc_32(d->fft_size, sizeof(float));
@@ -291,12 +383,41 @@ burst_detector_t *burst_detector_create(burst_config_t *config) {
     /* IQ ringbuffer: hold enough for max burst + pre + post + headroom */
     d->ringbuf_size = d->max_burst_len + d->burst_pre_len + d->burst_post_len
                       + d->fft_size * 4;
-    /* Minimum 2 seconds */
-    if (d->ringbuf_size < (size_t)(2 * d->sample_rate))
+    /* Minimum 2 seconds, unless a memory budget sets the size */
+    if (config->ring_size > d->ringbuf_size)
+        d->ringbuf_size = config->ring_size;
+    else if (config->ring_size == 0 &&
+             d->ringbuf_size < (size_t)(2 * d->sample_rate))
         d->ringbuf_size = 2 * d->sample_rate;
-    d->ringbuf = malloc(sizeof(float complex) * d->ringbuf_size);
+    d->ringbuf = huge_alloc(sizeof(float complex) * d->ringbuf_size,
+                            "detector ring");
     d->ringbuf_write = 0;
     d->ringbuf_start = 0;
+    d->pins = malloc(sizeof(*d->pins) * BURST_RING_PINS);
+    for (int i = 0; i < BURST_RING_PINS; i++)
+        atomic_init(&d->pins[i], PIN_FREE);
+    d->pin_cursor = 0;
+    d->n_ring_copies = 0;
+    d->n_ring_stalls = 0;
+
+    if (config->copy_slots > 0) {
+        d->copy_slot_len = d->max_burst_len + d->burst_pre_len
+                           + d->burst_post_len + d->fft_size * 4;
+        d->copy_mem = huge_alloc(sizeof(float complex) * d->copy_slot_len
+                                 * config->copy_slots, "burst copies");
+        if (d->copy_mem &&
+            mpmc_queue_init(&d->copy_free, config->copy_slots) == 0) {
+            d->n_copy_slots = config->copy_slots;
+            for (int i = 0; i < d->n_copy_slots; i++)
+                mpmc_queue_add(&d->copy_free,
+                               d->copy_mem + (size_t)i * d->copy_slot_len);
+        } else {
+            fprintf(stderr, "burst_detect: cannot allocate %d copy slots\n",
+                    config->copy_slots);
+            huge_free(d->copy_mem);
+            d->copy_mem = NULL;
+        }
+    }
 
     /* Timestamp: set when first samples arrive */
     d->start_time_ns = 0;
@@ -322,8 +443,16 @@ burst_detector_t *burst_detector_create(burst_config_t *config) {
     return d;
 }
 
+static uint64_t ringbuf_oldest_pin(burst_detector_t *d);
+
 void burst_detector_destroy(burst_detector_t *d) {
     if (!d) return;
+    /* Bursts still queued for downmix point into the ring or hold a
+     * copy slot */
+    while (ringbuf_oldest_pin(d) != PIN_FREE ||
+           (d->n_copy_slots &&
+            mpmc_queue_size(&d->copy_free) < (unsigned)d->n_copy_slots))
+        usleep(1000);
 #ifdef USE_GPU
     if (d->gpu) {
         gpu_burst_fft_destroy(d->gpu);
@@ -335,7 +464,7 @@ void burst_detector_destroy(burst_detector_t *d) {
     fftwf_free(d->fft_in);
     fftwf_free(d->fft_out);
     free(d->window);
-    free(d->baseline_history);
+    huge_free(d->baseline_history);
     free(d->baseline_sum);
     free(d->magnitude_shifted);
     free(d->relative_magnitude);
@@ -345,13 +474,61 @@ void burst_detector_destroy(burst_detector_t *d) {
     free(d->bursts);
     free(d->new_bursts);
     free(d->gone_bursts);
-    free(d->ringbuf);
+    huge_free(d->ringbuf);
+    if (d->n_copy_slots) {
+        mpmc_queue_destroy(&d->copy_free);
+        huge_free(d->copy_mem);
+    }
+    free((void *)d->pins);
     free(d->convert_buf);
     fprintf(stderr, "burst_detect: tagged %lu bursts total\n",
             (unsigned long)d->n_tagged_bursts);
+    if (d->n_ring_copies || d->n_ring_stalls)
+        fprintf(stderr, "burst_detect: %lu bursts copied under ring pressure, "
+                "%lu writes waited for downmix\n",
+                (unsigned long)d->n_ring_copies,
+                (unsigned long)d->n_ring_stalls);
+    if (d->n_copy_drops)
+        fprintf(stderr, "burst_detect: %lu bursts dropped with every copy "
+                "slot and ring pin in use\n", (unsigned long)d->n_copy_drops);
     free(d);
 }
 
+/* ---- Public: runtime settings ---- */
+
+void burst_detector_set_threshold(burst_detector_t *d, float db) {
+    atomic_store(&d->ctl_threshold_mdb, (int)lroundf(db * 1000.0f));
+    atomic_fetch_or_explicit(&d->ctl_pending, CTL_THRESHOLD,
+                             memory_order_release);
+}
+
+int burst_detector_set_history(burst_detector_t *d, int n) {
+    if (n < 1 || n > d->history_cap)
+        return -1;
+    atomic_store(&d->ctl_history, n);
+    atomic_fetch_or_explicit(&d->ctl_pending, CTL_HISTORY,
+                             memory_order_release);
+    return 0;
+}
+
+void burst_detector_set_max_bursts(burst_detector_t *d, int n) {
+    atomic_store(&d->ctl_max_bursts, n);
+    atomic_fetch_or_explicit(&d->ctl_pending, CTL_MAX_BURSTS,
+                             memory_order_release);
+}
+
+void burst_detector_reset_noise(burst_detector_t *d) {
+    atomic_fetch_or_explicit(&d->ctl_pending, CTL_RESET_NOISE,
+                             memory_order_release);
+}
+
+void burst_detector_get_settings(burst_detector_t *d, burst_settings_t *s) {
+    s->threshold_db = atomic_load(&d->ctl_threshold_mdb) / 1000.0f;
+    s->history = atomic_load(&d->ctl_history);
+    s->history_max = d->history_cap;
+    s->max_bursts = atomic_load(&d->ctl_max_bursts);
+}
+
 int burst_detector_active_count(burst_detector_t *d) {
     return d->num_bursts;
 }
@@ -361,22 +538,10 @@ uint64_t burst_detector_total_count(burst_detector_t *d) {
 }
 
 float burst_detector_noise_floor(burst_detector_t *d) {
-    if (!d || !d->baseline_sum || d->history_size == 0)
+    if (!d)
         return 0.0f;
-
-    /* Average baseline across all FFT bins */
-    double sum = 0;
-    for (int i = 0; i < d->fft_size; i++)
-        sum += d->baseline_sum[i];
-
-    float avg = (float)(sum / (d->fft_size * d->history_size));
-
-    /* Convert to dBFS/Hz: 10*log10(mag^2 / bin_width) */
-    float bin_width = (float)d->sample_rate / d->fft_size;
-    if (avg > 0 && bin_width > 0)
-        return 10.0f * log10f(avg / bin_width);
-
-    return -120.0f;  /* Return very low value if no data */
+    return atomic_load_explicit(&d->noise_floor_mdb,
+                                memory_order_relaxed) / 1000.0f;
 }
 
 float burst_detector_peak_signal(burst_detector_t *d) {
@@ -387,42 +552,188 @@ float burst_detector_peak_signal(burst_detector_t *d) {
 
 /* ---- Internal: ringbuffer operations ---- */
 
+/* Copy len samples starting at ring position pos, which may wrap */
+static void ring_copy(const float complex *ring, size_t ring_size, size_t pos,
+                      float complex *dst, size_t len) {
+    size_t first = ring_size - pos;
+    if (first > len) first = len;
+    memcpy(dst, &ring[pos], first * sizeof(float complex));
+    memcpy(dst + first, ring, (len - first) * sizeof(float complex));
+}
+
+/* Oldest sample index still referenced by a queued burst */
+static uint64_t ringbuf_oldest_pin(burst_detector_t *d) {
+    uint64_t oldest = PIN_FREE;
+    for (int i = 0; i < BURST_RING_PINS; i++) {
+        uint64_t p = atomic_load_explicit(&d->pins[i], memory_order_acquire);
+        if (p < oldest)
+            oldest = p;
+    }
+    return oldest;
+}
+
+/* Claim a reference on the ring from sample index start onwards, or
+ * NULL if every slot is taken */
+static atomic_uint_fast64_t *ringbuf_pin(burst_detector_t *d, uint64_t start) {
+    for (int n = 0; n < BURST_RING_PINS; n++) {
+        int i = (d->pin_cursor + n) % BURST_RING_PINS;
+        if (atomic_load_explicit(&d->pins[i], memory_order_relaxed) == PIN_FREE) {
+            atomic_store_explicit(&d->pins[i], start, memory_order_relaxed);
+            d->pin_cursor = (i + 1) % BURST_RING_PINS;
+            return &d->pins[i];
+        }
+    }
+    return NULL;
+}
+
 static void ringbuf_write(burst_detector_t *d, const float complex *samples, size_t n) {
-    for (size_t i = 0; i < n; i++) {
-        d->ringbuf[d->ringbuf_write] = samples[i];
-        d->ringbuf_write = (d->ringbuf_write + 1) % d->ringbuf_size;
+    uint64_t end = d->sample_count + n;
+
+    /* Only the last ringbuf_size samples of an oversized block survive */
+    if (n > d->ringbuf_size) {
+        d->ringbuf_write = (d->ringbuf_write + n - d->ringbuf_size)
+                           % d->ringbuf_size;
+        samples += n - d->ringbuf_size;
+        n = d->ringbuf_size;
     }
+
+    /* This write overwrites every sample before end - ringbuf_size; wait
+     * for the downmix workers to release any burst that still needs one */
+    if (end > d->ringbuf_size &&
+        ringbuf_oldest_pin(d) < end - d->ringbuf_size) {
+        d->n_ring_stalls++;
+        log_msg(LOGC_DETECT, LOGL_DEBUG,
+                "burst_detect: ring full of queued bursts, waiting for downmix");
+        while (ringbuf_oldest_pin(d) < end - d->ringbuf_size)
+            usleep(100);
+    }
+
+    size_t first = d->ringbuf_size - d->ringbuf_write;
+    if (first > n) first = n;
+    memcpy(&d->ringbuf[d->ringbuf_write], samples, first * sizeof(float complex));
+    memcpy(d->ringbuf, samples + first, (n - first) * sizeof(float complex));
+    d->ringbuf_write = (d->ringbuf_write + n) % d->ringbuf_size;
+
     /* Update the oldest available sample index */
-    uint64_t total_written = d->sample_count;
-    if (total_written > d->ringbuf_size)
-        d->ringbuf_start = total_written - d->ringbuf_size;
+    if (end > d->ringbuf_size)
+        d->ringbuf_start = end - d->ringbuf_size;
 }
 
 static float complex *ringbuf_extract(burst_detector_t *d, uint64_t start,
-                                       uint64_t stop, size_t *out_len) {
-    /* Clamp to available range */
-    if (start < d->ringbuf_start)
-        start = d->ringbuf_start;
-    if (stop <= start) {
-        *out_len = 0;
-        return NULL;
-    }
-
-    size_t len = (size_t)(stop - start);
+                                       size_t len) {
     float complex *buf = malloc(sizeof(float complex) * len);
-    size_t rb_pos = (size_t)(start % d->ringbuf_size);
+    ring_copy(d->ringbuf, d->ringbuf_size, (size_t)(start % d->ringbuf_size),
+              buf, len);
+    return buf;
+}
+
+/* ---- Public: burst data ---- */
+
+size_t burst_data_copy(const burst_data_t *b, float complex *dst, size_t max) {
+    size_t n = b->num_samples < max ? b->num_samples : max;
+    if (b->ring)
+        ring_copy(b->ring, b->ring_size, b->ring_pos, dst, n);
+    else
+        memcpy(dst, b->samples, n * sizeof(float complex));
+    return n;
+}
 
-    for (size_t i = 0; i < len; i++) {
-        buf[i] = d->ringbuf[rb_pos];
-        rb_pos = (rb_pos + 1) % d->ringbuf_size;
+void burst_data_release(burst_data_t *b) {
+    if (b->pin) {
+        atomic_store_explicit(b->pin, PIN_FREE, memory_order_release);
+        b->pin = NULL;
+        b->ring = NULL;
     }
+    if (b->copy_pool && b->samples) {
+        mpmc_queue_add(b->copy_pool, b->samples);
+        b->samples = NULL;
+    }
+}
 
-    *out_len = len;
-    return buf;
+void burst_data_free(burst_data_t *b) {
+    if (!b) return;
+    burst_data_release(b);
+    free(b->samples);
+    free(b);
 }
 
 /* ---- Internal: update noise floor (pre) ---- */
 
+static void reset_noise_estimate(burst_detector_t *d) {
+    d->history_index = 0;
+    d->history_primed = 0;
+    memset(d->baseline_history, 0,
+           sizeof(float) * d->fft_size * d->history_cap);
+    memset(d->baseline_sum, 0, sizeof(float) * d->fft_size);
+}
+
+/* Apply settings from the control socket. Called at the start of a
+ * sample block, so no FFT frame sees half of a change. */
+/* Detector thread: average the baseline across all FFT bins, convert to
+ * dBFS/Hz (10*log10(mag^2 / bin_width)) and publish it */
+static void publish_noise_floor(burst_detector_t *d) {
+    int mdb = NOISE_FLOOR_NONE_MDB;
+    float bin_width = (float)d->sample_rate / d->fft_size;
+
+    if (d->baseline_sum && d->history_size > 0 && bin_width > 0) {
+        double sum = 0;
+        for (int i = 0; i < d->fft_size; i++)
+            sum += d->baseline_sum[i];
+        float avg = (float)(sum / ((double)d->fft_size * d->history_size));
+        if (avg > 0)
+            mdb = (int)lroundf(10.0f * log10f(avg / bin_width) * 1000.0f);
+    }
+    atomic_store_explicit(&d->noise_floor_mdb, mdb, memory_order_relaxed);
+}
+
+static void apply_control(burst_detector_t *d) {
+    unsigned pending = atomic_exchange_explicit(&d->ctl_pending, 0,
+                                                memory_order_acquire);
+    if (!pending)
+        return;
+
+    if (pending & CTL_HISTORY) {
+        d->history_size = atomic_load(&d->ctl_history);
+        pending |= CTL_THRESHOLD | CTL_RESET_NOISE;
+    }
+    if (pending & CTL_THRESHOLD) {
+        d->threshold_db = atomic_load(&d->ctl_threshold_mdb) / 1000.0f;
+        d->threshold = powf(10.0f, d->threshold_db / 10.0f)
+                       / d->history_size / WINDOW_ENBW;
+    }
+    if (pending & CTL_MAX_BURSTS)
+        d->max_bursts = atomic_load(&d->ctl_max_bursts);
+    if (pending & CTL_RESET_NOISE)
+        reset_noise_estimate(d);
+
+    log_msg(LOGC_DETECT, LOGL_INFO,
+            "burst_detect: control: threshold=%.1f dB, history=%d, "
+            "max_bursts=%d%s", d->threshold_db, d->history_size,
+            d->max_bursts,
+            pending & CTL_RESET_NOISE ? ", noise estimate reset" : "");
+}
+
+/* Swap in the measured FFT plan once the background planner has it.
+ * Called between sample blocks, so no frame is mid-transform. */
+static void upgrade_fft_plan(burst_detector_t *d) {
+    if (d->fft_measured)
+        return;
+    unsigned gen = fftw_wisdom_generation();
+    if (gen == d->wisdom_gen)
+        return;
+
+    int r = fftw_wisdom_upgrade(&d->fft_plan, d->fft_size, d->fft_in,
+                                d->fft_out, FFTW_FORWARD);
+    if (r < 0)
+        return;     /* planner busy, try next block */
+    d->wisdom_gen = gen;
+    if (r > 0) {
+        d->fft_measured = 1;
+        log_msg(LOGC_DETECT, LOGL_INFO,
+                "burst_detect: switched to measured FFT plan");
+    }
+}
+
 static int update_filters_pre(burst_detector_t *d) {
     if (!d->history_primed)
         return 0;
@@ -537,7 +848,9 @@ static void extract_peaks(burst_detector_t *d) {
     int dc_bin = d->fft_size / 2;
     int dc_notch_half = 3;  /* ±3 bins around DC */
 
-    for (int bin = half_bw; bin < d->fft_size - half_bw; bin++) {
+    int first_bin = half_bw > d->peak_bin_min ? half_bw : d->peak_bin_min;
+
+    for (int bin = first_bin; bin < d->fft_size - half_bw; bin++) {
         if (bin >= dc_bin - dc_notch_half && bin <= dc_bin + dc_notch_half)
             continue;
         if (d->relative_magnitude[bin] > d->threshold) {
@@ -569,7 +882,7 @@ static void create_new_bursts(burst_detector_t *d) {
         d->burst_id += 10;  /* leave room for sub-IDs downstream */
 
         /* Normalize relative magnitude for SNR estimate */
-        b.magnitude = 10.0f * log10f(p->relative_magnitude * d->history_size * 1.72f);
+        b.magnitude = 10.0f * log10f(p->relative_magnitude * d->history_size * WINDOW_ENBW);
 
         /* Track peak signal for diagnostic mode */
         if (b.magnitude > d->peak_signal_db)
@@ -582,7 +895,7 @@ static void create_new_bursts(burst_detector_t *d) {
         /* Noise floor in dBFS/Hz */
         b.noise = 10.0f * log10f(d->baseline_sum[b.center_bin] / d->history_size
                                   / ((float)d->fft_size * d->fft_size)
-                                  / 1.72f
+                                  / WINDOW_ENBW
                                   / ((float)d->sample_rate / d->fft_size));
 
         push_burst(&d->bursts, &d->num_bursts, &d->bursts_cap, &b);
@@ -592,9 +905,8 @@ static void create_new_bursts(burst_detector_t *d) {
 
     /* Squelch check */
     if (d->max_bursts > 0 && d->num_bursts > d->max_bursts) {
-        if (verbose)
-            fprintf(stderr, "burst_detect: squelch at %.3f s\n",
-                    d->index / (float)d->sample_rate);
+        log_msg(LOGC_DETECT, LOGL_DEBUG, "burst_detect: squelch at %.3f s",
+                d->index / (float)d->sample_rate);
 
         d->num_new_bursts = 0;
 
@@ -616,13 +928,9 @@ static void create_new_bursts(burst_detector_t *d) {
 
         d->squelch_count += 3;
         if (d->squelch_count >= 10) {
-            if (verbose)
-                fprintf(stderr, "burst_detect: resetting noise estimate\n");
-            d->history_index = 0;
-            d->history_primed = 0;
-            memset(d->baseline_history, 0,
-                   sizeof(float) * d->fft_size * d->history_size);
-            memset(d->baseline_sum, 0, sizeof(float) * d->fft_size);
+            log_msg(LOGC_DETECT, LOGL_DEBUG,
+                    "burst_detect: resetting noise estimate");
+            reset_noise_estimate(d);
             d->squelch_count = 0;
         }
     } else {
@@ -704,20 +1012,20 @@ static void emit_gone_bursts(burst_detector_t *d, burst_callback_t cb, void *use
     for (int i = 0; i < d->num_gone_bursts; i++) {
         active_burst_t *ab = &d->gone_bursts[i];
 
-        /* Extract IQ samples from ringbuffer */
+        /* Clamp to the samples still in the ring. The tail can run past
+         * the last sample written; those slots hold stale data. */
         uint64_t extract_start = ab->start;
         uint64_t extract_stop = ab->stop + d->burst_pre_len;
-        size_t num_samples;
-        float complex *samples = ringbuf_extract(d, extract_start, extract_stop,
-                                                  &num_samples);
-
-        if (num_samples == 0) {
-            free(samples);
+        if (extract_start < d->ringbuf_start)
+            extract_start = d->ringbuf_start;
+        if (extract_stop > d->sample_count)
+            extract_stop = d->sample_count;
+        if (extract_stop <= extract_start)
             continue;
-        }
+        size_t num_samples = (size_t)(extract_stop - extract_start);
 
         /* Build burst data */
-        burst_data_t *bd = malloc(sizeof(*bd));
+        burst_data_t *bd = calloc(1, sizeof(*bd));
         bd->info = (burst_info_t){
             .id = ab->id,
             .start = ab->start,
@@ -732,7 +1040,45 @@ static void emit_gone_bursts(burst_detector_t *d, burst_callback_t cb, void *use
         bd->fft_size = d->fft_size;
         bd->start_time_ns = d->start_time_ns;
         bd->num_samples = num_samples;
-        bd->samples = samples;
+
+        /* Hand the span over in place. If it is already more than halfway
+         * to being overwritten, or every pin is taken, a slow worker would
+         * stall the writer, so copy it out instead. */
+        atomic_uint_fast64_t *pin = NULL;
+        float complex *slot = NULL;
+        if (extract_start + d->ringbuf_size / 2 >= d->sample_count)
+            pin = ringbuf_pin(d, extract_start);
+        if (pin) {
+            bd->ring = d->ringbuf;
+            bd->ring_size = d->ringbuf_size;
+            bd->ring_pos = (size_t)(extract_start % d->ringbuf_size);
+            bd->pin = pin;
+        } else if (d->n_copy_slots == 0) {
+            bd->samples = ringbuf_extract(d, extract_start, num_samples);
+            d->n_ring_copies++;
+        } else if (mpmc_queue_poll(&d->copy_free, &slot) == 0) {
+            /* Under a memory budget copies come from the fixed slots */
+            if (bd->num_samples > d->copy_slot_len)
+                bd->num_samples = d->copy_slot_len;
+            ring_copy(d->ringbuf, d->ringbuf_size,
+                      (size_t)(extract_start % d->ringbuf_size),
+                      slot, bd->num_samples);
+            bd->samples = slot;
+            bd->copy_pool = &d->copy_free;
+            d->n_ring_copies++;
+        } else if ((pin = ringbuf_pin(d, extract_start)) != NULL) {
+            /* No slot left: pin anyway and let the writer wait */
+            bd->ring = d->ringbuf;
+            bd->ring_size = d->ringbuf_size;
+            bd->ring_pos = (size_t)(extract_start % d->ringbuf_size);
+            bd->pin = pin;
+        } else {
+            free(bd);
+            d->n_copy_drops++;
+            atomic_fetch_add(&stat_n_detected, 1);
+            atomic_fetch_add(&stat_n_dropped, 1);
+            continue;
+        }
 
         cb(bd, user);
         d->n_tagged_bursts++;
@@ -751,6 +1097,10 @@ void burst_detector_feed(burst_detector_t *d, const int8_t *iq,
      * We maintain a residual buffer for partial FFT frames.
      */
 
+    apply_control(d);
+    upgrade_fft_plan(d);
+    publish_noise_floor(d);
+
     /* Track timestamp */
     if (d->start_time_ns == 0) {
         struct timespec ts;
@@ -845,6 +1195,10 @@ void burst_detector_feed(burst_detector_t *d, const int8_t *iq,
 
 void burst_detector_feed_cf32(burst_detector_t *d, const float *iq,
                               size_t num_samples, burst_callback_t cb, void *user) {
+    apply_control(d);
+    upgrade_fft_plan(d);
+    publish_noise_floor(d);
+
     /* Track timestamp */
     if (d->start_time_ns == 0) {
         struct timespec ts;
@@ -926,12 +1280,28 @@ void burst_detector_feed_cf32(burst_detector_t *d, const float *iq,
 
 /* ---- Thread integration: callback that pushes to burst_queue ---- */
 
+/* Each burst takes its output-order slot before it is queued, so frames
+ * from later bursts wait for it even while it sits in the queue.
+ * A live capture sheds the weakest queued burst when the workers are
+ * behind, and drops the new one if every sequencer slot is in use; file
+ * input waits for both so that decoding a recording stays lossless. */
 static void burst_to_queue(burst_data_t *burst, void *user) {
-    Blocking_Queue *queue = (Blocking_Queue *)user;
-    int ret = blocking_queue_put(queue, burst);
-    if (ret != 0) {
-        free(burst->samples);
-        free(burst);
+    burst_pq_t *queue = (burst_pq_t *)user;
+    if (frame_seq_open(burst->start_time_ns +
+            (uint64_t)((double)burst->info.start / burst->sample_rate * 1e9),
+            !live, &burst->seq) != 0) {
+        burst_data_free(burst);
+        atomic_fetch_add(&stat_n_dropped, 1);
+        return;
+    }
+
+    burst_data_t *shed = NULL;
+    int ret = burst_pq_put(queue, burst, live, &shed);
+    if (ret == BURST_PQ_CLOSED)
+        shed = burst;
+    if (shed) {
+        frame_seq_close(shed->seq, NULL, 0);
+        burst_data_free(shed);
         atomic_fetch_add(&stat_n_dropped, 1);
     }
 }
@@ -941,9 +1311,9 @@ static void burst_to_queue(burst_data_t *burst, void *user) {
 void *burst_detector_thread(void *arg) {
     burst_detector_t *det = (burst_detector_t *)arg;
 
-    while (1) {
+    while (running) {
         sample_buf_t *samples;
-        if (blocking_queue_take(&samples_queue, &samples) != 0)
+        if (spsc_queue_take(&samples_queue, &samples) != 0)
             break;
 
         if (samples->format == SAMPLE_FMT_FLOAT)
@@ -952,7 +1322,7 @@ void *burst_detector_thread(void *arg) {
         else
             burst_detector_feed(det, samples->samples, samples->num,
                                burst_to_queue, &burst_queue);
-        free(samples);
+        sample_buf_release(samples);
     }
 
     burst_detector_destroy(det);
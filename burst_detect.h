@@ -18,9 +18,16 @@
 #define __BURST_DETECT_H__
 
 #include <complex.h>
+#include <stdatomic.h>
 #include <stdint.h>
 #include <fftw3.h>
 
+#include "lf_queue.h"
+
+/* Ring references that can be outstanding at once; past this, further
+ * bursts are copied out of the ring */
+#define BURST_RING_PINS  2048
+
 /* Forward declaration */
 struct _burst_detector;
 typedef struct _burst_detector burst_detector_t;
@@ -36,7 +43,15 @@ typedef struct {
     float noise;            /* noise floor in dBFS/Hz */
 } burst_info_t;
 
-/* Complete burst with IQ data, ready for downstream processing */
+/* Complete burst with IQ data, ready for downstream processing.
+ *
+ * The IQ data normally stays in the detector's ring buffer: ring points
+ * at the ring, ring_pos is where the burst starts in it (the span may
+ * wrap), and pin holds the burst's oldest sample index so the detector
+ * will not overwrite it. When the ring is under pressure the detector
+ * copies the span into samples instead and ring is NULL; under a memory
+ * budget that copy is a slot from a fixed pool. Use burst_data_copy() to
+ * read the samples either way. */
 typedef struct {
     burst_info_t info;
     double center_frequency;  /* absolute center freq of capture */
@@ -44,7 +59,14 @@ typedef struct {
     int fft_size;             /* FFT size used for detection */
     uint64_t start_time_ns;   /* wall clock ns at sample 0 (base offset) */
     size_t num_samples;       /* number of complex float samples */
-    float complex *samples;   /* IQ data covering burst lifetime */
+    float complex *samples;   /* owned copy of the IQ data, or NULL */
+    mpmc_queue_t *copy_pool;  /* free list samples returns to, or NULL
+                               * if it was malloc()ed */
+    const float complex *ring;      /* detector ring, or NULL */
+    size_t ring_size;               /* ring capacity in samples */
+    size_t ring_pos;                /* burst start within the ring */
+    atomic_uint_fast64_t *pin;      /* ring reference, NULL once released */
+    uint64_t seq;                   /* output sequencer slot (frame_seq.h) */
 } burst_data_t;
 
 /* Configuration */
@@ -60,16 +82,58 @@ typedef struct {
     float threshold;        /* dB, default 16.0 */
     int history_size;       /* default 512 */
     int use_gpu;            /* 1 = use OpenCL GPU FFT, 0 = FFTW CPU */
+    double min_frequency;   /* Hz, 0 = whole band; ignore peaks below this */
+    size_t ring_size;       /* IQ ring in samples, 0 = auto (2 s minimum);
+                             * never below one maximum burst span */
+    int copy_slots;         /* fixed slots for ring copies, 0 = malloc */
 } burst_config_t;
 
 /* Create a burst detector with the given configuration.
  * Unset fields (0) get reasonable defaults. */
 burst_detector_t *burst_detector_create(burst_config_t *config);
 
+/* Samples in the longest burst span the detector can hand over, with
+ * pre/post padding and FFT headroom; the smallest usable ring */
+size_t burst_detector_max_span(const burst_config_t *config);
+
+/* FFT size the detector plans with FFTW_MEASURE (--generate-wisdom) */
+int burst_detector_fft_size(const burst_config_t *config);
+
 /* Callback for completed bursts. Receives ownership of burst_data_t
- * (caller must free both burst->samples and burst itself). */
+ * (caller must release it with burst_data_free()). */
 typedef void (*burst_callback_t)(burst_data_t *burst, void *user);
 
+/* Copy up to max samples of the burst's IQ data into dst; returns the
+ * number copied. Must not be called after burst_data_release(). */
+size_t burst_data_copy(const burst_data_t *burst, float complex *dst,
+                       size_t max);
+
+/* Drop the burst's ring reference so the detector can reuse the space.
+ * Call as soon as the samples have been copied out; safe to repeat. */
+void burst_data_release(burst_data_t *burst);
+
+/* Release the ring reference (if still held) and free the burst */
+void burst_data_free(burst_data_t *burst);
+
+/* Settings that can change while running */
+typedef struct {
+    float threshold_db;
+    int history;            /* noise floor history, in FFT frames */
+    int history_max;        /* the configured history_size */
+    int max_bursts;         /* squelch above this many, 0 = never */
+} burst_settings_t;
+
+/* Change settings from another thread. The detector picks them up at
+ * the start of its next sample block; a new history length also resets
+ * the noise estimate. set_history returns -1 outside 1..history_max. */
+void burst_detector_set_threshold(burst_detector_t *det, float db);
+int burst_detector_set_history(burst_detector_t *det, int n);
+void burst_detector_set_max_bursts(burst_detector_t *det, int n);
+void burst_detector_reset_noise(burst_detector_t *det);
+
+/* Current settings, including changes not yet picked up */
+void burst_detector_get_settings(burst_detector_t *det, burst_settings_t *s);
+
 /* Feed int8 IQ samples to the detector. */
 void burst_detector_feed(burst_detector_t *det, const int8_t *iq,
                          size_t num_samples, burst_callback_t cb, void *user);
@@ -22,7 +22,6 @@
 #define _GNU_SOURCE
 #include <complex.h>
 #include <math.h>
-#include <signal.h>
 #include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -32,24 +31,19 @@
 
 #include "burst_downmix.h"
 #include "fftw_lock.h"
+#include "fftw_wisdom.h"
 #include "fir_filter.h"
+#include "huge_alloc.h"
 #include "iridium.h"
+#include "logging.h"
 #include "rotator.h"
 #include "simd_kernels.h"
 #include "window_func.h"
 
-#include "blocking_queue.h"
-
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
-/* ---- Externs ---- */
-
-extern Blocking_Queue burst_queue;
-extern Blocking_Queue frame_queue;
-extern volatile sig_atomic_t running;
-extern int verbose;
 /* ---- Constants ---- */
 
 #define CFO_FFT_OVERSAMPLE  16
@@ -66,6 +60,7 @@ struct _burst_downmix {
     int output_sample_rate;
     int search_depth;
     int handle_multiple_frames;
+    double min_frequency;
     float samples_per_symbol;
 
     /* Filters */
@@ -98,6 +93,10 @@ struct _burst_downmix {
     float complex *corr_ul_ifft_in;
     float complex *corr_ul_ifft_out;
 
+    /* Plans still on FFTW_ESTIMATE, bit per plan_slot() index */
+    unsigned plans_estimated;
+    unsigned wisdom_gen;        /* fftw_wisdom_generation() last tried */
+
     /* Pre-computed sync word FFTs */
     float complex *dl_sync_fft;
     float complex *ul_sync_fft;
@@ -218,34 +217,122 @@ static void generate_sync_word(burst_downmix_t *dm, const int *uw, int uw_len,
     *sync_len_out = padded_len;
 }
 
+/* ---- FFT plans ---- */
+
+#define N_PLANS 4
+
+typedef struct {
+    fftwf_plan *plan;
+    int n;
+    float complex *in, *out;
+    int sign;
+} plan_slot_t;
+
+/* The context's per-burst plans, by index */
+static plan_slot_t plan_slot(burst_downmix_t *dm, int i) {
+    switch (i) {
+    case 0:
+        return (plan_slot_t){ &dm->cfo_fft_plan, dm->cfo_fft_total,
+                              dm->cfo_fft_in, dm->cfo_fft_out, FFTW_FORWARD };
+    case 1:
+        return (plan_slot_t){ &dm->corr_fwd_plan, dm->corr_fft_size,
+                              dm->corr_fwd_in, dm->corr_fwd_out,
+                              FFTW_FORWARD };
+    case 2:
+        return (plan_slot_t){ &dm->corr_dl_ifft_plan, dm->corr_fft_size,
+                              dm->corr_dl_ifft_in, dm->corr_dl_ifft_out,
+                              FFTW_BACKWARD };
+    default:
+        return (plan_slot_t){ &dm->corr_ul_ifft_plan, dm->corr_fft_size,
+                              dm->corr_ul_ifft_in, dm->corr_ul_ifft_out,
+                              FFTW_BACKWARD };
+    }
+}
+
+/* Swap in measured plans as the background planner produces them.
+ * Called by the owning worker before a burst. */
+static void upgrade_plans(burst_downmix_t *dm) {
+    if (!dm->plans_estimated)
+        return;
+    unsigned gen = fftw_wisdom_generation();
+    if (gen == dm->wisdom_gen)
+        return;
+
+    for (int i = 0; i < N_PLANS; i++) {
+        if (!(dm->plans_estimated & (1u << i)))
+            continue;
+        plan_slot_t ps = plan_slot(dm, i);
+        int r = fftw_wisdom_upgrade(ps.plan, ps.n, ps.in, ps.out, ps.sign);
+        if (r < 0)
+            return;     /* planner busy, try next burst */
+        if (r > 0)
+            dm->plans_estimated &= ~(1u << i);
+    }
+    dm->wisdom_gen = gen;
+    if (!dm->plans_estimated)
+        log_msg(LOGC_DOWNMIX, LOGL_INFO,
+                "burst_downmix: switched to measured FFT plans");
+}
+
 /* ---- Create downmix context ---- */
 
+/* Output sample rate: default = sps * symbol_rate */
+static int resolve_output_rate(const downmix_config_t *config) {
+    int default_sps = IR_DEFAULT_SPS;  /* ~10 sps as starting point */
+    if (config && config->output_sample_rate > 0)
+        return config->output_sample_rate;
+    /* gr-iridium uses 153125 Hz for 6.125 sps at 25 ksps.
+     * We compute a reasonable rate from sps. */
+    return default_sps * IR_SYMBOLS_PER_SECOND;
+}
+
+/* CFO FFT window (before oversampling), sync search length and
+ * correlation FFT size for a given samples-per-symbol */
+static void resolve_fft_sizes(float sps, int *cfo_size, int *search_len,
+                              int *corr_size) {
+    /* Use floor-to-power-of-2 (like gr-iridium) to keep window within preamble+UW */
+    int raw = (int)(sps * 26);
+    *cfo_size = 1;
+    while (*cfo_size * 2 <= raw)
+        *cfo_size *= 2;
+
+    int sync_search_symbols = IR_PREAMBLE_LENGTH_LONG + IR_UW_LENGTH + 8;
+    *search_len = (int)(sync_search_symbols * sps);
+
+    /* Need sync word length to determine corr FFT size. */
+    int ul_sync_symbols = IR_PREAMBLE_LENGTH_SHORT + IR_UW_LENGTH;
+    int ul_sync_samples = (int)(ul_sync_symbols * sps);
+    *corr_size = next_pow2(*search_len + ul_sync_samples);
+}
+
+void burst_downmix_fft_sizes(const downmix_config_t *config,
+                             int *cfo_size, int *corr_size) {
+    float sps = (float)resolve_output_rate(config) / IR_SYMBOLS_PER_SECOND;
+    int cfo, search_len;
+    resolve_fft_sizes(sps, &cfo, &search_len, corr_size);
+    *cfo_size = cfo * CFO_FFT_OVERSAMPLE;
+}
+
 burst_downmix_t *burst_downmix_create(downmix_config_t *config) {
     burst_downmix_t *dm = calloc(1, sizeof(*dm));
+    if (!dm)
+        return NULL;
 
-    /* Output sample rate: default = sps * symbol_rate */
-    int default_sps = IR_DEFAULT_SPS;  /* ~10 sps as starting point */
-    if (config && config->output_sample_rate > 0) {
-        dm->output_sample_rate = config->output_sample_rate;
-    } else {
-        /* gr-iridium uses 153125 Hz for 6.125 sps at 25 ksps.
-         * We compute a reasonable rate from sps. */
-        dm->output_sample_rate = default_sps * IR_SYMBOLS_PER_SECOND;
-    }
+    dm->output_sample_rate = resolve_output_rate(config);
 
     dm->samples_per_symbol = (float)dm->output_sample_rate / IR_SYMBOLS_PER_SECOND;
     dm->search_depth = (config && config->search_depth > 0)
         ? config->search_depth : dm->output_sample_rate;
     dm->handle_multiple_frames = config ? config->handle_multiple_frames : 0;
+    dm->min_frequency = config ? config->min_frequency : 0;
 
     dm->pre_start_samples = (int)(PRE_START_US * 1e-6f * dm->output_sample_rate);
 
-    if (verbose) {
-        fprintf(stderr, "burst_downmix: output_rate=%d Hz, sps=%.3f, "
-                "search_depth=%d, pre_start=%d\n",
-                dm->output_sample_rate, dm->samples_per_symbol,
-                dm->search_depth, dm->pre_start_samples);
-    }
+    log_msg(LOGC_DOWNMIX, LOGL_INFO,
+            "burst_downmix: output_rate=%d Hz, sps=%.3f, "
+            "search_depth=%d, pre_start=%d",
+            dm->output_sample_rate, dm->samples_per_symbol,
+            dm->search_depth, dm->pre_start_samples);
 
     /* ---- Input anti-alias LPF ---- */
     {
@@ -268,12 +355,11 @@ burst_downmix_t *burst_downmix_create(downmix_config_t *config) {
                                 burst_width / 2.0f, burst_width);
         dm->noise_fir = fir_filter_create(taps, ntaps);
         free(taps);
-        if (verbose) {
-            fprintf(stderr, "burst_downmix: noise LPF: %d taps, cutoff=%.0f Hz, "
-                    "transition=%.0f Hz at %d Hz\n",
-                    dm->noise_fir->ntaps, burst_width / 2.0f, burst_width,
-                    dm->output_sample_rate);
-        }
+        log_msg(LOGC_DOWNMIX, LOGL_INFO,
+                "burst_downmix: noise LPF: %d taps, cutoff=%.0f Hz, "
+                "transition=%.0f Hz at %d Hz",
+                dm->noise_fir->ntaps, burst_width / 2.0f, burst_width,
+                dm->output_sample_rate);
     }
 
     /* ---- Magnitude smoothing filter (box filter) ---- */
@@ -306,12 +392,8 @@ burst_downmix_t *burst_downmix_create(downmix_config_t *config) {
 
     /* ---- CFO estimation FFT ---- */
     /* Use floor-to-power-of-2 (like gr-iridium) to keep window within preamble+UW */
-    {
-        int raw = (int)(dm->samples_per_symbol * 26);
-        dm->cfo_fft_size = 1;
-        while (dm->cfo_fft_size * 2 <= raw)
-            dm->cfo_fft_size *= 2;
-    }
+    resolve_fft_sizes(dm->samples_per_symbol, &dm->cfo_fft_size,
+                      &dm->sync_search_len, &dm->corr_fft_size);
     dm->cfo_fft_total = dm->cfo_fft_size * CFO_FFT_OVERSAMPLE;
     dm->cfo_fft_in = fftwf_alloc_complex(dm->cfo_fft_total);
     dm->cfo_fft_out = fftwf_alloc_complex(dm->cfo_fft_total);
@@ -321,14 +403,6 @@ burst_downmix_t *burst_downmix_create(downmix_config_t *config) {
     blackman_window(dm->cfo_window, dm->cfo_fft_size);
 
     /* ---- Correlation FFT ---- */
-    int sync_search_symbols = IR_PREAMBLE_LENGTH_LONG + IR_UW_LENGTH + 8;
-    dm->sync_search_len = (int)(sync_search_symbols * dm->samples_per_symbol);
-
-    /* Need sync word length to determine corr FFT size. */
-    int ul_sync_symbols = IR_PREAMBLE_LENGTH_SHORT + IR_UW_LENGTH;
-    int ul_sync_samples = (int)(ul_sync_symbols * dm->samples_per_symbol);
-    dm->corr_fft_size = next_pow2(dm->sync_search_len + ul_sync_samples);
-
     dm->corr_fwd_in = fftwf_alloc_complex(dm->corr_fft_size);
     dm->corr_fwd_out = fftwf_alloc_complex(dm->corr_fft_size);
     dm->corr_dl_ifft_in = fftwf_alloc_complex(dm->corr_fft_size);
@@ -337,21 +411,15 @@ burst_downmix_t *burst_downmix_create(downmix_config_t *config) {
     dm->corr_ul_ifft_out = fftwf_alloc_complex(dm->corr_fft_size);
 
     /* All FFTW plan creation must be serialized (not thread-safe) */
+    dm->wisdom_gen = fftw_wisdom_generation();
     fftw_lock();
-    dm->cfo_fft_plan = fftwf_plan_dft_1d(dm->cfo_fft_total,
-                                          dm->cfo_fft_in, dm->cfo_fft_out,
-                                          FFTW_FORWARD, FFTW_MEASURE);
-    dm->corr_fwd_plan = fftwf_plan_dft_1d(dm->corr_fft_size,
-                                            dm->corr_fwd_in, dm->corr_fwd_out,
-                                            FFTW_FORWARD, FFTW_MEASURE);
-    dm->corr_dl_ifft_plan = fftwf_plan_dft_1d(dm->corr_fft_size,
-                                                dm->corr_dl_ifft_in,
-                                                dm->corr_dl_ifft_out,
-                                                FFTW_BACKWARD, FFTW_MEASURE);
-    dm->corr_ul_ifft_plan = fftwf_plan_dft_1d(dm->corr_fft_size,
-                                                dm->corr_ul_ifft_in,
-                                                dm->corr_ul_ifft_out,
-                                                FFTW_BACKWARD, FFTW_MEASURE);
+    for (int i = 0; i < N_PLANS; i++) {
+        plan_slot_t ps = plan_slot(dm, i);
+        int measured;
+        *ps.plan = fftw_wisdom_plan(ps.n, ps.in, ps.out, ps.sign, &measured);
+        if (!measured)
+            dm->plans_estimated |= 1u << i;
+    }
     fftw_unlock();
 
     /* Generate sync word FFTs */
@@ -362,12 +430,18 @@ burst_downmix_t *burst_downmix_create(downmix_config_t *config) {
                        IR_PREAMBLE_LENGTH_SHORT, 1,
                        &dm->ul_sync_fft, &dm->ul_sync_len);
 
-    /* ---- Working buffers (generous size, aligned for SIMD) ---- */
-    dm->work_size = 2 * 1024 * 1024;  /* 2M samples max */
-    dm->work_a = aligned_alloc_32(sizeof(float complex) * dm->work_size);
-    dm->work_b = aligned_alloc_32(sizeof(float complex) * dm->work_size);
-    dm->mag_f = aligned_alloc_32(sizeof(float) * dm->work_size);
-    dm->mag_filtered_f = aligned_alloc_32(sizeof(float) * dm->work_size);
+    /* ---- Working buffers (generous size, on huge pages if possible) ---- */
+    dm->work_size = config && config->work_size > 0
+        ? config->work_size
+        : 2 * 1024 * 1024;  /* 2M samples max */
+    dm->work_a = huge_alloc(sizeof(float complex) * dm->work_size, "downmix work");
+    dm->work_b = huge_alloc(sizeof(float complex) * dm->work_size, "downmix work");
+    dm->mag_f = huge_alloc(sizeof(float) * dm->work_size, "downmix work");
+    dm->mag_filtered_f = huge_alloc(sizeof(float) * dm->work_size, "downmix work");
+    if (!dm->work_a || !dm->work_b || !dm->mag_f || !dm->mag_filtered_f) {
+        burst_downmix_destroy(dm);
+        return NULL;
+    }
 
     return dm;
 }
@@ -404,10 +478,10 @@ void burst_downmix_destroy(burst_downmix_t *dm) {
     fftwf_free(dm->dl_sync_fft);
     fftwf_free(dm->ul_sync_fft);
 
-    free(dm->work_a);
-    free(dm->work_b);
-    free(dm->mag_f);
-    free(dm->mag_filtered_f);
+    huge_free(dm->work_a);
+    huge_free(dm->work_b);
+    huge_free(dm->mag_f);
+    huge_free(dm->mag_filtered_f);
 
     free(dm);
 }
@@ -647,11 +721,24 @@ int burst_downmix_process(burst_downmix_t *dm, burst_data_t *burst,
         return 0;
     }
 
-    int n = (int)burst->num_samples;
-    if (n > dm->work_size) n = dm->work_size;
+    upgrade_plans(dm);
+
+    /* Band restriction: the detector's center bin is accurate to within
+     * half a burst width, so reject before touching any samples */
+    if (dm->min_frequency > 0) {
+        double coarse = burst->center_frequency +
+            (double)(burst->info.center_bin - burst->fft_size / 2)
+            / burst->fft_size * burst->sample_rate;
+        if (coarse < dm->min_frequency - IR_DEFAULT_BURST_WIDTH / 2) {
+            *frames_out = NULL;
+            return 0;
+        }
+    }
 
-    /* Copy burst samples to working buffer */
-    memcpy(dm->work_a, burst->samples, n * sizeof(float complex));
+    /* Copy burst samples to working buffer, then let the detector have
+     * its ring space back */
+    int n = (int)burst_data_copy(burst, dm->work_a, (size_t)dm->work_size);
+    burst_data_release(burst);
 
     double center_frequency = burst->center_frequency;
     int in_sample_rate = burst->sample_rate;
@@ -795,34 +882,3 @@ int burst_downmix_process(burst_downmix_t *dm, burst_data_t *burst,
     *frames_out = frame;
     return 1;
 }
-
-/* ---- Thread function ---- */
-
-void *burst_downmix_thread(void *arg) {
-    burst_downmix_t *dm = (burst_downmix_t *)arg;
-
-    while (1) {
-        burst_data_t *burst;
-        if (blocking_queue_take(&burst_queue, &burst) != 0)
-            break;
-
-        downmix_frame_t *frames = NULL;
-        int n_frames = burst_downmix_process(dm, burst, &frames);
-
-        if (n_frames > 0 && frames) {
-            /* Push frame to queue (process returns a single malloc'd frame) */
-            if (blocking_queue_add(&frame_queue, frames) == BQ_FULL) {
-                free(frames->samples);
-                free(frames);
-            }
-        } else {
-            free(frames);
-        }
-
-        free(burst->samples);
-        free(burst);
-    }
-
-    burst_downmix_destroy(dm);
-    return NULL;
-}
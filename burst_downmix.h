@@ -58,11 +58,20 @@ typedef struct {
     int output_sample_rate;     /* 0 = auto (based on sps * symbol_rate) */
     int search_depth;           /* max samples to search for burst start */
     int handle_multiple_frames; /* allow multiple frames per burst */
+    double min_frequency;       /* Hz, 0 = any; drop bursts below this */
+    int work_size;              /* samples per work buffer, 0 = 2M; at
+                                 * least the detector's max burst span */
 } downmix_config_t;
 
-/* Create a downmix context */
+/* Create a downmix context; NULL if its buffers cannot be allocated */
 burst_downmix_t *burst_downmix_create(downmix_config_t *config);
 
+/* Sizes of the FFTs a context created from config plans with
+ * FFTW_MEASURE: the forward CFO FFT, and the correlation FFT (planned
+ * forward and backward). For --generate-wisdom. */
+void burst_downmix_fft_sizes(const downmix_config_t *config,
+                             int *cfo_size, int *corr_size);
+
 /* Process one burst, returns array of frames (may be >1 if multi-frame).
  * Caller owns returned frames and must free samples and frame array.
  * Returns number of frames (0 if burst could not be processed). */
@@ -72,7 +81,4 @@ int burst_downmix_process(burst_downmix_t *dm, burst_data_t *burst,
 /* Destroy */
 void burst_downmix_destroy(burst_downmix_t *dm);
 
-/* Thread function: pulls from burst_queue, pushes frames to frame_queue */
-void *burst_downmix_thread(void *arg);
-
 #endif
@@ -0,0 +1,242 @@
+/*
+ * Bounded burst priority queue with load shedding
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Bounded burst priority queue with load shedding -- two indexed
+ * min-heaps over one slot array, under one mutex
+ */
+
+#include <stdlib.h>
+
+#include "burst_pq.h"
+
+enum { BY_AGE, BY_KEY };
+
+static const char *bucket_names[BURST_PQ_BUCKETS] = {
+    "<20", "20-25", "25-30", "30-35", "35-40", ">=40",
+};
+
+static double burst_key(const burst_data_t *b)
+{
+    double t = b->sample_rate > 0
+               ? (double)b->info.start / b->sample_rate : 0.0;
+    return b->info.magnitude + BURST_PQ_AGE_DB_PER_SEC * t;
+}
+
+static int snr_bucket(float magnitude)
+{
+    if (magnitude < 20.0f)
+        return 0;
+    int b = 1 + (int)((magnitude - 20.0f) / 5.0f);
+    return b < BURST_PQ_BUCKETS ? b : BURST_PQ_BUCKETS - 1;
+}
+
+/* ---- Heaps ----
+ *
+ * heap[BY_AGE] and heap[BY_KEY] hold the same slot indices, each as a
+ * min-heap: oldest start first, and lowest shed key first. Every entry
+ * records its position in both, so a burst taken through one heap is
+ * removed from the other in O(log n). */
+
+static int before(const burst_pq_t *q, int h, unsigned a, unsigned b)
+{
+    const burst_pq_entry_t *x = &q->entries[a], *y = &q->entries[b];
+    return h == BY_AGE ? x->start < y->start : x->key < y->key;
+}
+
+static void heap_set(burst_pq_t *q, int h, unsigned i, unsigned slot)
+{
+    q->heap[h][i] = slot;
+    q->entries[slot].pos[h] = i;
+}
+
+static void sift_up(burst_pq_t *q, int h, unsigned i)
+{
+    unsigned slot = q->heap[h][i];
+    while (i > 0) {
+        unsigned parent = (i - 1) / 2;
+        if (!before(q, h, slot, q->heap[h][parent]))
+            break;
+        heap_set(q, h, i, q->heap[h][parent]);
+        i = parent;
+    }
+    heap_set(q, h, i, slot);
+}
+
+static void sift_down(burst_pq_t *q, int h, unsigned i, unsigned n)
+{
+    unsigned slot = q->heap[h][i];
+    for (;;) {
+        unsigned child = 2 * i + 1;
+        if (child >= n)
+            break;
+        if (child + 1 < n &&
+            before(q, h, q->heap[h][child + 1], q->heap[h][child]))
+            child++;
+        if (!before(q, h, q->heap[h][child], slot))
+            break;
+        heap_set(q, h, i, q->heap[h][child]);
+        i = child;
+    }
+    heap_set(q, h, i, slot);
+}
+
+static void insert(burst_pq_t *q, burst_data_t *burst)
+{
+    unsigned slot = q->free_slots[q->count];
+    q->entries[slot].key = burst_key(burst);
+    q->entries[slot].start = burst->info.start;
+    q->entries[slot].burst = burst;
+    for (int h = BY_AGE; h <= BY_KEY; h++) {
+        heap_set(q, h, q->count, slot);
+        sift_up(q, h, q->count);
+    }
+    q->count++;
+}
+
+/* Unlink a slot from both heaps and return its burst */
+static burst_data_t *remove_slot(burst_pq_t *q, unsigned slot)
+{
+    unsigned last = q->count - 1;
+    for (int h = BY_AGE; h <= BY_KEY; h++) {
+        unsigned i = q->entries[slot].pos[h];
+        unsigned moved = q->heap[h][last];
+        if (i == last)
+            continue;
+        heap_set(q, h, i, moved);
+        sift_down(q, h, i, last);
+        sift_up(q, h, q->entries[moved].pos[h]);
+    }
+    q->count = last;
+    q->free_slots[last] = slot;
+    return q->entries[slot].burst;
+}
+
+/* ---- Public API ---- */
+
+int burst_pq_init(burst_pq_t *q, unsigned capacity)
+{
+    q->entries = malloc(sizeof(*q->entries) * capacity);
+    q->heap[BY_AGE] = malloc(sizeof(unsigned) * capacity);
+    q->heap[BY_KEY] = malloc(sizeof(unsigned) * capacity);
+    q->free_slots = malloc(sizeof(unsigned) * capacity);
+    if (!q->entries || !q->heap[BY_AGE] || !q->heap[BY_KEY] ||
+        !q->free_slots) {
+        free(q->entries);
+        free(q->heap[BY_AGE]);
+        free(q->heap[BY_KEY]);
+        free(q->free_slots);
+        return -1;
+    }
+    for (unsigned i = 0; i < capacity; i++)
+        q->free_slots[i] = i;
+    q->capacity = capacity;
+    q->count = 0;
+    q->closed = 0;
+    for (int i = 0; i < BURST_PQ_BUCKETS; i++)
+        q->shed[i] = 0;
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->not_empty, NULL);
+    pthread_cond_init(&q->not_full, NULL);
+    return 0;
+}
+
+void burst_pq_destroy(burst_pq_t *q)
+{
+    pthread_cond_destroy(&q->not_full);
+    pthread_cond_destroy(&q->not_empty);
+    pthread_mutex_destroy(&q->lock);
+    free(q->entries);
+    free(q->heap[BY_AGE]);
+    free(q->heap[BY_KEY]);
+    free(q->free_slots);
+    q->entries = NULL;
+    q->heap[BY_AGE] = q->heap[BY_KEY] = NULL;
+    q->free_slots = NULL;
+}
+
+int burst_pq_put(burst_pq_t *q, burst_data_t *burst, int shed,
+                 burst_data_t **shed_out)
+{
+    burst_data_t *victim = NULL;
+
+    pthread_mutex_lock(&q->lock);
+    while (!shed && !q->closed && q->count == q->capacity)
+        pthread_cond_wait(&q->not_full, &q->lock);
+    if (q->closed) {
+        pthread_mutex_unlock(&q->lock);
+        return BURST_PQ_CLOSED;
+    }
+
+    if (q->count == q->capacity) {
+        /* Full: the lowest key of the queued bursts and the new one goes */
+        unsigned m = q->heap[BY_KEY][0];
+        if (burst_key(burst) <= q->entries[m].key) {
+            victim = burst;
+        } else {
+            victim = remove_slot(q, m);
+            insert(q, burst);
+        }
+        q->shed[snr_bucket(victim->info.magnitude)]++;
+    } else {
+        insert(q, burst);
+    }
+    pthread_cond_signal(&q->not_empty);
+    pthread_mutex_unlock(&q->lock);
+
+    if (victim) {
+        *shed_out = victim;
+        return BURST_PQ_SHED;
+    }
+    return 0;
+}
+
+int burst_pq_take(burst_pq_t *q, burst_data_t **burst)
+{
+    pthread_mutex_lock(&q->lock);
+    while (q->count == 0 && !q->closed)
+        pthread_cond_wait(&q->not_empty, &q->lock);
+    if (q->count == 0) {
+        pthread_mutex_unlock(&q->lock);
+        return BURST_PQ_CLOSED;
+    }
+
+    *burst = remove_slot(q, q->heap[BY_AGE][0]);
+    pthread_cond_signal(&q->not_full);
+    pthread_mutex_unlock(&q->lock);
+    return 0;
+}
+
+void burst_pq_close(burst_pq_t *q)
+{
+    pthread_mutex_lock(&q->lock);
+    q->closed = 1;
+    pthread_cond_broadcast(&q->not_empty);
+    pthread_cond_broadcast(&q->not_full);
+    pthread_mutex_unlock(&q->lock);
+}
+
+unsigned burst_pq_size(burst_pq_t *q)
+{
+    pthread_mutex_lock(&q->lock);
+    unsigned n = q->count;
+    pthread_mutex_unlock(&q->lock);
+    return n;
+}
+
+void burst_pq_shed_counts(burst_pq_t *q, unsigned long out[BURST_PQ_BUCKETS])
+{
+    pthread_mutex_lock(&q->lock);
+    for (int i = 0; i < BURST_PQ_BUCKETS; i++)
+        out[i] = q->shed[i];
+    pthread_mutex_unlock(&q->lock);
+}
+
+const char *burst_pq_bucket_name(int bucket)
+{
+    return bucket_names[bucket];
+}
@@ -0,0 +1,88 @@
+/*
+ * Bounded burst priority queue with load shedding
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Bounded burst priority queue with load shedding
+ *
+ * burst_queue between the detector and the downmix workers. Workers
+ * take the oldest burst (lowest start sample) first. That is the order
+ * in which the detector's ring writer reaches the bursts' ring pins, so
+ * the pin it would wait on is always the next one to be released.
+ *
+ * When the queue is full a shedding put gives back the burst with the
+ * lowest
+ *
+ *   magnitude (dB) + BURST_PQ_AGE_DB_PER_SEC * burst start time (s)
+ *
+ * (which may be the new one) instead of waiting, so an overloaded live
+ * capture loses its weakest and stalest bursts first rather than
+ * stalling the detector. Both terms are fixed when the burst is queued,
+ * so the order never has to be recomputed. Shed bursts are counted per
+ * SNR bucket. The file reader path uses a waiting put and stays
+ * lossless.
+ */
+
+#ifndef __BURST_PQ_H__
+#define __BURST_PQ_H__
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include "burst_detect.h"
+
+#define BURST_PQ_SHED    1
+#define BURST_PQ_CLOSED  4
+
+#define BURST_PQ_AGE_DB_PER_SEC  10.0
+
+/* Shed counters: below 20 dB, then 5 dB steps, then 40 dB and up */
+#define BURST_PQ_BUCKETS  6
+
+typedef struct {
+    double key;             /* shed order: lowest goes first */
+    uint64_t start;         /* service order: oldest goes first */
+    burst_data_t *burst;
+    unsigned pos[2];        /* index in each heap */
+} burst_pq_entry_t;
+
+typedef struct {
+    burst_pq_entry_t *entries;
+    unsigned *heap[2];      /* slot min-heaps by start and by key */
+    unsigned *free_slots;   /* [count, capacity) are unused slots */
+    unsigned capacity;
+    unsigned count;
+    int closed;
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    unsigned long shed[BURST_PQ_BUCKETS];
+} burst_pq_t;
+
+/* Returns 0 or -1 */
+int burst_pq_init(burst_pq_t *q, unsigned capacity);
+void burst_pq_destroy(burst_pq_t *q);
+
+/* Queue a burst. When full, shed removes the lowest-key burst
+ * (possibly this one), stores it in *shed_out for the caller to dispose
+ * of and returns BURST_PQ_SHED; without shed the call waits for room.
+ * Returns 0, BURST_PQ_SHED, or BURST_PQ_CLOSED, in which case the caller
+ * still owns the burst. */
+int burst_pq_put(burst_pq_t *q, burst_data_t *burst, int shed,
+                 burst_data_t **shed_out);
+
+/* Take the oldest burst, blocking while empty: 0, or
+ * BURST_PQ_CLOSED once closed and empty */
+int burst_pq_take(burst_pq_t *q, burst_data_t **burst);
+
+void burst_pq_close(burst_pq_t *q);
+unsigned burst_pq_size(burst_pq_t *q);
+
+/* Snapshot of the shed counters, and the bucket label for each */
+void burst_pq_shed_counts(burst_pq_t *q, unsigned long out[BURST_PQ_BUCKETS]);
+const char *burst_pq_bucket_name(int bucket);
+
+#endif
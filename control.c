@@ -0,0 +1,409 @@
+/*
+ * Control socket: runtime reconfiguration over a Unix-domain socket
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Control socket: runtime reconfiguration over a Unix-domain socket
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "control.h"
+#include "burst_pq.h"
+#include "frame_seq.h"
+#include "lf_queue.h"
+#include "logging.h"
+#include "output_sink.h"
+#include "sample_pool.h"
+#include "thread_place.h"
+
+#define CONTROL_LINE_MAX  512
+#define CONTROL_POLL_MS   250
+
+/* ---- Externs for threading integration ---- */
+
+extern spsc_queue_t samples_queue;
+extern burst_pq_t burst_queue;
+extern atomic_ulong stat_n_detected;
+extern atomic_ulong stat_n_handled;
+extern atomic_ulong stat_n_ok_bursts;
+extern atomic_ulong stat_n_ok_sub;
+extern atomic_ulong stat_n_dropped;
+extern atomic_ulong stat_sample_count;
+
+typedef struct {
+    int fd;                     /* -1 = free */
+    char line[CONTROL_LINE_MAX];
+    size_t len;
+    int overlong;               /* discarding the rest of a long line */
+} client_t;
+
+static int listen_fd = -1;
+static char *sock_path = NULL;
+static burst_detector_t *detector;
+static unsigned allowed_needs;
+static client_t clients[CONTROL_MAX_CLIENTS];
+static pthread_t control_thread;
+static atomic_int stop = 0;
+
+/* ---- Commands ---- */
+
+static const char *help_text =
+    "get\n"
+    "set threshold DB\n"
+    "set history N\n"
+    "set max_bursts N\n"
+    "set log CAT=LEVEL,...\n"
+    "noise-reset\n"
+    "sink NAME on|off\n"
+    "filter [SINK:]EXPR|none\n"
+    "stats\n"
+    "rotate\n";
+
+static void cmd_get(FILE *out)
+{
+    burst_settings_t s;
+    burst_detector_get_settings(detector, &s);
+    fprintf(out, "threshold %.1f\n", s.threshold_db);
+    fprintf(out, "history %d (max %d)\n", s.history, s.history_max);
+    fprintf(out, "max_bursts %d\n", s.max_bursts);
+    fprintf(out, "log ");
+    log_print_levels(out);
+    fprintf(out, "\n");
+    output_sinks_describe(out);
+}
+
+static void cmd_stats(FILE *out)
+{
+    unsigned long shed[BURST_PQ_BUCKETS], n_shed = 0;
+    burst_pq_shed_counts(&burst_queue, shed);
+    for (int i = 0; i < BURST_PQ_BUCKETS; i++)
+        n_shed += shed[i];
+
+    fprintf(out, "samples %lu\n", atomic_load(&stat_sample_count));
+    fprintf(out, "detected %lu\n", atomic_load(&stat_n_detected));
+    fprintf(out, "handled %lu\n", atomic_load(&stat_n_handled));
+    fprintf(out, "ok_bursts %lu\n", atomic_load(&stat_n_ok_bursts));
+    fprintf(out, "ok_frames %lu\n", atomic_load(&stat_n_ok_sub));
+    fprintf(out, "dropped %lu\n", atomic_load(&stat_n_dropped));
+    fprintf(out, "shed %lu\n", n_shed);
+    fprintf(out, "late %lu\n", frame_seq_late());
+    fprintf(out, "sample_overflows %lu\n", sample_pool_overflows());
+    fprintf(out, "samples_queue %u\n", spsc_queue_size(&samples_queue));
+    fprintf(out, "burst_queue %u\n", burst_pq_size(&burst_queue));
+}
+
+static int parse_int(const char *s, int *v)
+{
+    char *end;
+    long n = strtol(s, &end, 10);
+    if (end == s || *end != '\0' || n < 0 || n > 1000000)
+        return -1;
+    *v = (int)n;
+    return 0;
+}
+
+/* Run one command line; returns NULL for "ok" or the error message */
+static const char *run_command(char *line, FILE *out, char *err,
+                               size_t err_size)
+{
+    char *save;
+    char *cmd = strtok_r(line, " \t", &save);
+    char *arg1 = strtok_r(NULL, " \t", &save);
+    char *arg2 = strtok_r(NULL, "", &save);
+    if (arg2)
+        arg2 += strspn(arg2, " \t");
+
+    if (!cmd)
+        return "empty command";
+
+    if (strcmp(cmd, "help") == 0) {
+        fputs(help_text, out);
+        return NULL;
+    }
+    if (strcmp(cmd, "get") == 0) {
+        cmd_get(out);
+        return NULL;
+    }
+    if (strcmp(cmd, "stats") == 0) {
+        cmd_stats(out);
+        return NULL;
+    }
+    if (strcmp(cmd, "noise-reset") == 0) {
+        burst_detector_reset_noise(detector);
+        return NULL;
+    }
+    if (strcmp(cmd, "rotate") == 0)
+        return log_rotate() == 0 ? NULL : "no --log-file, or rename failed";
+
+    if (strcmp(cmd, "set") == 0) {
+        if (!arg1 || !arg2 || !*arg2)
+            return "usage: set NAME VALUE";
+        int n;
+        if (strcmp(arg1, "threshold") == 0) {
+            char *end;
+            double db = strtod(arg2, &end);
+            if (end == arg2 || *end != '\0' || db <= 0 || db > 60)
+                return "threshold must be 0-60 dB";
+            burst_detector_set_threshold(detector, (float)db);
+            return NULL;
+        }
+        if (strcmp(arg1, "history") == 0) {
+            if (parse_int(arg2, &n) != 0 ||
+                burst_detector_set_history(detector, n) != 0)
+                return "history must be 1 to the startup value";
+            return NULL;
+        }
+        if (strcmp(arg1, "max_bursts") == 0) {
+            if (parse_int(arg2, &n) != 0)
+                return "max_bursts must be a count, 0 = never squelch";
+            burst_detector_set_max_bursts(detector, n);
+            return NULL;
+        }
+        if (strcmp(arg1, "log") == 0)
+            return log_parse_levels(arg2) == 0 ? NULL : "bad log spec";
+        return "unknown setting";
+    }
+
+    if (strcmp(cmd, "sink") == 0) {
+        if (!arg1 || !arg2 ||
+            (strcmp(arg2, "on") != 0 && strcmp(arg2, "off") != 0))
+            return "usage: sink NAME on|off";
+        if (output_sink_enable(arg1, strcmp(arg2, "on") == 0) != 0)
+            return "no such sink";
+        return NULL;
+    }
+
+    if (strcmp(cmd, "filter") == 0) {
+        if (!arg1)
+            return "usage: filter [SINK:]EXPR|none";
+        /* Filter expressions contain no spaces, so a second word is an
+         * error rather than part of the expression */
+        if (arg2 && *arg2)
+            return "filter expressions take no spaces";
+        if (output_sink_set_filter(arg1, allowed_needs, err, err_size) != 0)
+            return err;
+        return NULL;
+    }
+
+    return "unknown command, try help";
+}
+
+/* ---- Connections ---- */
+
+static void send_all(int fd, const char *buf, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = send(fd, buf, len, MSG_NOSIGNAL);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR)
+                continue;
+            return;
+        }
+        buf += n;
+        len -= (size_t)n;
+    }
+}
+
+static void handle_line(client_t *c)
+{
+    char *reply = NULL;
+    size_t reply_len = 0;
+    FILE *out = open_memstream(&reply, &reply_len);
+    if (!out)
+        return;
+
+    char err[128];
+    const char *msg = c->overlong
+        ? "line too long"
+        : run_command(c->line, out, err, sizeof(err));
+    if (msg)
+        fprintf(out, "err %s\n", msg);
+    else
+        fprintf(out, "ok\n");
+    fclose(out);
+
+    send_all(c->fd, reply, reply_len);
+    free(reply);
+}
+
+static void client_close(client_t *c)
+{
+    close(c->fd);
+    c->fd = -1;
+}
+
+static void client_read(client_t *c)
+{
+    char buf[CONTROL_LINE_MAX];
+    ssize_t n = recv(c->fd, buf, sizeof(buf), 0);
+    if (n <= 0) {
+        if (n < 0 && errno == EINTR)
+            return;
+        client_close(c);
+        return;
+    }
+
+    for (ssize_t i = 0; i < n; i++) {
+        if (buf[i] == '\n') {
+            if (c->len > 0 && c->line[c->len - 1] == '\r')
+                c->len--;
+            c->line[c->len] = '\0';
+            if (c->len > 0 || c->overlong)
+                handle_line(c);
+            c->len = 0;
+            c->overlong = 0;
+        } else if (c->len < sizeof(c->line) - 1) {
+            c->line[c->len++] = buf[i];
+        } else {
+            c->overlong = 1;
+        }
+    }
+}
+
+static void accept_client(void)
+{
+    int fd = accept4(listen_fd, NULL, NULL, SOCK_CLOEXEC);
+    if (fd < 0)
+        return;
+
+    for (int i = 0; i < CONTROL_MAX_CLIENTS; i++) {
+        if (clients[i].fd < 0) {
+            /* A client that stops reading must not hang the thread */
+            struct timeval tv = { .tv_sec = 1 };
+            setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+            clients[i].fd = fd;
+            clients[i].len = 0;
+            clients[i].overlong = 0;
+            return;
+        }
+    }
+    static const char msg[] = "err too many control connections\n";
+    send_all(fd, msg, sizeof(msg) - 1);
+    close(fd);
+}
+
+static void *control_thread_fn(void *arg)
+{
+    (void)arg;
+
+    while (!atomic_load(&stop)) {
+        struct pollfd pfd[CONTROL_MAX_CLIENTS + 1];
+        int map[CONTROL_MAX_CLIENTS + 1];
+        int n = 0;
+
+        pfd[n].fd = listen_fd;
+        pfd[n].events = POLLIN;
+        map[n++] = -1;
+        for (int i = 0; i < CONTROL_MAX_CLIENTS; i++) {
+            if (clients[i].fd >= 0) {
+                pfd[n].fd = clients[i].fd;
+                pfd[n].events = POLLIN;
+                map[n++] = i;
+            }
+        }
+
+        if (poll(pfd, n, CONTROL_POLL_MS) <= 0)
+            continue;
+
+        for (int k = 0; k < n; k++) {
+            if (!(pfd[k].revents & (POLLIN | POLLHUP | POLLERR)))
+                continue;
+            if (map[k] < 0)
+                accept_client();
+            else
+                client_read(&clients[map[k]]);
+        }
+    }
+    return NULL;
+}
+
+/* ---- Start / stop ---- */
+
+int control_start(const char *path, burst_detector_t *det,
+                  unsigned filter_needs)
+{
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "control: socket path too long: %s\n", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    /* Replace a socket left behind by an earlier run, nothing else */
+    struct stat st;
+    if (lstat(path, &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            fprintf(stderr, "control: %s exists and is not a socket\n", path);
+            return -1;
+        }
+        unlink(path);
+    }
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0 ||
+        bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        chmod(path, 0600) != 0 ||
+        listen(listen_fd, CONTROL_MAX_CLIENTS) != 0) {
+        fprintf(stderr, "control: cannot listen on %s: %s\n", path,
+                strerror(errno));
+        if (listen_fd >= 0)
+            close(listen_fd);
+        listen_fd = -1;
+        return -1;
+    }
+
+    sock_path = strdup(path);
+    detector = det;
+    allowed_needs = filter_needs;
+    for (int i = 0; i < CONTROL_MAX_CLIENTS; i++)
+        clients[i].fd = -1;
+
+    atomic_store(&stop, 0);
+    int err = pthread_create(&control_thread, NULL, control_thread_fn, NULL);
+    if (err != 0) {
+        fprintf(stderr, "control: cannot start thread: %s\n", strerror(err));
+        close(listen_fd);
+        listen_fd = -1;
+        unlink(sock_path);
+        free(sock_path);
+        sock_path = NULL;
+        return -1;
+    }
+#ifdef __linux__
+    pthread_setname_np(control_thread, "control");
+#endif
+    thread_place_apply(control_thread, ROLE_STATS, "control");
+    return 0;
+}
+
+void control_stop(void)
+{
+    if (listen_fd < 0)
+        return;
+
+    atomic_store(&stop, 1);
+    pthread_join(control_thread, NULL);
+    for (int i = 0; i < CONTROL_MAX_CLIENTS; i++)
+        if (clients[i].fd >= 0)
+            client_close(&clients[i]);
+    close(listen_fd);
+    listen_fd = -1;
+    unlink(sock_path);
+    free(sock_path);
+    sock_path = NULL;
+}
@@ -0,0 +1,54 @@
+/*
+ * Control socket: runtime reconfiguration over a Unix-domain socket
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Control socket: runtime reconfiguration over a Unix-domain socket
+ *
+ * --control=PATH listens on a Unix stream socket (mode 0600) for a small
+ * line protocol, so detection and output can be retuned without a
+ * restart, which would lose the noise estimate, the FFTW plans and the
+ * data in between. One command per line; each reply is zero or more
+ * data lines followed by "ok" or "err MESSAGE":
+ *
+ *   get                      current settings and sinks
+ *   set threshold DB         detection threshold
+ *   set history N            noise floor history in FFT frames, up to
+ *                            the startup value; resets the estimate
+ *   set max_bursts N         squelch limit, 0 = never squelch
+ *   set log CAT=LEVEL,...    diagnostic levels, as --log
+ *   noise-reset              restart the noise floor estimate
+ *   sink NAME on|off         stop or resume feeding an output sink
+ *   filter [SINK:]EXPR|none  replace a --filter
+ *   stats                    pipeline counters
+ *   rotate                   move the --log-file to PATH.1, start anew
+ *   help
+ *
+ * Detector changes take effect at the start of the detector's next
+ * sample block. Filters are swapped between frames. A filter on decoder
+ * results this run does not produce is refused, because the decoders
+ * are chosen at startup.
+ *
+ *   echo 'set threshold 18' | socat - UNIX-CONNECT:/run/iridium.ctl
+ */
+
+#ifndef __CONTROL_H__
+#define __CONTROL_H__
+
+#include "burst_detect.h"
+
+#define CONTROL_MAX_CLIENTS  4
+
+/* Listen on path and start the control thread. filter_needs is the
+ * FILTER_NEEDS_* set the decoders were started with. Returns 0, or -1
+ * with a message on stderr. */
+int control_start(const char *path, burst_detector_t *det,
+                  unsigned filter_needs);
+
+/* Stop the thread and remove the socket */
+void control_stop(void);
+
+#endif
@@ -15,9 +15,13 @@
 
 #include "doppler_pos.h"
 #include "wgs84.h"
+#include "logging.h"
 #include "gsmtap.h"  /* IR_BASE_FREQ, IR_CHANNEL_WIDTH */
 
-extern int verbose;
+/* Diagnostics run per IRA frame and per solve: debug level, via the
+ * async logger */
+#define pos_debug()    log_enabled(LOGC_DOPPLER, LOGL_DEBUG)
+#define pos_log(...)   log_write(LOGC_DOPPLER, __VA_ARGS__)
 
 /* ---- Configuration ---- */
 
@@ -373,9 +377,9 @@ void doppler_pos_add_measurement(const ira_data_t *ira, double frequency,
              * this 7-bit sat_id. Reset the buffer to avoid mixing
              * measurements from different orbital planes. */
             if (dt > SAT_GAP_RESET_S) {
-                if (verbose)
-                    fprintf(stderr, "DOPPLER: sat=%d gap=%.0fs, "
-                            "resetting buffer (likely new pass)\n",
+                if (pos_debug())
+                    pos_log("DOPPLER: sat=%d gap=%.0fs, "
+                            "resetting buffer (likely new pass)",
                             ira->sat_id, dt);
                 s->count = 0;
                 s->head = 0;
@@ -398,20 +402,20 @@ void doppler_pos_add_measurement(const ira_data_t *ira, double frequency,
     }
     pthread_mutex_unlock(&pos_lock);
 
-    if (verbose) {
+    if (pos_debug()) {
         double slat, slon, salt;
         ecef_to_geodetic(sat_ecef, &slat, &slon, &salt);
-        fprintf(stderr, "DOPPLER: accepted sat=%d pos=%.1f,%.1f "
-                "alt=%.0fkm freq=%.0f\n",
+        pos_log("DOPPLER: accepted sat=%d pos=%.1f,%.1f "
+                "alt=%.0fkm freq=%.0f",
                 ira->sat_id, slat, slon, salt/1000.0, frequency);
     }
     dbg_ok++;
 
 dbg_print:
-    if (verbose && dbg_total % 50 == 0)
-        fprintf(stderr, "DOPPLER: ira_total=%lu ok=%lu "
+    if (pos_debug() && dbg_total % 50 == 0)
+        pos_log("DOPPLER: ira_total=%lu ok=%lu "
                 "reject_sat0=%lu reject_coord=%lu reject_radius=%lu "
-                "reject_vel=%lu\n",
+                "reject_vel=%lu",
                 dbg_total, dbg_ok, dbg_sat0, dbg_coord, dbg_radius,
                 dbg_vel_rej);
 }
@@ -542,12 +546,12 @@ int doppler_pos_solve(doppler_solution_t *out)
                     double dist = vec3_norm(d);
                     if (dist < MAX_SAT_CLUSTER_DIST) {
                         sat_keep[s] = 1;
-                    } else if (verbose) {
+                    } else if (pos_debug()) {
                         double slat, slon, salt;
                         ecef_to_geodetic(sat_pos[s], &slat, &slon, &salt);
-                        fprintf(stderr, "DOPPLER: visibility reject "
+                        pos_log("DOPPLER: visibility reject "
                                 "sat=%d pos=%.1f,%.1f (%.0fkm from core "
-                                "sat=%d)\n", satellites[s].sat_id, slat, slon,
+                                "sat=%d)", satellites[s].sat_id, slat, slon,
                                 dist / 1000.0, satellites[core].sat_id);
                     }
                 }
@@ -619,14 +623,14 @@ int doppler_pos_solve(doppler_solution_t *out)
 done_collect:
 
     /* Debug: show buffer state vs usable measurements */
-    if (verbose) {
+    if (pos_debug()) {
         int total_buf = 0;
         for (int s = 0; s < n_satellites; s++)
             total_buf += satellites[s].count;
         static int solve_dbg_cnt = 0;
         if (solve_dbg_cnt++ % 6 == 0)
-            fprintf(stderr, "DOPPLER: buffers=%d stored=%d usable=%d "
-                    "from %d sats\n",
+            pos_log("DOPPLER: buffers=%d stored=%d usable=%d "
+                    "from %d sats",
                     n_satellites, total_buf, n_meas, sats_used);
     }
 
@@ -692,11 +696,11 @@ done_collect:
         }
     }
 
-    if (verbose) {
+    if (pos_debug()) {
         double lat0, lon0, alt0;
         ecef_to_geodetic(rx_ecef, &lat0, &lon0, &alt0);
-        fprintf(stderr, "DOPPLER: init pos=%.4f,%.4f alt=%.0f "
-                "n_meas=%d n_sats=%d\n", lat0, lon0, alt0, n_meas, sats_used);
+        pos_log("DOPPLER: init pos=%.4f,%.4f alt=%.0f "
+                "n_meas=%d n_sats=%d", lat0, lon0, alt0, n_meas, sats_used);
     }
 
     /* Iterated Weighted Least Squares */
@@ -800,7 +804,8 @@ done_collect:
         memcpy(HtWH_copy, HtWH, sizeof(HtWH));
         double inv[4][4];
         if (mat4_invert(HtWH_copy, inv) != 0) {
-            fprintf(stderr, "DOPPLER: solver FAIL - singular matrix at iter %d\n", iter);
+            log_msg(LOGC_DOPPLER, LOGL_WARN,
+                    "DOPPLER: solver FAIL - singular matrix at iter %d", iter);
             return 0;
         }
 
@@ -830,11 +835,11 @@ done_collect:
         double correction = sqrt(delta[0]*delta[0] + delta[1]*delta[1] +
                                   delta[2]*delta[2]);
 
-        if (verbose && (iter < 3 || iter == MAX_ITERATIONS - 1)) {
+        if (pos_debug() && (iter < 3 || iter == MAX_ITERATIONS - 1)) {
             double lat, lon, alt;
             ecef_to_geodetic(rx_ecef, &lat, &lon, &alt);
-            fprintf(stderr, "DOPPLER: iter %d: correction=%.0f m, "
-                    "pos=%.4f,%.4f alt=%.0f clk=%.1f\n",
+            pos_log("DOPPLER: iter %d: correction=%.0f m, "
+                    "pos=%.4f,%.4f alt=%.0f clk=%.1f",
                     iter, correction, lat, lon, alt, clock_drift);
         }
 
@@ -845,11 +850,11 @@ done_collect:
     }
 
     if (!converged) {
-        if (verbose) {
+        if (pos_debug()) {
             double flat, flon, falt;
             ecef_to_geodetic(rx_ecef, &flat, &flon, &falt);
-            fprintf(stderr, "DOPPLER: solver FAIL - %d iters, %d meas, %d sats, "
-                    "final=%.2f,%.2f alt=%.0fkm clk=%.1f\n",
+            pos_log("DOPPLER: solver FAIL - %d iters, %d meas, %d sats, "
+                    "final=%.2f,%.2f alt=%.0fkm clk=%.1f",
                     MAX_ITERATIONS, n_meas, sats_used, flat, flon, falt/1000,
                     clock_drift);
         }
@@ -982,7 +987,8 @@ done_collect:
                 memcpy(HtWH2_copy, HtWH2, sizeof(HtWH2));
                 double inv2[4][4];
                 if (mat4_invert(HtWH2_copy, inv2) != 0) {
-                    fprintf(stderr, "DOPPLER: re-solve FAIL - singular matrix\n");
+                    log_msg(LOGC_DOPPLER, LOGL_WARN,
+                            "DOPPLER: re-solve FAIL - singular matrix");
                     return 0;
                 }
 
@@ -1005,7 +1011,8 @@ done_collect:
             }
 
             if (!converged) {
-                fprintf(stderr, "DOPPLER: re-solve FAIL - did not converge\n");
+                log_msg(LOGC_DOPPLER, LOGL_WARN,
+                        "DOPPLER: re-solve FAIL - did not converge");
                 return 0;
             }
 
@@ -1082,9 +1089,9 @@ done_collect:
             for (int i = 0; i < n_active; i++) {
                 int s = active_sats[i];
                 if (sat_mean_res[s] > 3.0 * median_res && median_res > 0) {
-                    if (verbose)
-                        fprintf(stderr, "DOPPLER: dropping sat_idx=%d "
-                                "(sat_id=%d) residual=%.1f vs median=%.1f\n",
+                    if (pos_debug())
+                        pos_log("DOPPLER: dropping sat_idx=%d "
+                                "(sat_id=%d) residual=%.1f vs median=%.1f",
                                 s, satellites[s].sat_id,
                                 sat_mean_res[s], median_res);
                     /* Zero out all measurements from this satellite */
@@ -1170,8 +1177,9 @@ done_collect:
                         memcpy(HtWH3_copy, HtWH3, sizeof(HtWH3));
                         double inv3[4][4];
                         if (mat4_invert(HtWH3_copy, inv3) != 0) {
-                            fprintf(stderr, "DOPPLER: per-sat re-solve "
-                                    "FAIL - singular matrix\n");
+                            log_msg(LOGC_DOPPLER, LOGL_WARN,
+                                    "DOPPLER: per-sat re-solve "
+                                    "FAIL - singular matrix");
                             return 0;
                         }
 
@@ -1195,15 +1203,15 @@ done_collect:
                     }
 
                     if (!converged) {
-                        if (verbose)
-                            fprintf(stderr, "DOPPLER: per-sat re-solve "
-                                    "FAIL - did not converge\n");
+                        if (pos_debug())
+                            pos_log("DOPPLER: per-sat re-solve "
+                                    "FAIL - did not converge");
                         return 0;
                     }
                 } else {
-                    if (verbose)
-                        fprintf(stderr, "DOPPLER: per-sat screening left "
-                                "too few measurements (%d meas, %d sats)\n",
+                    if (pos_debug())
+                        pos_log("DOPPLER: per-sat screening left "
+                                "too few measurements (%d meas, %d sats)",
                                 remaining, sats_used);
                     return 0;
                 }
@@ -1295,11 +1303,11 @@ done_collect:
         if (jump > MAX_SOLUTION_JUMP) {
             jump_reject_count++;
             if (jump_reject_count < 5) {
-                if (verbose) {
+                if (pos_debug()) {
                     double jlat, jlon, jalt;
                     ecef_to_geodetic(rx_ecef, &jlat, &jlon, &jalt);
-                    fprintf(stderr, "DOPPLER: rejecting %.0fkm jump to "
-                            "%.4f,%.4f (reject #%d)\n",
+                    pos_log("DOPPLER: rejecting %.0fkm jump to "
+                            "%.4f,%.4f (reject #%d)",
                             jump / 1000.0, jlat, jlon, jump_reject_count);
                 }
                 /* Return the previous solution instead */
@@ -1310,9 +1318,9 @@ done_collect:
                 out->converged = 1;
                 return 1;
             } else {
-                if (verbose)
-                    fprintf(stderr, "DOPPLER: accepting jump after %d "
-                            "consecutive rejections (resetting)\n",
+                if (pos_debug())
+                    pos_log("DOPPLER: accepting jump after %d "
+                            "consecutive rejections (resetting)",
                             jump_reject_count);
                 jump_reject_count = 0;
             }
@@ -0,0 +1,211 @@
+/*
+ * iridium-json-bench: streaming JSON writer vs snprintf
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * iridium-json-bench: streaming JSON writer vs snprintf
+ *
+ * Builds a web-map style snapshot (POINTS satellite points, the shape of
+ * the /api/state "ra" array) both the way build_json() used to, with one
+ * snprintf() per point, and with json_writer. The two outputs must be
+ * byte-identical; the time per build is printed for each.
+ *
+ * Then checks jw_double() against printf("%.*f") for FUZZ random values
+ * at every precision the sniffer uses. printf writes a negative value
+ * that rounds to zero as "-0.00"; jw_double() writes "0.00". Those are
+ * counted separately and are not errors.
+ *
+ *   iridium-json-bench [POINTS] [BUILDS] [FUZZ]
+ *
+ * Exits 1 on any mismatch.
+ */
+
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "json_writer.h"
+
+#define BUF_SIZE (1 << 22)
+
+typedef struct {
+    double lat, lon;
+    int alt, sat_id, beam_id, n_pages;
+    uint32_t tmsi;
+    double frequency;
+    uint64_t timestamp;
+} point_t;
+
+static uint64_t rng = 0x9e3779b97f4a7c15ULL;
+
+static uint64_t next_u64(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return rng;
+}
+
+static double uniform(double lo, double hi)
+{
+    return lo + (hi - lo) * (double)(next_u64() >> 11) / 9007199254740992.0;
+}
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* ---- The two builders ---- */
+
+static int build_snprintf(char *buf, int bufsize, const point_t *pts, int n)
+{
+    int off = snprintf(buf, bufsize, "{\"ra\":[");
+    for (int i = 0; i < n; i++) {
+        const point_t *p = &pts[i];
+        if (i > 0)
+            off += snprintf(buf + off, bufsize - off, ",");
+        off += snprintf(buf + off, bufsize - off,
+            "{\"lat\":%.4f,\"lon\":%.4f,\"alt\":%d,"
+            "\"sat\":%d,\"beam\":%d,\"pages\":%d,"
+            "\"tmsi\":%u,\"freq\":%.0f,\"t\":%llu}",
+            p->lat, p->lon, p->alt,
+            p->sat_id, p->beam_id, p->n_pages,
+            p->tmsi, p->frequency,
+            (unsigned long long)(p->timestamp / 1000000000ULL));
+    }
+    off += snprintf(buf + off, bufsize - off, "]}");
+    return off;
+}
+
+static int build_jw(char *buf, int bufsize, const point_t *pts, int n)
+{
+    json_writer_t jw;
+    jw_init(&jw, buf, bufsize);
+    jw_object_begin(&jw);
+    jw_key(&jw, "ra");
+    jw_array_begin(&jw);
+    for (int i = 0; i < n; i++) {
+        const point_t *p = &pts[i];
+        jw_object_begin(&jw);
+        jw_kv_double(&jw, "lat", p->lat, 4);
+        jw_kv_double(&jw, "lon", p->lon, 4);
+        jw_kv_int(&jw, "alt", p->alt);
+        jw_kv_int(&jw, "sat", p->sat_id);
+        jw_kv_int(&jw, "beam", p->beam_id);
+        jw_kv_int(&jw, "pages", p->n_pages);
+        jw_kv_uint(&jw, "tmsi", p->tmsi);
+        jw_kv_double(&jw, "freq", p->frequency, 0);
+        jw_kv_uint(&jw, "t", p->timestamp / 1000000000ULL);
+        jw_object_end(&jw);
+    }
+    jw_array_end(&jw);
+    jw_object_end(&jw);
+    return jw_ok(&jw) ? (int)jw_len(&jw) : -1;
+}
+
+/* ---- jw_double() against printf ---- */
+
+static long fuzz_double(long n, long *neg_zero)
+{
+    static const int decimals[] = { 0, 1, 2, 4, 6 };
+    char want[64], got[64];
+    long errors = 0;
+
+    for (long i = 0; i < n; i++) {
+        /* Mix of map coordinates, levels, frequencies and tiny values */
+        double v;
+        switch (i % 4) {
+        case 0:  v = uniform(-180.0, 180.0); break;
+        case 1:  v = uniform(-60.0, 0.0); break;
+        case 2:  v = uniform(1.616e9, 1.6265e9); break;
+        default: v = uniform(-1.0, 1.0) * 1e-3; break;
+        }
+        int d = decimals[i % 5];
+
+        snprintf(want, sizeof(want), "%.*f", d, v);
+        json_writer_t jw;
+        jw_init(&jw, got, sizeof(got));
+        jw_double(&jw, v, d);
+
+        if (strcmp(want, got) == 0)
+            continue;
+        if (want[0] == '-' && strcmp(want + 1, got) == 0 &&
+            strspn(got, "0.") == strlen(got)) {
+            (*neg_zero)++;
+            continue;
+        }
+        if (errors++ < 10)
+            fprintf(stderr, "ERROR: %.17g at %d decimals: printf \"%s\", "
+                    "jw_double \"%s\"\n", v, d, want, got);
+    }
+    return errors;
+}
+
+int main(int argc, char **argv)
+{
+    int n_points = argc > 1 ? atoi(argv[1]) : 2000;
+    int n_builds = argc > 2 ? atoi(argv[2]) : 2000;
+    long n_fuzz = argc > 3 ? atol(argv[3]) : 5000000;
+    if (n_points <= 0 || n_points > 20000 || n_builds <= 0 || n_fuzz < 0) {
+        fprintf(stderr, "usage: %s [POINTS] [BUILDS] [FUZZ]\n", argv[0]);
+        return 2;
+    }
+
+    point_t *pts = calloc(n_points, sizeof(*pts));
+    char *a = malloc(BUF_SIZE), *b = malloc(BUF_SIZE);
+    if (!pts || !a || !b) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    for (int i = 0; i < n_points; i++) {
+        pts[i].lat = uniform(-90.0, 90.0);
+        pts[i].lon = uniform(-180.0, 180.0);
+        pts[i].alt = (int)uniform(-100.0, 800.0);
+        pts[i].sat_id = (int)uniform(0.0, 128.0);
+        pts[i].beam_id = (int)uniform(0.0, 48.0);
+        pts[i].n_pages = (int)uniform(0.0, 8.0);
+        pts[i].tmsi = (uint32_t)next_u64();
+        pts[i].frequency = uniform(1.616e9, 1.6265e9);
+        pts[i].timestamp = 1700000000ULL * 1000000000ULL +
+                           (next_u64() >> 20);
+    }
+
+    int len_a = build_snprintf(a, BUF_SIZE, pts, n_points);
+    int len_b = build_jw(b, BUF_SIZE, pts, n_points);
+    int identical = len_a == len_b && memcmp(a, b, len_a) == 0;
+    printf("%d points, %d bytes, %s\n", n_points, len_a,
+           identical ? "byte-identical" : "OUTPUT DIFFERS");
+
+    double t0 = now_sec();
+    for (int i = 0; i < n_builds; i++)
+        build_snprintf(a, BUF_SIZE, pts, n_points);
+    double t_snprintf = (now_sec() - t0) / n_builds;
+
+    t0 = now_sec();
+    for (int i = 0; i < n_builds; i++)
+        build_jw(b, BUF_SIZE, pts, n_points);
+    double t_jw = (now_sec() - t0) / n_builds;
+
+    printf("snprintf     %8.3f ms/build\n", t_snprintf * 1e3);
+    printf("json_writer  %8.3f ms/build  %.1fx\n", t_jw * 1e3,
+           t_snprintf / t_jw);
+
+    long neg_zero = 0;
+    long errors = fuzz_double(n_fuzz, &neg_zero);
+    printf("jw_double: %ld values, %ld mismatches, %ld printf \"-0\"\n",
+           n_fuzz, errors, neg_zero);
+
+    free(pts);
+    free(a);
+    free(b);
+    return (identical && errors == 0) ? 0 : 1;
+}
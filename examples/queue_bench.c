@@ -0,0 +1,182 @@
+/*
+ * iridium-queue-bench: pipeline queue throughput comparison
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * iridium-queue-bench: pipeline queue throughput comparison
+ *
+ * Moves pointers through Blocking_Queue and through the lock-free
+ * queues in the three shapes the pipeline uses:
+ *
+ *   1 -> 1   samples_queue  (SDR -> detector)
+ *   1 -> 4   burst_queue    (detector -> downmix workers)
+ *   4 -> 1   frame_queue    (downmix workers -> demod)
+ *
+ * Every producer uses the blocking put and every consumer the blocking
+ * take, so both sides sleep when they get ahead, as in the sniffer.
+ *
+ *   iridium-queue-bench [ITEMS] [CAPACITY]
+ */
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "lf_queue.h"
+
+#define C_FEK_BLOCKING_QUEUE_IMPLEMENTATION
+#define C_FEK_FAIR_LOCK_IMPLEMENTATION
+#include "blocking_queue.h"
+
+#define MAX_THREADS 8
+
+typedef enum { Q_BLOCKING, Q_SPSC, Q_MPMC } queue_kind_t;
+
+typedef struct {
+    queue_kind_t kind;
+    Blocking_Queue bq;
+    spsc_queue_t spsc;
+    mpmc_queue_t mpmc;
+    long items_per_producer;
+    int consumers;
+} bench_t;
+
+typedef struct {
+    bench_t *b;
+    uintptr_t sum;
+    long count;
+} worker_t;
+
+static int q_put(bench_t *b, void *p)
+{
+    switch (b->kind) {
+    case Q_BLOCKING: return blocking_queue_put(&b->bq, p);
+    case Q_SPSC:     return spsc_queue_put(&b->spsc, p);
+    default:         return mpmc_queue_put(&b->mpmc, p);
+    }
+}
+
+static int q_take(bench_t *b, void *p)
+{
+    switch (b->kind) {
+    case Q_BLOCKING: return blocking_queue_take(&b->bq, p);
+    case Q_SPSC:     return spsc_queue_take(&b->spsc, p);
+    default:         return mpmc_queue_take(&b->mpmc, p);
+    }
+}
+
+/* Item 0 is the stop marker, one per consumer */
+static void *producer(void *arg)
+{
+    worker_t *w = arg;
+    for (long i = 1; i <= w->b->items_per_producer; i++)
+        q_put(w->b, (void *)(uintptr_t)i);
+    return NULL;
+}
+
+static void *consumer(void *arg)
+{
+    worker_t *w = arg;
+    for (;;) {
+        void *p;
+        if (q_take(w->b, &p) != 0 || p == NULL)
+            break;
+        w->sum += (uintptr_t)p;
+        w->count++;
+    }
+    return NULL;
+}
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double run(queue_kind_t kind, int producers, int consumers,
+                  long items, unsigned capacity)
+{
+    bench_t b = { .kind = kind, .consumers = consumers };
+    b.items_per_producer = items / producers;
+
+    switch (kind) {
+    case Q_BLOCKING: blocking_queue_init(&b.bq, capacity); break;
+    case Q_SPSC:     spsc_queue_init(&b.spsc, capacity); break;
+    case Q_MPMC:     mpmc_queue_init(&b.mpmc, capacity); break;
+    }
+
+    pthread_t pt[MAX_THREADS], ct[MAX_THREADS];
+    worker_t pw[MAX_THREADS] = {{0}}, cw[MAX_THREADS] = {{0}};
+
+    double t0 = now_sec();
+    for (int i = 0; i < consumers; i++) {
+        cw[i].b = &b;
+        pthread_create(&ct[i], NULL, consumer, &cw[i]);
+    }
+    for (int i = 0; i < producers; i++) {
+        pw[i].b = &b;
+        pthread_create(&pt[i], NULL, producer, &pw[i]);
+    }
+    for (int i = 0; i < producers; i++)
+        pthread_join(pt[i], NULL);
+    for (int i = 0; i < consumers; i++)
+        q_put(&b, NULL);
+    for (int i = 0; i < consumers; i++)
+        pthread_join(ct[i], NULL);
+    double dt = now_sec() - t0;
+
+    /* Every item exactly once */
+    uintptr_t sum = 0;
+    long count = 0;
+    for (int i = 0; i < consumers; i++) {
+        sum += cw[i].sum;
+        count += cw[i].count;
+    }
+    uintptr_t n = b.items_per_producer;
+    if (count != (long)n * producers || sum != n * (n + 1) / 2 * producers)
+        fprintf(stderr, "ERROR: %ld items received, checksum mismatch\n",
+                count);
+
+    switch (kind) {
+    case Q_BLOCKING: blocking_queue_destroy(&b.bq); break;
+    case Q_SPSC:     spsc_queue_destroy(&b.spsc); break;
+    case Q_MPMC:     mpmc_queue_destroy(&b.mpmc); break;
+    }
+    return count / dt;
+}
+
+int main(int argc, char **argv)
+{
+    long items = argc > 1 ? atol(argv[1]) : 4000000;
+    unsigned capacity = argc > 2 ? (unsigned)atoi(argv[2]) : 1024;
+
+    static const struct {
+        const char *edge;
+        int producers, consumers;
+        queue_kind_t lockfree;
+    } shapes[] = {
+        { "1 -> 1 (samples)", 1, 1, Q_SPSC },
+        { "1 -> 4 (bursts) ", 1, 4, Q_MPMC },
+        { "4 -> 1 (frames) ", 4, 1, Q_MPMC },
+    };
+
+    printf("%ld items, capacity %u\n\n", items, capacity);
+    printf("%-18s %16s %16s %8s\n", "edge", "Blocking_Queue", "lock-free",
+           "speedup");
+    for (size_t i = 0; i < sizeof(shapes) / sizeof(shapes[0]); i++) {
+        double base = run(Q_BLOCKING, shapes[i].producers,
+                          shapes[i].consumers, items, capacity);
+        double lf = run(shapes[i].lockfree, shapes[i].producers,
+                        shapes[i].consumers, items, capacity);
+        printf("%-18s %11.2f M/s %11.2f M/s %7.1fx\n", shapes[i].edge,
+               base / 1e6, lf / 1e6, lf / base);
+    }
+    return 0;
+}
@@ -0,0 +1,166 @@
+/*
+ * iridium-udp-batch-check: loopback order and count check for udp_batch
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * iridium-udp-batch-check: loopback order and count check for udp_batch
+ *
+ * Sends N datagrams of varying length through udp_batch_send() to a
+ * receiver on 127.0.0.1 and checks that every one arrives once, in
+ * order, with its length and payload intact. Every 256th datagram is
+ * followed by a pause longer than UDP_BATCH_MS and a udp_batch_tick(),
+ * so the age trigger and the tick path are exercised as well as full
+ * batches. A few datagrams are nearly as large as the arena, so the
+ * arena-full trigger is exercised too.
+ *
+ * The sender stays at most WINDOW datagrams ahead of the receiver so a
+ * full socket buffer cannot drop anything on the way.
+ *
+ *   iridium-udp-batch-check [N]
+ *
+ * Exits 0 and prints the syscall count if everything arrived.
+ */
+
+#define _GNU_SOURCE
+#include <arpa/inet.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "udp_batch.h"
+
+#define WINDOW      1024
+#define MAX_PAYLOAD 65536
+
+static long n_total;
+static atomic_long n_received;
+static long n_errors;
+
+/* Datagram i: 4-byte big-endian sequence number, then bytes (i + k) & 0xff */
+static size_t payload_len(long i)
+{
+    if (i % 997 == 500)
+        return 60000;                   /* most of the arena */
+    return 4 + (size_t)(i * 37 % 1400);
+}
+
+static void fill(uint8_t *buf, long i, size_t len)
+{
+    buf[0] = (uint8_t)(i >> 24);
+    buf[1] = (uint8_t)(i >> 16);
+    buf[2] = (uint8_t)(i >> 8);
+    buf[3] = (uint8_t)i;
+    for (size_t k = 4; k < len; k++)
+        buf[k] = (uint8_t)(i + k);
+}
+
+static void *receiver(void *arg)
+{
+    int fd = *(int *)arg;
+    static uint8_t buf[MAX_PAYLOAD], want[MAX_PAYLOAD];
+
+    for (long i = 0; i < n_total; i++) {
+        ssize_t r = recv(fd, buf, sizeof(buf), 0);
+        if (r < 0) {
+            fprintf(stderr, "ERROR: recv timed out after %ld datagrams\n", i);
+            n_errors++;
+            break;
+        }
+        size_t len = payload_len(i);
+        fill(want, i, len);
+        if ((size_t)r != len || memcmp(buf, want, len) != 0) {
+            long seq = r >= 4 ? (long)buf[0] << 24 | (long)buf[1] << 16 |
+                                (long)buf[2] << 8 | buf[3] : -1;
+            if (n_errors++ < 10)
+                fprintf(stderr, "ERROR: datagram %ld: got seq %ld, %zd "
+                        "bytes, want %zu bytes\n", i, seq, r, len);
+        }
+        atomic_store(&n_received, i + 1);
+    }
+    return NULL;
+}
+
+static void sleep_ms(long ms)
+{
+    struct timespec ts = { ms / 1000, (ms % 1000) * 1000000 };
+    nanosleep(&ts, NULL);
+}
+
+int main(int argc, char **argv)
+{
+    n_total = argc > 1 ? atol(argv[1]) : 20000;
+    if (n_total <= 0 || n_total > 0x7fffffffL) {
+        fprintf(stderr, "usage: %s [N]\n", argv[0]);
+        return 2;
+    }
+
+    int rx = socket(AF_INET, SOCK_DGRAM, 0);
+    int tx = socket(AF_INET, SOCK_DGRAM, 0);
+    if (rx < 0 || tx < 0) {
+        perror("socket");
+        return 1;
+    }
+
+    struct sockaddr_in addr = { .sin_family = AF_INET };
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t alen = sizeof(addr);
+    int rcvbuf = 8 << 20;
+    struct timeval tv = { 5, 0 };
+    setsockopt(rx, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    setsockopt(rx, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    if (bind(rx, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        getsockname(rx, (struct sockaddr *)&addr, &alen) < 0) {
+        perror("bind");
+        return 1;
+    }
+
+    pthread_t rt;
+    if (pthread_create(&rt, NULL, receiver, &rx) != 0) {
+        fprintf(stderr, "ERROR: cannot start receiver thread\n");
+        return 1;
+    }
+
+    static udp_batch_t batch;
+    static uint8_t buf[MAX_PAYLOAD];
+    udp_batch_init(&batch, tx, &addr);
+
+    for (long i = 0; i < n_total; i++) {
+        while (i - atomic_load(&n_received) >= WINDOW) {
+            /* Let a partial batch out so the receiver can catch up */
+            udp_batch_flush(&batch);
+            sleep_ms(1);
+        }
+        size_t len = payload_len(i);
+        fill(buf, i, len);
+        udp_batch_send(&batch, buf, len);
+        if (i % 256 == 255) {
+            sleep_ms(UDP_BATCH_MS + 5);
+            udp_batch_tick(&batch);
+        }
+    }
+    udp_batch_flush(&batch);
+    pthread_join(rt, NULL);
+
+    long got = atomic_load(&n_received);
+    printf("%ld datagrams sent, %ld received, %lu syscalls, %ld errors\n",
+           batch.n_datagrams, got, batch.n_syscalls, n_errors);
+    udp_batch_destroy(&batch);
+    close(tx);
+    close(rx);
+
+    if (got != n_total || (long)batch.n_datagrams != n_total || n_errors) {
+        printf("FAIL\n");
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
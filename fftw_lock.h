@@ -27,6 +27,11 @@ static inline void fftw_lock(void) {
     pthread_mutex_lock(&fftw_planner_mutex);
 }
 
+/* 0 if the lock was taken, nonzero if another thread holds it */
+static inline int fftw_trylock(void) {
+    return pthread_mutex_trylock(&fftw_planner_mutex);
+}
+
 static inline void fftw_unlock(void) {
     pthread_mutex_unlock(&fftw_planner_mutex);
 }
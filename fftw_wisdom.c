@@ -0,0 +1,400 @@
+/*
+ * FFTW wisdom: load, save, parallel generation and background upgrade
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * FFTW wisdom: load, save, parallel generation and background upgrade
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "fftw_wisdom.h"
+#include "fftw_lock.h"
+#include "logging.h"
+#include "thread_place.h"
+
+#define FFTW_WISDOM_FILE ".iridium-sniffer-fftw-wisdom"
+#define MAX_JOBS         16
+
+static int wisdom_path(char *path, size_t size) {
+    const char *home = getenv("HOME");
+    if (!home)
+        return -1;
+    snprintf(path, size, "%s/%s", home, FFTW_WISDOM_FILE);
+    return 0;
+}
+
+void fftw_wisdom_load(void) {
+    char path[512];
+    if (wisdom_path(path, sizeof(path)) != 0)
+        return;
+    if (fftwf_import_wisdom_from_filename(path))
+        fprintf(stderr, "FFTW: loaded wisdom from %s\n", path);
+}
+
+static int save_wisdom(void) {
+    char path[512];
+    if (wisdom_path(path, sizeof(path)) != 0)
+        return -1;
+    if (!fftwf_export_wisdom_to_filename(path))
+        return -1;
+    fprintf(stderr, "FFTW: saved wisdom to %s\n", path);
+    return 0;
+}
+
+void fftw_wisdom_save(void) {
+    save_wisdom();
+}
+
+/* ---- Generation ---- */
+
+typedef struct {
+    fftw_wisdom_job_t job;
+    pid_t pid;
+    int fd;             /* read end of the child's pipe, -1 when done */
+    char *buf;          /* wisdom text received so far */
+    size_t len, cap;
+    struct timespec start;
+} child_t;
+
+/* fftwf-wisdom's naming: cof8192 = complex, out of place, forward */
+static void job_name(const fftw_wisdom_job_t *j, char *name, size_t size) {
+    snprintf(name, size, "co%c%d", j->sign == FFTW_FORWARD ? 'f' : 'b',
+             j->size);
+}
+
+/* Child: plan one transform as the pipeline does and write the
+ * resulting wisdom to fd */
+static void plan_child(const fftw_wisdom_job_t *j, int fd) {
+    fftwf_complex *in = fftwf_alloc_complex(j->size);
+    fftwf_complex *out = fftwf_alloc_complex(j->size);
+    fftwf_plan plan = fftwf_plan_dft_1d(j->size, in, out, j->sign,
+                                        FFTW_MEASURE);
+    char *w = plan ? fftwf_export_wisdom_to_string() : NULL;
+    if (!w)
+        _exit(1);
+
+    size_t len = strlen(w);
+    const char *p = w;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            _exit(1);
+        p += n;
+        len -= (size_t)n;
+    }
+    _exit(0);
+}
+
+static int start_child(child_t *c) {
+    int fds[2];
+    if (pipe(fds) != 0)
+        return -1;
+
+    fflush(NULL);
+    c->pid = fork();
+    if (c->pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+    if (c->pid == 0) {
+        close(fds[0]);
+        plan_child(&c->job, fds[1]);
+    }
+
+    /* Closed now, so later children do not inherit this write end and
+     * EOF arrives when this child exits */
+    close(fds[1]);
+    c->fd = fds[0];
+    clock_gettime(CLOCK_MONOTONIC, &c->start);
+    return 0;
+}
+
+/* Read what the child has sent; returns 1 at EOF */
+static int read_child(child_t *c) {
+    if (c->cap - c->len < 4096) {
+        size_t cap = c->cap ? c->cap * 2 : 16384;
+        char *buf = realloc(c->buf, cap);
+        if (!buf)
+            return 1;
+        c->buf = buf;
+        c->cap = cap;
+    }
+    ssize_t n = read(c->fd, c->buf + c->len, c->cap - c->len - 1);
+    if (n < 0 && errno == EINTR)
+        return 0;
+    if (n <= 0)
+        return 1;
+    c->len += (size_t)n;
+    return 0;
+}
+
+/* Reap a child whose pipe hit EOF and merge its wisdom */
+static int finish_child(child_t *c) {
+    int status;
+    close(c->fd);
+    c->fd = -1;
+    while (waitpid(c->pid, &status, 0) < 0 && errno == EINTR)
+        ;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double secs = (now.tv_sec - c->start.tv_sec)
+                + (now.tv_nsec - c->start.tv_nsec) / 1e9;
+
+    char name[32];
+    job_name(&c->job, name, sizeof(name));
+
+    int ok = WIFEXITED(status) && WEXITSTATUS(status) == 0 && c->len > 0;
+    if (ok) {
+        c->buf[c->len] = '\0';
+        ok = fftwf_import_wisdom_from_string(c->buf);
+    }
+    free(c->buf);
+    c->buf = NULL;
+
+    if (!ok) {
+        fprintf(stderr, "FFTW: planning %s failed\n", name);
+        return -1;
+    }
+    fprintf(stderr, "FFTW: planned %s in %.1f s\n", name, secs);
+    return 0;
+}
+
+int fftw_wisdom_generate(const fftw_wisdom_job_t *jobs, int n_jobs) {
+    child_t c[MAX_JOBS];
+    int n = 0;
+
+    for (int i = 0; i < n_jobs; i++) {
+        int dup = 0;
+        for (int k = 0; k < n; k++)
+            if (c[k].job.size == jobs[i].size && c[k].job.sign == jobs[i].sign)
+                dup = 1;
+        if (dup || n == MAX_JOBS)
+            continue;
+        memset(&c[n], 0, sizeof(c[n]));
+        c[n].job = jobs[i];
+        c[n].fd = -1;
+        n++;
+    }
+
+    /* Children start from the existing wisdom, so sizes already in the
+     * file come back at once */
+    fftw_wisdom_load();
+
+    /* One planner per CPU: more would skew each other's measurements */
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int max_running = cpus > 0 ? (int)cpus : 1;
+
+    fprintf(stderr, "FFTW: planning %d transforms, up to %d at a time\n",
+            n, max_running < n ? max_running : n);
+
+    int next = 0, running = 0, failed = 0;
+    while (next < n || running > 0) {
+        while (next < n && running < max_running) {
+            if (start_child(&c[next]) != 0) {
+                char name[32];
+                job_name(&c[next].job, name, sizeof(name));
+                fprintf(stderr, "FFTW: cannot start planner for %s: %s\n",
+                        name, strerror(errno));
+                failed++;
+            } else {
+                running++;
+            }
+            next++;
+        }
+        if (running == 0)
+            break;
+
+        struct pollfd pfd[MAX_JOBS];
+        int map[MAX_JOBS];
+        int np = 0;
+        for (int i = 0; i < next; i++) {
+            if (c[i].fd >= 0) {
+                pfd[np].fd = c[i].fd;
+                pfd[np].events = POLLIN;
+                map[np++] = i;
+            }
+        }
+        if (poll(pfd, np, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        for (int k = 0; k < np; k++) {
+            if (!(pfd[k].revents & (POLLIN | POLLHUP | POLLERR)))
+                continue;
+            child_t *ch = &c[map[k]];
+            if (read_child(ch)) {
+                if (finish_child(ch) != 0)
+                    failed++;
+                running--;
+            }
+        }
+    }
+
+    if (save_wisdom() != 0) {
+        fprintf(stderr, "FFTW: cannot write the wisdom file (is HOME set?)\n");
+        return -1;
+    }
+    return failed ? -1 : 0;
+}
+
+/* ---- Background plan upgrade ---- */
+
+static pthread_mutex_t queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queue_cond = PTHREAD_COND_INITIALIZER;
+static fftw_wisdom_job_t queued[MAX_JOBS];
+static int n_queued = 0;            /* jobs ever queued */
+static int n_measured = 0;          /* jobs taken by the planner thread */
+static int bg_stop = 0;
+static int bg_running = 0;
+static pthread_t bg_thread;
+static atomic_uint generation = 0;
+
+static void queue_job(int n, int sign) {
+    pthread_mutex_lock(&queue_lock);
+    int dup = 0;
+    for (int i = 0; i < n_queued; i++)
+        if (queued[i].size == n && queued[i].sign == sign)
+            dup = 1;
+    if (!dup && n_queued < MAX_JOBS) {
+        queued[n_queued].size = n;
+        queued[n_queued].sign = sign;
+        n_queued++;
+        pthread_cond_signal(&queue_cond);
+    }
+    pthread_mutex_unlock(&queue_lock);
+}
+
+fftwf_plan fftw_wisdom_plan(int n, fftwf_complex *in, fftwf_complex *out,
+                            int sign, int *measured) {
+    fftwf_plan p = fftwf_plan_dft_1d(n, in, out, sign,
+                                     FFTW_MEASURE | FFTW_WISDOM_ONLY);
+    *measured = p != NULL;
+    if (p)
+        return p;
+
+    queue_job(n, sign);
+    return fftwf_plan_dft_1d(n, in, out, sign, FFTW_ESTIMATE);
+}
+
+int fftw_wisdom_upgrade(fftwf_plan *plan, int n, fftwf_complex *in,
+                        fftwf_complex *out, int sign) {
+    if (fftw_trylock() != 0)
+        return -1;
+    /* With wisdom for the problem the planner does not touch the arrays,
+     * so this is safe while they hold live data */
+    fftwf_plan p = fftwf_plan_dft_1d(n, in, out, sign,
+                                     FFTW_MEASURE | FFTW_WISDOM_ONLY);
+    if (p) {
+        fftwf_destroy_plan(*plan);
+        *plan = p;
+    }
+    fftw_unlock();
+    return p != NULL;
+}
+
+unsigned fftw_wisdom_generation(void) {
+    return atomic_load_explicit(&generation, memory_order_acquire);
+}
+
+/* Measure one size on scratch arrays. Holds the planner lock for the
+ * whole measurement: the owners only ever trylock it from here on. */
+static void measure(const fftw_wisdom_job_t *j) {
+    char name[32];
+    job_name(j, name, sizeof(name));
+
+    fftwf_complex *in = fftwf_alloc_complex(j->size);
+    fftwf_complex *out = fftwf_alloc_complex(j->size);
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    fftw_lock();
+    fftwf_plan p = fftwf_plan_dft_1d(j->size, in, out, j->sign,
+                                     FFTW_MEASURE);
+    if (p)
+        fftwf_destroy_plan(p);
+    fftw_unlock();
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    fftwf_free(in);
+    fftwf_free(out);
+
+    if (!p) {
+        log_msg(LOGC_MAIN, LOGL_WARN, "FFTW: measuring %s failed", name);
+        return;
+    }
+    log_msg(LOGC_MAIN, LOGL_INFO, "FFTW: measured %s in %.1f s", name,
+            (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9);
+    atomic_fetch_add_explicit(&generation, 1, memory_order_release);
+}
+
+static void *background_fn(void *arg) {
+    (void)arg;
+
+    pthread_mutex_lock(&queue_lock);
+    for (;;) {
+        while (!bg_stop && n_measured == n_queued)
+            pthread_cond_wait(&queue_cond, &queue_lock);
+        if (bg_stop)
+            break;
+        fftw_wisdom_job_t j = queued[n_measured++];
+        pthread_mutex_unlock(&queue_lock);
+        measure(&j);
+        pthread_mutex_lock(&queue_lock);
+    }
+    pthread_mutex_unlock(&queue_lock);
+    return NULL;
+}
+
+void fftw_wisdom_background_start(void) {
+    pthread_mutex_lock(&queue_lock);
+    int n = n_queued;
+    bg_stop = 0;
+    pthread_mutex_unlock(&queue_lock);
+    if (n > 0)
+        fprintf(stderr, "FFTW: no wisdom for %d transform%s, starting with "
+                "estimated plans and measuring in the background\n",
+                n, n == 1 ? "" : "s");
+
+    int err = pthread_create(&bg_thread, NULL, background_fn, NULL);
+    if (err != 0) {
+        /* The estimated plans keep working; they just stay estimated */
+        fprintf(stderr, "FFTW: cannot start background planner: %s\n",
+                strerror(err));
+        return;
+    }
+#ifdef __linux__
+    pthread_setname_np(bg_thread, "fftw-plan");
+#endif
+    thread_place_apply(bg_thread, ROLE_STATS, "fftw-plan");
+    bg_running = 1;
+}
+
+void fftw_wisdom_background_stop(void) {
+    if (!bg_running)
+        return;
+    pthread_mutex_lock(&queue_lock);
+    bg_stop = 1;
+    pthread_cond_signal(&queue_cond);
+    pthread_mutex_unlock(&queue_lock);
+    pthread_join(bg_thread, NULL);
+    bg_running = 0;
+}
@@ -0,0 +1,80 @@
+/*
+ * FFTW wisdom: load, save, parallel generation and background upgrade
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * FFTW wisdom: load, save, parallel generation and background upgrade
+ *
+ * Wisdom lives in ~/.iridium-sniffer-fftw-wisdom. It is loaded at
+ * startup and saved on shutdown, so FFTW_MEASURE only benchmarks a size
+ * once per host.
+ *
+ * --generate-wisdom plans every FFT size the current configuration uses
+ * ahead of time. Each (size, direction) is planned in its own child
+ * process, up to one per online CPU, since FFTW's planner is not thread
+ * safe and the sniffer serializes it under fftw_lock(). The children
+ * send their wisdom back over a pipe, and the parent merges it into the
+ * file.
+ *
+ * A normal run does not wait for FFTW_MEASURE. Each context plans with
+ * fftw_wisdom_plan(): from wisdom if the file has the size, else with
+ * FFTW_ESTIMATE, queueing the size for a background thread that
+ * measures it. Once a size is measured, the owning thread swaps in a
+ * plan built from the new wisdom with fftw_wisdom_upgrade(), between
+ * two of its own frames. The pipeline is live at once and reaches full
+ * speed as the measurements land.
+ */
+
+#ifndef __FFTW_WISDOM_H__
+#define __FFTW_WISDOM_H__
+
+#include <complex.h>
+#include <fftw3.h>
+
+/* One complex out-of-place 1-D transform, as the pipeline plans it */
+typedef struct {
+    int size;
+    int sign;           /* FFTW_FORWARD or FFTW_BACKWARD */
+} fftw_wisdom_job_t;
+
+/* Import the wisdom file, if there is one */
+void fftw_wisdom_load(void);
+
+/* Export accumulated wisdom to the wisdom file */
+void fftw_wisdom_save(void);
+
+/* Load the wisdom file, plan each job with FFTW_MEASURE in parallel
+ * child processes, merge their wisdom and save it. Duplicate jobs are
+ * planned once. Call before starting any threads. Returns 0 if every
+ * job was planned and the file written. */
+int fftw_wisdom_generate(const fftw_wisdom_job_t *jobs, int n_jobs);
+
+/* ---- Background plan upgrade ---- */
+
+/* Plan an out-of-place 1-D transform without measuring: from wisdom if
+ * there is some for it (*measured = 1), else with FFTW_ESTIMATE, and
+ * the size is queued for the background planner (*measured = 0). The
+ * caller holds fftw_lock(). */
+fftwf_plan fftw_wisdom_plan(int n, fftwf_complex *in, fftwf_complex *out,
+                            int sign, int *measured);
+
+/* Replace an estimated plan with one from wisdom, if the background
+ * planner has measured it. Never blocks: returns -1 if the planner lock
+ * is busy, 0 if there is no wisdom yet, 1 if *plan was replaced. Call
+ * from the thread that executes the plan, between transforms. */
+int fftw_wisdom_upgrade(fftwf_plan *plan, int n, fftwf_complex *in,
+                        fftwf_complex *out, int sign);
+
+/* Bumped each time the background planner adds wisdom; a context only
+ * needs to try fftw_wisdom_upgrade() when this has changed */
+unsigned fftw_wisdom_generation(void);
+
+/* Start measuring queued sizes in the background / stop after the
+ * measurement in progress, if any */
+void fftw_wisdom_background_start(void);
+void fftw_wisdom_background_stop(void);
+
+#endif
@@ -0,0 +1,227 @@
+/*
+ * Compact binary frame format (--output-format=bin)
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Compact binary frame format
+ *
+ * A stream starts with one header followed by length-prefixed records.
+ * All integers and floats are little-endian.
+ *
+ *   Header:  magic "IRBF" | u16 version | u16 info_len | u64 t0_ns
+ *            | char file_info[info_len]
+ *
+ *   Record:  u16 rec_len (total, including itself) | u8 rec_type
+ *            | type-specific body
+ *
+ *   FRAME_BIN_REC_FRAME body:
+ *            u8 direction | u64 timestamp_ns | u64 id | f64 frequency
+ *            | f32 magnitude | f32 noise | f32 level | u8 confidence
+ *            | u8 reserved | u16 payload_symbols | u16 n_bits
+ *            | u8 bits[(n_bits + 7) / 8]   (MSB first)
+ *
+ * Readers skip records with an unknown rec_type using rec_len, so new
+ * record types can be added without bumping the version. The header
+ * carries everything needed to rebuild the exact RAW text line
+ * (see iridium-bin2raw).
+ */
+
+#ifndef __FRAME_BIN_H__
+#define __FRAME_BIN_H__
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <string.h>
+
+#define FRAME_BIN_MAGIC        "IRBF"
+#define FRAME_BIN_VERSION      1
+#define FRAME_BIN_HEADER_LEN   16          /* fixed part, before file_info */
+#define FRAME_BIN_MAX_INFO     0xffff      /* file_info length is a u16 */
+
+#define FRAME_BIN_REC_FRAME    1
+#define FRAME_BIN_FRAME_FIXED  46          /* rec_len without packed bits */
+#define FRAME_BIN_MAX_BITS     4096
+#define FRAME_BIN_MAX_REC      (FRAME_BIN_FRAME_FIXED + FRAME_BIN_MAX_BITS / 8)
+
+/* RAW line prefix, shared by frame_output.c and iridium-bin2raw so the
+ * converted text is byte-identical to what the sniffer prints. Arguments:
+ * file_info, ts_ms, freq_hz, magnitude, noise, id, confidence, level,
+ * payload_symbols. The bits follow as '0'/'1' characters. */
+#define FRAME_RAW_FMT "RAW: %s %012.4f %010d N:%05.2f%+06.2f I:%011" PRIu64 \
+                      " %3d%% %.5f %3d "
+
+/* Decoded frame record */
+typedef struct {
+    uint8_t direction;
+    uint64_t timestamp;
+    uint64_t id;
+    double frequency;
+    float magnitude;
+    float noise;
+    float level;
+    int confidence;
+    int payload_symbols;
+    int n_bits;
+    uint8_t bits[FRAME_BIN_MAX_BITS];   /* one bit per byte, 0 or 1 */
+} frame_bin_rec_t;
+
+/* ---- Little-endian helpers ---- */
+
+static inline void fb_put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void fb_put32(uint8_t *p, uint32_t v)
+{
+    for (int i = 0; i < 4; i++)
+        p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static inline void fb_put64(uint8_t *p, uint64_t v)
+{
+    for (int i = 0; i < 8; i++)
+        p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static inline uint16_t fb_get16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t fb_get32(const uint8_t *p)
+{
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; i--)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+static inline uint64_t fb_get64(const uint8_t *p)
+{
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+static inline void fb_putf32(uint8_t *p, float f)
+{
+    uint32_t v;
+    memcpy(&v, &f, sizeof(v));
+    fb_put32(p, v);
+}
+
+static inline void fb_putf64(uint8_t *p, double d)
+{
+    uint64_t v;
+    memcpy(&v, &d, sizeof(v));
+    fb_put64(p, v);
+}
+
+static inline float fb_getf32(const uint8_t *p)
+{
+    uint32_t v = fb_get32(p);
+    float f;
+    memcpy(&f, &v, sizeof(f));
+    return f;
+}
+
+static inline double fb_getf64(const uint8_t *p)
+{
+    uint64_t v = fb_get64(p);
+    double d;
+    memcpy(&d, &v, sizeof(d));
+    return d;
+}
+
+/* ---- Header ---- */
+
+/* Encode the stream header into out (FRAME_BIN_HEADER_LEN + strlen(info)
+ * bytes, info capped at FRAME_BIN_MAX_INFO). Returns the number of bytes
+ * written. */
+static inline int frame_bin_encode_header(uint8_t *out, uint64_t t0_ns,
+                                          const char *file_info)
+{
+    size_t info_len = strlen(file_info);
+    if (info_len > FRAME_BIN_MAX_INFO) info_len = FRAME_BIN_MAX_INFO;
+    memcpy(out, FRAME_BIN_MAGIC, 4);
+    fb_put16(out + 4, FRAME_BIN_VERSION);
+    fb_put16(out + 6, (uint16_t)info_len);
+    fb_put64(out + 8, t0_ns);
+    memcpy(out + FRAME_BIN_HEADER_LEN, file_info, info_len);
+    return FRAME_BIN_HEADER_LEN + (int)info_len;
+}
+
+/* ---- Frame record ---- */
+
+/* Encode one frame record. bits holds one bit per byte. Returns the record
+ * length, or 0 if n_bits exceeds FRAME_BIN_MAX_BITS. out must hold
+ * FRAME_BIN_MAX_REC bytes. */
+static inline int frame_bin_encode_frame(uint8_t *out, const frame_bin_rec_t *r,
+                                         const uint8_t *bits)
+{
+    if (r->n_bits < 0 || r->n_bits > FRAME_BIN_MAX_BITS)
+        return 0;
+
+    int nbytes = (r->n_bits + 7) / 8;
+    int len = FRAME_BIN_FRAME_FIXED + nbytes;
+
+    fb_put16(out, (uint16_t)len);
+    out[2] = FRAME_BIN_REC_FRAME;
+    out[3] = r->direction;
+    fb_put64(out + 4, r->timestamp);
+    fb_put64(out + 12, r->id);
+    fb_putf64(out + 20, r->frequency);
+    fb_putf32(out + 28, r->magnitude);
+    fb_putf32(out + 32, r->noise);
+    fb_putf32(out + 36, r->level);
+    out[40] = (uint8_t)r->confidence;
+    out[41] = 0;
+    fb_put16(out + 42, (uint16_t)r->payload_symbols);
+    fb_put16(out + 44, (uint16_t)r->n_bits);
+
+    uint8_t *packed = out + FRAME_BIN_FRAME_FIXED;
+    memset(packed, 0, nbytes);
+    for (int i = 0; i < r->n_bits; i++)
+        if (bits[i])
+            packed[i >> 3] |= (uint8_t)(0x80 >> (i & 7));
+
+    return len;
+}
+
+/* Decode a frame record body (rec points at rec_len). Returns 1 on success,
+ * 0 if the record is truncated or malformed. */
+static inline int frame_bin_decode_frame(const uint8_t *rec, int rec_len,
+                                         frame_bin_rec_t *r)
+{
+    if (rec_len < FRAME_BIN_FRAME_FIXED || rec[2] != FRAME_BIN_REC_FRAME)
+        return 0;
+
+    r->direction = rec[3];
+    r->timestamp = fb_get64(rec + 4);
+    r->id = fb_get64(rec + 12);
+    r->frequency = fb_getf64(rec + 20);
+    r->magnitude = fb_getf32(rec + 28);
+    r->noise = fb_getf32(rec + 32);
+    r->level = fb_getf32(rec + 36);
+    r->confidence = rec[40];
+    r->payload_symbols = fb_get16(rec + 42);
+    r->n_bits = fb_get16(rec + 44);
+
+    if (r->n_bits > FRAME_BIN_MAX_BITS ||
+        rec_len < FRAME_BIN_FRAME_FIXED + (r->n_bits + 7) / 8)
+        return 0;
+
+    const uint8_t *packed = rec + FRAME_BIN_FRAME_FIXED;
+    for (int i = 0; i < r->n_bits; i++)
+        r->bits[i] = (packed[i >> 3] >> (7 - (i & 7))) & 1;
+
+    return 1;
+}
+
+#endif
@@ -19,23 +19,31 @@
  *        I:{id:011d} {conf:3d}% {level:.5f} {payload_symbols:3d} {bits...}
  */
 
+#define _GNU_SOURCE
 #include <math.h>
+#include <pthread.h>
 #include <stdarg.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <inttypes.h>
 #include <string.h>
+#include <time.h>
 
 #ifdef HAVE_ZMQ
 #include <zmq.h>
 #endif
 
 #include "frame_output.h"
+#include "frame_bin.h"
 #include "iridium.h"
 
 extern int diagnostic_mode;
 extern int parsed_mode;
 extern int acars_enabled;
+extern int no_raw;
+extern int output_format;
 
 static const char *out_file_info = NULL;
 static uint64_t t0 = 0;
@@ -67,23 +75,243 @@ static void buf_char(int c) {
         line_buf[line_pos++] = (char)c;
 }
 
+/* ---- Buffered stdout writer ---- */
+
+/*
+ * Completed lines are appended to out_buf and written with one fwrite +
+ * fflush per flush instead of per frame. The demod thread appends; the
+ * stats thread (time policy, SIGUSR1) and main (shutdown) flush, so the
+ * buffer is protected by out_lock.
+ */
+
+#define OUT_BUF_SIZE FLUSH_MAX_BYTES
+static char out_buf[OUT_BUF_SIZE];
+static size_t out_len;
+static pthread_mutex_t out_lock = PTHREAD_MUTEX_INITIALIZER;
+static atomic_int out_policy = FLUSH_LINE;   /* read unlocked by tick */
+static size_t out_flush_bytes = FLUSH_DEFAULT_BYTES;
+static unsigned long out_flush_ms = FLUSH_DEFAULT_MS;
+static unsigned long out_last_flush_ms;
+
+static unsigned long out_now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000UL + ts.tv_nsec / 1000000UL;
+}
+
+/* Caller holds out_lock */
+static void out_flush_locked(void)
+{
+    if (out_len > 0) {
+        fwrite(out_buf, 1, out_len, stdout);
+        fflush(stdout);
+        out_len = 0;
+    }
+    out_last_flush_ms = out_now_ms();
+}
+
+static void out_write(const char *data, size_t len)
+{
+    pthread_mutex_lock(&out_lock);
+
+    if (out_len + len > OUT_BUF_SIZE)
+        out_flush_locked();
+
+    memcpy(out_buf + out_len, data, len);
+    out_len += len;
+
+    if (out_policy == FLUSH_LINE ||
+        (out_policy == FLUSH_BYTES && out_len >= out_flush_bytes))
+        out_flush_locked();
+
+    pthread_mutex_unlock(&out_lock);
+}
+
+void frame_output_set_flush(flush_policy_t policy, int param)
+{
+    pthread_mutex_lock(&out_lock);
+    atomic_store(&out_policy, policy);
+    if (policy == FLUSH_BYTES)
+        out_flush_bytes = (param > 0 && param <= FLUSH_MAX_BYTES)
+            ? (size_t)param : FLUSH_DEFAULT_BYTES;
+    else if (policy == FLUSH_TIME)
+        out_flush_ms = param > 0 ? (unsigned long)param : FLUSH_DEFAULT_MS;
+    out_last_flush_ms = out_now_ms();
+    pthread_mutex_unlock(&out_lock);
+}
+
+void frame_output_flush(void)
+{
+    pthread_mutex_lock(&out_lock);
+    out_flush_locked();
+    pthread_mutex_unlock(&out_lock);
+}
+
+void frame_output_tick(void)
+{
+    if (atomic_load_explicit(&out_policy, memory_order_relaxed) != FLUSH_TIME)
+        return;
+
+    pthread_mutex_lock(&out_lock);
+    if (out_now_ms() - out_last_flush_ms >= out_flush_ms)
+        out_flush_locked();
+    pthread_mutex_unlock(&out_lock);
+}
+
 /* ---- ZMQ PUB socket ---- */
 
+/*
+ * Publishing runs on its own thread so subscriber backpressure never
+ * reaches the demod thread. Lines are copied into pooled slots, queued
+ * (bounded, drop-oldest) and handed to ZMQ with zmq_msg_init_data; the
+ * slot returns to the pool from ZMQ's free callback once the message
+ * has been sent or dropped at the socket HWM.
+ */
+
 #ifdef HAVE_ZMQ
+#define ZMQ_SLOT_SIZE   2048        /* longest RAW line is ~1.1 KB */
+#define ZMQ_POOL_SIZE   1024
+#define ZMQ_QUEUE_DEPTH 512
+
+typedef struct zmq_slot {
+    struct zmq_slot *next;          /* pool free list */
+    const char *topic;
+    int len;
+    char data[ZMQ_SLOT_SIZE];
+} zmq_slot_t;
+
 static void *zmq_context = NULL;
 static void *zmq_pub_socket = NULL;
+static int zmq_topics = 0;
+
+static zmq_slot_t *zmq_pool_mem;
+static zmq_slot_t *zmq_pool_free;
+static pthread_mutex_t zmq_pool_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static zmq_slot_t *zmq_queue[ZMQ_QUEUE_DEPTH];
+static int zmq_q_head, zmq_q_count;
+static pthread_mutex_t zmq_q_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t zmq_q_cond = PTHREAD_COND_INITIALIZER;
+static int zmq_q_stop;
+static pthread_t zmq_thread;
+static int zmq_thread_running;
+
+static atomic_ulong zmq_n_sent;
+static atomic_ulong zmq_n_dropped;
+
 #define ZMQ_ACTIVE (zmq_pub_socket != NULL)
+
+static void zmq_slot_release(zmq_slot_t *slot)
+{
+    pthread_mutex_lock(&zmq_pool_lock);
+    slot->next = zmq_pool_free;
+    zmq_pool_free = slot;
+    pthread_mutex_unlock(&zmq_pool_lock);
+}
+
+static zmq_slot_t *zmq_slot_get(void)
+{
+    pthread_mutex_lock(&zmq_pool_lock);
+    zmq_slot_t *slot = zmq_pool_free;
+    if (slot)
+        zmq_pool_free = slot->next;
+    pthread_mutex_unlock(&zmq_pool_lock);
+    return slot;
+}
+
+/* zmq_msg free callback, runs on a ZMQ I/O thread */
+static void zmq_slot_free_cb(void *data, void *hint)
+{
+    (void)data;
+    zmq_slot_release((zmq_slot_t *)hint);
+}
+
+/* Queue one line for publishing (demod thread). Never blocks: when the
+ * queue is full the oldest pending line is dropped. */
+static void zmq_enqueue(const char *line, int len, const char *topic)
+{
+    if (len > ZMQ_SLOT_SIZE) {
+        atomic_fetch_add(&zmq_n_dropped, 1);
+        return;
+    }
+
+    zmq_slot_t *slot = zmq_slot_get();
+    zmq_slot_t *victim = NULL;
+
+    pthread_mutex_lock(&zmq_q_lock);
+    if (!slot || zmq_q_count == ZMQ_QUEUE_DEPTH) {
+        /* Reclaim the oldest queued line */
+        if (zmq_q_count > 0) {
+            victim = zmq_queue[zmq_q_head];
+            zmq_q_head = (zmq_q_head + 1) % ZMQ_QUEUE_DEPTH;
+            zmq_q_count--;
+            atomic_fetch_add(&zmq_n_dropped, 1);
+            if (!slot) {
+                slot = victim;
+                victim = NULL;
+            }
+        }
+    }
+    if (slot) {
+        memcpy(slot->data, line, len);
+        slot->len = len;
+        slot->topic = topic;
+        zmq_queue[(zmq_q_head + zmq_q_count) % ZMQ_QUEUE_DEPTH] = slot;
+        zmq_q_count++;
+        pthread_cond_signal(&zmq_q_cond);
+    } else {
+        /* Every slot is inside ZMQ (HWM backlog): drop the new line */
+        atomic_fetch_add(&zmq_n_dropped, 1);
+    }
+    pthread_mutex_unlock(&zmq_q_lock);
+
+    if (victim)
+        zmq_slot_release(victim);
+}
+
+static void *zmq_publisher_thread(void *arg)
+{
+    (void)arg;
+
+    for (;;) {
+        pthread_mutex_lock(&zmq_q_lock);
+        while (zmq_q_count == 0 && !zmq_q_stop)
+            pthread_cond_wait(&zmq_q_cond, &zmq_q_lock);
+        if (zmq_q_count == 0) {
+            pthread_mutex_unlock(&zmq_q_lock);
+            break;
+        }
+        zmq_slot_t *slot = zmq_queue[zmq_q_head];
+        zmq_q_head = (zmq_q_head + 1) % ZMQ_QUEUE_DEPTH;
+        zmq_q_count--;
+        pthread_mutex_unlock(&zmq_q_lock);
+
+        if (zmq_topics)
+            zmq_send(zmq_pub_socket, slot->topic, strlen(slot->topic),
+                     ZMQ_SNDMORE);
+
+        zmq_msg_t msg;
+        zmq_msg_init_data(&msg, slot->data, slot->len, zmq_slot_free_cb, slot);
+        if (zmq_msg_send(&msg, zmq_pub_socket, 0) < 0) {
+            zmq_msg_close(&msg);    /* runs the free callback */
+            atomic_fetch_add(&zmq_n_dropped, 1);
+        } else {
+            atomic_fetch_add(&zmq_n_sent, 1);
+        }
+    }
+
+    return NULL;
+}
 #else
 #define ZMQ_ACTIVE 0
 #endif
 
-static void buf_flush(int to_stdout) {
+static void buf_flush(int to_stdout, const char *topic) {
     line_buf[line_pos] = '\0';
 
-    if (to_stdout && line_pos > 0) {
-        fwrite(line_buf, 1, line_pos, stdout);
-        fflush(stdout);
-    }
+    if (to_stdout && line_pos > 0)
+        out_write(line_buf, line_pos);
 
 #ifdef HAVE_ZMQ
     if (zmq_pub_socket && line_pos > 0) {
@@ -91,8 +319,10 @@ static void buf_flush(int to_stdout) {
         int len = line_pos;
         if (len > 0 && line_buf[len - 1] == '\n')
             len--;
-        zmq_send(zmq_pub_socket, line_buf, len, 0);
+        zmq_enqueue(line_buf, len, topic);
     }
+#else
+    (void)topic;
 #endif
 }
 
@@ -104,7 +334,7 @@ void frame_output_init(const char *fi)
 }
 
 #ifdef HAVE_ZMQ
-int frame_output_zmq_init(const char *endpoint)
+int frame_output_zmq_init(const char *endpoint, int topics)
 {
     zmq_context = zmq_ctx_new();
     if (!zmq_context)
@@ -125,19 +355,60 @@ int frame_output_zmq_init(const char *endpoint)
         return -1;
     }
 
+    zmq_topics = topics;
+
+    zmq_pool_mem = calloc(ZMQ_POOL_SIZE, sizeof(zmq_slot_t));
+    if (!zmq_pool_mem) {
+        frame_output_zmq_shutdown();
+        return -1;
+    }
+    for (int i = 0; i < ZMQ_POOL_SIZE; i++)
+        zmq_slot_release(&zmq_pool_mem[i]);
+
+    zmq_q_stop = 0;
+    if (pthread_create(&zmq_thread, NULL, zmq_publisher_thread, NULL) != 0) {
+        frame_output_zmq_shutdown();
+        return -1;
+    }
+    zmq_thread_running = 1;
+#ifdef __linux__
+    pthread_setname_np(zmq_thread, "zmq-pub");
+#endif
+
     return 0;
 }
 
 void frame_output_zmq_shutdown(void)
 {
+    /* Drain pending lines, then stop the publisher thread */
+    if (zmq_thread_running) {
+        pthread_mutex_lock(&zmq_q_lock);
+        zmq_q_stop = 1;
+        pthread_cond_signal(&zmq_q_cond);
+        pthread_mutex_unlock(&zmq_q_lock);
+        pthread_join(zmq_thread, NULL);
+        zmq_thread_running = 0;
+    }
+
     if (zmq_pub_socket) {
         zmq_close(zmq_pub_socket);
         zmq_pub_socket = NULL;
     }
+    /* Blocks until ZMQ has released every in-flight message slot */
     if (zmq_context) {
         zmq_ctx_destroy(zmq_context);
         zmq_context = NULL;
     }
+
+    free(zmq_pool_mem);
+    zmq_pool_mem = NULL;
+    zmq_pool_free = NULL;
+}
+
+void frame_output_zmq_stats(unsigned long *sent, unsigned long *dropped)
+{
+    *sent = atomic_load(&zmq_n_sent);
+    *dropped = atomic_load(&zmq_n_dropped);
 }
 #endif
 
@@ -157,9 +428,41 @@ static void ensure_initialized(uint64_t timestamp)
     initialized = 1;
 }
 
+/* Append one binary frame record to the stdout writer. The stream header
+ * goes out ahead of the first record. */
+static void print_bin(const demod_frame_t *frame, int payload_syms)
+{
+    static int header_written = 0;
+    uint8_t rec[FRAME_BIN_MAX_REC];
+
+    if (!header_written) {
+        static uint8_t hdr[FRAME_BIN_HEADER_LEN + FRAME_BIN_MAX_INFO];
+        int n = frame_bin_encode_header(hdr, t0, out_file_info);
+        out_write((const char *)hdr, n);
+        header_written = 1;
+    }
+
+    frame_bin_rec_t r = {
+        .direction = (uint8_t)frame->direction,
+        .timestamp = frame->timestamp,
+        .id = frame->id,
+        .frequency = frame->center_frequency,
+        .magnitude = frame->magnitude,
+        .noise = frame->noise,
+        .level = frame->level,
+        .confidence = frame->confidence,
+        .payload_symbols = payload_syms,
+        .n_bits = frame->n_bits,
+    };
+    int len = frame_bin_encode_frame(rec, &r, frame->bits);
+    if (len > 0)
+        out_write((const char *)rec, len);
+}
+
 void frame_output_print(demod_frame_t *frame)
 {
-    int suppress_stdout = diagnostic_mode || acars_enabled;
+    int suppress_stdout = diagnostic_mode || acars_enabled || no_raw;
+    int bin_stdout = !suppress_stdout && output_format == OUTPUT_FMT_BIN;
 
     /* Skip entirely if nothing would receive the output */
     if (suppress_stdout && !ZMQ_ACTIVE)
@@ -167,20 +470,25 @@ void frame_output_print(demod_frame_t *frame)
 
     ensure_initialized(frame->timestamp);
 
+    /* Payload symbols (after unique word) */
+    int payload_syms = frame->n_payload_symbols;
+    if (payload_syms < 0) payload_syms = 0;
+
+    if (bin_stdout) {
+        print_bin(frame, payload_syms);
+        if (!ZMQ_ACTIVE)
+            return;
+    }
+
     /* Relative timestamp in milliseconds */
     double ts_ms = (double)(frame->timestamp - t0) / 1000000.0;
 
     /* Center frequency rounded to nearest Hz */
     int freq_hz = (int)(frame->center_frequency + 0.5);
 
-    /* Payload symbols (after unique word) */
-    int payload_syms = frame->n_payload_symbols;
-    if (payload_syms < 0) payload_syms = 0;
-
     /* Build line into buffer */
     buf_start();
-    buf_printf("RAW: %s %012.4f %010d N:%05.2f%+06.2f I:%011" PRIu64
-               " %3d%% %.5f %3d ",
+    buf_printf(FRAME_RAW_FMT,
                out_file_info,
                ts_ms,
                freq_hz,
@@ -195,7 +503,8 @@ void frame_output_print(demod_frame_t *frame)
         buf_char('0' + frame->bits[i]);
 
     buf_char('\n');
-    buf_flush(!suppress_stdout);
+    buf_flush(!suppress_stdout && !bin_stdout,
+              frame->direction == DIR_UPLINK ? "RAW.UL" : "RAW.DL");
 }
 
 /* ---- Parsed IDA output (iridium-parser.py compatible) ---- */
@@ -250,7 +559,7 @@ void frame_output_print_ida(const ida_burst_t *burst)
 
     if (bch_len < 20) {
         buf_char('\n');
-        buf_flush(!suppress_stdout);
+        buf_flush(!suppress_stdout, "IDA");
         return;
     }
 
@@ -358,5 +667,5 @@ void frame_output_print_ida(const ida_burst_t *burst)
     }
 
     buf_char('\n');
-    buf_flush(!suppress_stdout);
+    buf_flush(!suppress_stdout, "IDA");
 }
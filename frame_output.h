@@ -20,9 +20,37 @@
  * If NULL, auto-generates from first timestamp. */
 void frame_output_init(const char *file_info);
 
-/* Print one demodulated frame in iridium-toolkit RAW format to stdout. */
+/* Stdout frame format */
+typedef enum {
+    OUTPUT_FMT_RAW = 0,     /* iridium-toolkit RAW text (default) */
+    OUTPUT_FMT_BIN,         /* length-prefixed binary records (frame_bin.h) */
+} output_format_t;
+
+/* Print one demodulated frame to stdout in the selected output format
+ * (RAW text or binary record). ZMQ always receives RAW text. */
 void frame_output_print(demod_frame_t *frame);
 
+/* Stdout flush policy. Lines are collected in a user-space buffer and
+ * written out according to the policy instead of once per frame. */
+typedef enum {
+    FLUSH_LINE = 0,     /* write every line (interactive use) */
+    FLUSH_BYTES,        /* write when param bytes are buffered */
+    FLUSH_TIME,         /* write every param ms (via frame_output_tick) */
+} flush_policy_t;
+
+#define FLUSH_DEFAULT_BYTES 65536
+#define FLUSH_MAX_BYTES     (1 << 20)   /* size of the stdout buffer */
+#define FLUSH_DEFAULT_MS    100
+
+/* Set the stdout flush policy. Call before the first frame is printed. */
+void frame_output_set_flush(flush_policy_t policy, int param);
+
+/* Write out any buffered lines now. Thread-safe. */
+void frame_output_flush(void);
+
+/* Periodic hook (stats thread); flushes when the time policy is due. */
+void frame_output_tick(void);
+
 #include "ida_decode.h"
 
 /* Print one decoded IDA burst in iridium-parser.py parsed format to stdout. */
@@ -30,8 +58,17 @@ void frame_output_print_ida(const ida_burst_t *burst);
 
 /* ZMQ PUB output for multi-consumer iridium-toolkit compatibility */
 #ifdef HAVE_ZMQ
-int frame_output_zmq_init(const char *endpoint);
+/* Bind the PUB socket and start the publisher thread. With topics set,
+ * each line is sent as a two-part message [topic][line] where topic is
+ * "RAW.DL", "RAW.UL" or "IDA", so subscribers can filter server-side. */
+int frame_output_zmq_init(const char *endpoint, int topics);
+
+/* Drain queued lines, stop the publisher thread and close the socket. */
 void frame_output_zmq_shutdown(void);
+
+/* Lines published and lines dropped (queue overflow, pool exhaustion or
+ * send failure) since init. */
+void frame_output_zmq_stats(unsigned long *sent, unsigned long *dropped);
 #endif
 
 #endif
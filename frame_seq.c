@@ -0,0 +1,237 @@
+/*
+ * Output sequencer: restores timestamp order after the task pool
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Output sequencer -- in-flight slot ring with an indexed min-heap of the
+ * open slots, and a fixed timestamp min-heap of finished items, under one
+ * mutex
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include "frame_seq.h"
+
+/* Items handed to the sinks per trip outside the lock */
+#define SEQ_BATCH 64
+
+typedef struct {
+    uint64_t start_ns;
+    unsigned pos;           /* index in open_heap while open */
+    int open;
+} seq_slot_t;
+
+typedef struct {
+    uint64_t ts_ns;
+    output_item_t *item;
+} ready_t;
+
+static pthread_mutex_t seq_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t seq_cond = PTHREAD_COND_INITIALIZER;
+static seq_slot_t slots[FRAME_SEQ_WINDOW];
+static unsigned open_heap[FRAME_SEQ_WINDOW];   /* slot indices by start_ns */
+static unsigned n_open = 0;
+static uint64_t next_seq = 0;       /* next slot to open */
+static uint64_t oldest = 0;         /* oldest slot that may still be open */
+static ready_t ready[FRAME_SEQ_READY_MAX];
+static unsigned n_ready = 0;
+static int emitting = 0;            /* a thread is handing items to the sinks */
+static uint64_t last_emitted = 0;
+static unsigned long n_late = 0;
+static frame_seq_emit_t emit_fn = NULL;
+
+/* ---- Open-slot heap ---- */
+
+static void open_set(unsigned i, unsigned slot)
+{
+    open_heap[i] = slot;
+    slots[slot].pos = i;
+}
+
+static void open_sift_up(unsigned i)
+{
+    unsigned slot = open_heap[i];
+    while (i > 0) {
+        unsigned parent = (i - 1) / 2;
+        if (slots[open_heap[parent]].start_ns <= slots[slot].start_ns)
+            break;
+        open_set(i, open_heap[parent]);
+        i = parent;
+    }
+    open_set(i, slot);
+}
+
+static void open_sift_down(unsigned i)
+{
+    unsigned slot = open_heap[i];
+    for (;;) {
+        unsigned child = 2 * i + 1;
+        if (child >= n_open)
+            break;
+        if (child + 1 < n_open &&
+            slots[open_heap[child + 1]].start_ns <
+            slots[open_heap[child]].start_ns)
+            child++;
+        if (slots[open_heap[child]].start_ns >= slots[slot].start_ns)
+            break;
+        open_set(i, open_heap[child]);
+        i = child;
+    }
+    open_set(i, slot);
+}
+
+static void open_remove(unsigned slot)
+{
+    unsigned i = slots[slot].pos;
+    unsigned moved = open_heap[--n_open];
+    slots[slot].open = 0;
+    if (i == n_open)
+        return;
+    open_set(i, moved);
+    open_sift_down(i);
+    open_sift_up(slots[moved].pos);
+}
+
+/* ---- Ready heap ---- */
+
+static void ready_push(uint64_t ts, output_item_t *item)
+{
+    unsigned i = n_ready++;
+    while (i > 0) {
+        unsigned parent = (i - 1) / 2;
+        if (ready[parent].ts_ns <= ts)
+            break;
+        ready[i] = ready[parent];
+        i = parent;
+    }
+    ready[i] = (ready_t){ ts, item };
+}
+
+static ready_t ready_pop(void)
+{
+    ready_t top = ready[0];
+    ready_t last = ready[--n_ready];
+    unsigned i = 0;
+    for (;;) {
+        unsigned child = 2 * i + 1;
+        if (child >= n_ready)
+            break;
+        if (child + 1 < n_ready && ready[child + 1].ts_ns < ready[child].ts_ns)
+            child++;
+        if (ready[child].ts_ns >= last.ts_ns)
+            break;
+        ready[i] = ready[child];
+        i = child;
+    }
+    if (n_ready > 0)
+        ready[i] = last;
+    return top;
+}
+
+/* ---- Release ---- */
+
+/* Pop up to SEQ_BATCH items that no open burst can precede. A full ready
+ * heap gives up one item regardless, so closing a slot never waits on a
+ * burst still queued. Called with seq_lock held. */
+static unsigned take_batch(output_item_t **batch)
+{
+    uint64_t horizon = n_open > 0 ? slots[open_heap[0]].start_ns
+                                  : UINT64_MAX;
+    unsigned n = 0;
+
+    while (n < SEQ_BATCH && n_ready > 0 &&
+           (ready[0].ts_ns <= horizon || n_ready == FRAME_SEQ_READY_MAX)) {
+        ready_t r = ready_pop();
+        if (r.ts_ns < last_emitted)
+            n_late++;
+        else
+            last_emitted = r.ts_ns;
+        batch[n++] = r.item;
+    }
+    return n;
+}
+
+/* Hand every releasable item to the sinks. Called with seq_lock held,
+ * which is dropped around emit_fn. One thread emits at a time, in the
+ * order take_batch() popped; others leave their items to it, and it
+ * takes another batch before it stops. */
+static void release(void)
+{
+    output_item_t *batch[SEQ_BATCH];
+    unsigned n;
+
+    if (emitting)
+        return;
+    emitting = 1;
+    while ((n = take_batch(batch)) > 0) {
+        pthread_cond_broadcast(&seq_cond);
+        pthread_mutex_unlock(&seq_lock);
+        for (unsigned i = 0; i < n; i++)
+            emit_fn(batch[i]);
+        pthread_mutex_lock(&seq_lock);
+    }
+    emitting = 0;
+    pthread_cond_broadcast(&seq_cond);
+}
+
+/* ---- Public API ---- */
+
+void frame_seq_init(frame_seq_emit_t emit)
+{
+    emit_fn = emit;
+}
+
+int frame_seq_open(uint64_t start_ns, int wait, uint64_t *seq)
+{
+    pthread_mutex_lock(&seq_lock);
+    for (;;) {
+        while (oldest < next_seq && !slots[oldest % FRAME_SEQ_WINDOW].open)
+            oldest++;
+        if (next_seq - oldest < FRAME_SEQ_WINDOW)
+            break;
+        if (!wait) {
+            pthread_mutex_unlock(&seq_lock);
+            return -1;
+        }
+        pthread_cond_wait(&seq_cond, &seq_lock);
+    }
+    unsigned slot = next_seq % FRAME_SEQ_WINDOW;
+    *seq = next_seq++;
+    slots[slot].start_ns = start_ns;
+    slots[slot].open = 1;
+    open_set(n_open, slot);
+    open_sift_up(n_open++);
+    pthread_mutex_unlock(&seq_lock);
+    return 0;
+}
+
+void frame_seq_close(uint64_t seq, output_item_t *item, uint64_t ts_ns)
+{
+    pthread_mutex_lock(&seq_lock);
+    if (item) {
+        /* Full: make room ourselves, or wait for the emitter to. The slot
+         * stays open meanwhile so nothing later overtakes the item. */
+        while (n_ready == FRAME_SEQ_READY_MAX) {
+            if (emitting)
+                pthread_cond_wait(&seq_cond, &seq_lock);
+            else
+                release();
+        }
+        ready_push(ts_ns, item);
+    }
+    open_remove(seq % FRAME_SEQ_WINDOW);
+    release();
+    pthread_mutex_unlock(&seq_lock);
+}
+
+unsigned long frame_seq_late(void)
+{
+    pthread_mutex_lock(&seq_lock);
+    unsigned long n = n_late;
+    pthread_mutex_unlock(&seq_lock);
+    return n;
+}
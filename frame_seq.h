@@ -0,0 +1,55 @@
+/*
+ * Output sequencer: restores timestamp order after the task pool
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Output sequencer: restores timestamp order after the task pool
+ *
+ * Bursts finish on the worker pool in whatever order the workers get to
+ * them. The detector opens a slot with each burst's start time just
+ * before queueing it. The worker closes the slot with the burst's output
+ * item, or with none if it did not decode; a shed burst closes its slot
+ * empty. Closed items wait in a min-heap and are handed to the output
+ * sinks in timestamp order as soon as no open burst started earlier.
+ * The earliest open start is kept in an indexed heap, so closing a slot
+ * costs O(log n) however many bursts are in flight.
+ *
+ * The detector emits a burst when it ends, so a long burst can be queued
+ * after a shorter, later-starting one has already gone out. Such frames
+ * are emitted late rather than held, and counted.
+ */
+
+#ifndef __FRAME_SEQ_H__
+#define __FRAME_SEQ_H__
+
+#include <stdint.h>
+
+#include "output_sink.h"
+
+/* Bursts queued or in flight at once, above burst_queue's capacity */
+#define FRAME_SEQ_WINDOW 4096
+
+/* Finished items held back at once. When full, the earliest goes out
+ * even though an open burst may precede it. */
+#define FRAME_SEQ_READY_MAX FRAME_SEQ_WINDOW
+
+typedef void (*frame_seq_emit_t)(output_item_t *item);
+
+void frame_seq_init(frame_seq_emit_t emit);
+
+/* Register a burst starting at start_ns and store its slot in *seq.
+ * While FRAME_SEQ_WINDOW slots are in use, waits for the oldest to
+ * close, or with wait clear returns -1 at once. Returns 0 on success. */
+int frame_seq_open(uint64_t start_ns, int wait, uint64_t *seq);
+
+/* Finish a slot, with an item to emit (timestamp ts_ns) or NULL. Items
+ * reach emit outside the sequencer lock, one caller at a time. */
+void frame_seq_close(uint64_t seq, output_item_t *item, uint64_t ts_ns);
+
+/* Items emitted after a later timestamp had already gone out */
+unsigned long frame_seq_late(void);
+
+#endif
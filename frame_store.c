@@ -0,0 +1,367 @@
+/*
+ * Indexed on-disk frame store (--store)
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Indexed on-disk frame store -- segment writer
+ *
+ * Frames of the current partition are collected in memory and written
+ * as one columnar segment when a frame from a later partition arrives,
+ * when the segment reaches FS_MAX_ROWS, or at shutdown.
+ */
+
+#include <err.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "frame_store.h"
+
+typedef struct {
+    uint64_t ts;
+    uint64_t id;
+    double freq;
+    float mag, noise, level;
+    uint8_t type, flags, conf;
+    uint16_t syms, nbits;
+    uint32_t bitoff;
+} fs_row_t;
+
+static char *store_dir = NULL;
+static uint64_t seg_ns = 0;
+static char *store_info = NULL;
+static uint64_t store_t0 = 0;
+static int store_ready = 0;
+
+static fs_row_t *rows = NULL;
+static size_t n_rows = 0, rows_cap = 0;
+static uint8_t *payload = NULL;
+static size_t payload_len = 0, payload_cap = 0;
+static uint64_t part_start = 0;
+
+static uint64_t n_frames_written = 0;
+static uint64_t n_segments = 0;
+static uint64_t n_lost = 0;
+
+int frame_store_open(const char *dir, int segment_sec, const char *file_info)
+{
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST)
+        return -1;
+    if (access(dir, W_OK | X_OK) != 0)
+        return -1;
+
+    store_dir = strdup(dir);
+    seg_ns = (uint64_t)(segment_sec > 0 ? segment_sec : FS_DEFAULT_SEGMENT)
+             * 1000000000ULL;
+    if (file_info && file_info[0] != '\0')
+        store_info = strdup(file_info);
+    return 0;
+}
+
+/* ---- Segment writer ---- */
+
+static int cmp_rows(const void *a, const void *b)
+{
+    const fs_row_t *ra = a, *rb = b;
+    if (ra->ts != rb->ts)
+        return ra->ts < rb->ts ? -1 : 1;
+    return ra->id < rb->id ? -1 : (ra->id > rb->id);
+}
+
+static size_t align8(size_t v)
+{
+    return (v + 7) & ~(size_t)7;
+}
+
+/* Write one column from the sorted rows, padded to 8 bytes */
+static int write_column(FILE *f, int col, uint8_t *scratch)
+{
+    int w = fs_col_width[col];
+    for (size_t i = 0; i < n_rows; i++) {
+        const fs_row_t *r = &rows[i];
+        uint8_t *p = scratch + i * w;
+        switch (col) {
+        case FS_COL_TS:     fb_put64(p, r->ts);      break;
+        case FS_COL_FREQ:   fb_putf64(p, r->freq);   break;
+        case FS_COL_TYPE:   p[0] = r->type;          break;
+        case FS_COL_FLAGS:  p[0] = r->flags;         break;
+        case FS_COL_ID:     fb_put64(p, r->id);      break;
+        case FS_COL_MAG:    fb_putf32(p, r->mag);    break;
+        case FS_COL_NOISE:  fb_putf32(p, r->noise);  break;
+        case FS_COL_LEVEL:  fb_putf32(p, r->level);  break;
+        case FS_COL_CONF:   p[0] = r->conf;          break;
+        case FS_COL_SYMS:   fb_put16(p, r->syms);    break;
+        case FS_COL_NBITS:  fb_put16(p, r->nbits);   break;
+        case FS_COL_BITOFF: fb_put32(p, r->bitoff);  break;
+        }
+    }
+    size_t len = n_rows * w;
+    size_t pad = align8(len) - len;
+    memset(scratch + len, 0, pad);
+    return fwrite(scratch, 1, len + pad, f) == len + pad ? 0 : -1;
+}
+
+static void build_index(uint8_t *out, uint8_t *type_mask,
+                        double *fmin, double *fmax)
+{
+    size_t n_blocks = (n_rows + FS_BLOCK_ROWS - 1) / FS_BLOCK_ROWS;
+
+    *type_mask = 0;
+    *fmin = rows[0].freq;
+    *fmax = rows[0].freq;
+
+    for (size_t b = 0; b < n_blocks; b++) {
+        size_t first = b * FS_BLOCK_ROWS;
+        size_t last = first + FS_BLOCK_ROWS;
+        if (last > n_rows)
+            last = n_rows;
+
+        double lo = rows[first].freq, hi = rows[first].freq;
+        uint8_t types = 0, crcs = 0;
+        for (size_t i = first; i < last; i++) {
+            if (rows[i].freq < lo) lo = rows[i].freq;
+            if (rows[i].freq > hi) hi = rows[i].freq;
+            types |= (uint8_t)(1 << rows[i].type);
+            crcs |= (uint8_t)fs_crc_bit(rows[i].flags);
+        }
+
+        uint8_t *e = out + b * FS_INDEX_ENTRY_LEN;
+        memset(e, 0, FS_INDEX_ENTRY_LEN);
+        fb_put64(e, rows[first].ts);
+        fb_put64(e + 8, rows[last - 1].ts);
+        fb_putf64(e + 16, lo);
+        fb_putf64(e + 24, hi);
+        e[32] = types;
+        e[33] = crcs;
+
+        *type_mask |= types;
+        if (lo < *fmin) *fmin = lo;
+        if (hi > *fmax) *fmax = hi;
+    }
+}
+
+/* Link tmp to the partition name without replacing an existing segment
+ * (restarts and early rotation can land in the same partition) */
+static int publish_segment(const char *tmp)
+{
+    char base[64], path[4096];
+    time_t sec = (time_t)(part_start / 1000000000ULL);
+    struct tm tm;
+    gmtime_r(&sec, &tm);
+    strftime(base, sizeof(base), "%Y%m%dT%H%M%SZ", &tm);
+
+    for (int n = 0; n < 1000; n++) {
+        if (n == 0)
+            snprintf(path, sizeof(path), "%s/%s" FS_SUFFIX, store_dir, base);
+        else
+            snprintf(path, sizeof(path), "%s/%s-%d" FS_SUFFIX,
+                     store_dir, base, n);
+        if (link(tmp, path) == 0) {
+            unlink(tmp);
+            return 0;
+        }
+        if (errno != EEXIST)
+            break;
+    }
+    return -1;
+}
+
+static void flush_segment(void)
+{
+    if (n_rows == 0)
+        return;
+
+    qsort(rows, n_rows, sizeof(rows[0]), cmp_rows);
+
+    size_t n_blocks = (n_rows + FS_BLOCK_ROWS - 1) / FS_BLOCK_ROWS;
+    uint8_t *scratch = malloc(align8(n_rows * 8));
+    uint8_t *index = malloc(n_blocks * FS_INDEX_ENTRY_LEN);
+
+    char tmp[4096];
+    snprintf(tmp, sizeof(tmp), "%s/.segment-%d.tmp", store_dir, (int)getpid());
+    FILE *f = (scratch && index) ? fopen(tmp, "wb") : NULL;
+    if (!f) {
+        warn("frame store: cannot write segment in %s", store_dir);
+        goto out;
+    }
+
+    /* Column offsets */
+    const char *info = store_info ? store_info : "";
+    size_t info_len = strlen(info);
+    if (info_len > FRAME_BIN_MAX_INFO)
+        info_len = FRAME_BIN_MAX_INFO;
+    uint64_t off[FS_N_COLS];
+    size_t pos = align8(FS_HEADER_LEN + info_len);
+    for (int c = 0; c < FS_N_COLS; c++) {
+        off[c] = pos;
+        if (c == FS_COL_INDEX)
+            pos += n_blocks * FS_INDEX_ENTRY_LEN;
+        else if (c == FS_COL_PAYLOAD)
+            pos += payload_len;
+        else
+            pos = align8(pos + n_rows * fs_col_width[c]);
+    }
+
+    uint8_t type_mask;
+    double fmin, fmax;
+    build_index(index, &type_mask, &fmin, &fmax);
+
+    uint8_t hdr[FS_HEADER_LEN + 8];
+    memset(hdr, 0, sizeof(hdr));
+    memcpy(hdr, FS_MAGIC, 4);
+    fb_put16(hdr + 4, FS_VERSION);
+    fb_put16(hdr + 6, (uint16_t)info_len);
+    fb_put32(hdr + 8, (uint32_t)n_rows);
+    fb_put32(hdr + 12, (uint32_t)n_blocks);
+    fb_put64(hdr + 16, store_t0);
+    fb_put64(hdr + 24, rows[0].ts);
+    fb_put64(hdr + 32, rows[n_rows - 1].ts);
+    fb_putf64(hdr + 40, fmin);
+    fb_putf64(hdr + 48, fmax);
+    fb_put32(hdr + 56, type_mask);
+    fb_put32(hdr + 60, (uint32_t)payload_len);
+    for (int c = 0; c < FS_N_COLS; c++)
+        fb_put64(hdr + 64 + 8 * c, off[c]);
+
+    size_t hdr_pad = align8(FS_HEADER_LEN + info_len) - (FS_HEADER_LEN + info_len);
+    int ok = fwrite(hdr, 1, FS_HEADER_LEN, f) == FS_HEADER_LEN &&
+             fwrite(info, 1, info_len, f) == info_len &&
+             fwrite(hdr + FS_HEADER_LEN, 1, hdr_pad, f) == hdr_pad;
+
+    for (int c = 0; ok && c < FS_COL_INDEX; c++)
+        ok = write_column(f, c, scratch) == 0;
+    if (ok)
+        ok = fwrite(index, 1, n_blocks * FS_INDEX_ENTRY_LEN, f) ==
+             n_blocks * FS_INDEX_ENTRY_LEN;
+    if (ok)
+        ok = fwrite(payload, 1, payload_len, f) == payload_len;
+
+    if (fclose(f) != 0)
+        ok = 0;
+    if (ok && publish_segment(tmp) == 0) {
+        n_frames_written += n_rows;
+        n_segments++;
+    } else {
+        warn("frame store: failed to write segment (%zu frames lost)", n_rows);
+        unlink(tmp);
+        n_lost += n_rows;
+    }
+
+out:
+    free(scratch);
+    free(index);
+    n_rows = 0;
+    payload_len = 0;
+}
+
+/* ---- Frame intake ---- */
+
+static int grow(void **buf, size_t *cap, size_t need, size_t elem)
+{
+    if (need <= *cap)
+        return 0;
+    size_t n = *cap ? *cap : 4096;
+    while (n < need)
+        n *= 2;
+    void *p = realloc(*buf, n * elem);
+    if (!p)
+        return -1;
+    *buf = p;
+    *cap = n;
+    return 0;
+}
+
+void frame_store_add(const frame_bin_rec_t *r, const uint8_t *bits,
+                     int type, int crc)
+{
+    if (!store_dir || r->n_bits < 0 || r->n_bits > FRAME_BIN_MAX_BITS)
+        return;
+
+    /* Stream t0 and file_info follow the same rule as frame_output.c */
+    if (!store_ready) {
+        store_t0 = (r->timestamp / 1000000000ULL) * 1000000000ULL;
+        if (!store_info) {
+            char auto_info[64];
+            snprintf(auto_info, sizeof(auto_info),
+                     "i-%" PRIu64 "-t1", (uint64_t)(store_t0 / 1000000000ULL));
+            store_info = strdup(auto_info);
+        }
+        store_ready = 1;
+    }
+
+    /* Late frames stay in the current segment; header bounds cover them */
+    uint64_t part = r->timestamp - r->timestamp % seg_ns;
+    if (n_rows > 0 && (part > part_start || n_rows >= FS_MAX_ROWS))
+        flush_segment();
+    if (n_rows == 0)
+        part_start = part;
+
+    size_t nbytes = (r->n_bits + 7) / 8;
+    if (grow((void **)&rows, &rows_cap, n_rows + 1, sizeof(rows[0])) != 0 ||
+        grow((void **)&payload, &payload_cap, payload_len + nbytes, 1) != 0) {
+        n_lost++;
+        return;
+    }
+
+    fs_row_t *row = &rows[n_rows++];
+    row->ts = r->timestamp;
+    row->id = r->id;
+    row->freq = r->frequency;
+    row->mag = r->magnitude;
+    row->noise = r->noise;
+    row->level = r->level;
+    row->type = (uint8_t)type;
+    row->flags = (uint8_t)(r->direction & FS_FLAG_DIR_MASK);
+    if (crc >= 0)
+        row->flags |= FS_FLAG_CRC_KNOWN | (crc ? FS_FLAG_CRC_OK : 0);
+    row->conf = (uint8_t)r->confidence;
+    row->syms = (uint16_t)r->payload_symbols;
+    row->nbits = (uint16_t)r->n_bits;
+    row->bitoff = (uint32_t)payload_len;
+
+    uint8_t *packed = payload + payload_len;
+    memset(packed, 0, nbytes);
+    for (int i = 0; i < r->n_bits; i++)
+        if (bits[i])
+            packed[i >> 3] |= (uint8_t)(0x80 >> (i & 7));
+    payload_len += nbytes;
+}
+
+void frame_store_close(void)
+{
+    if (!store_dir)
+        return;
+
+    flush_segment();
+    if (n_lost)
+        fprintf(stderr, "iridium-sniffer: frame store lost %" PRIu64
+                " frames\n", n_lost);
+
+    free(rows);
+    free(payload);
+    free(store_dir);
+    free(store_info);
+    rows = NULL;
+    payload = NULL;
+    store_dir = NULL;
+    store_info = NULL;
+    n_rows = rows_cap = payload_len = payload_cap = 0;
+}
+
+uint64_t frame_store_frames(void)
+{
+    return n_frames_written;
+}
+
+uint64_t frame_store_segments(void)
+{
+    return n_segments;
+}
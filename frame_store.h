@@ -0,0 +1,122 @@
+/*
+ * Indexed on-disk frame store (--store)
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Indexed on-disk frame store
+ *
+ * Frames are written to time-partitioned segment files, one per
+ * --store-segment seconds (default 60), named after the UTC start of
+ * their partition:
+ *
+ *   DIR/20261017T120000Z.irs
+ *
+ * A segment holds its frames sorted by timestamp, one column per field,
+ * so a query only touches the columns it tests. All integers and floats
+ * are little-endian; each column starts 8-byte aligned.
+ *
+ *   Header:  magic "IRST" | u16 version | u16 info_len | u32 n_rows
+ *            | u32 n_blocks | u64 t0_ns | u64 t_min_ns | u64 t_max_ns
+ *            | f64 freq_min | f64 freq_max | u32 type_mask
+ *            | u32 payload_len | u64 col_off[FS_N_COLS]
+ *            | char file_info[info_len]
+ *
+ *   Columns (n_rows entries each):
+ *            FS_COL_TS      u64 timestamp_ns
+ *            FS_COL_FREQ    f64 frequency (Hz)
+ *            FS_COL_TYPE    u8  frame_class_t
+ *            FS_COL_FLAGS   u8  direction | FS_FLAG_CRC* bits
+ *            FS_COL_ID      u64 frame id
+ *            FS_COL_MAG     f32 magnitude
+ *            FS_COL_NOISE   f32 noise
+ *            FS_COL_LEVEL   f32 level
+ *            FS_COL_CONF    u8  confidence
+ *            FS_COL_SYMS    u16 payload symbols
+ *            FS_COL_NBITS   u16 number of bits
+ *            FS_COL_BITOFF  u32 byte offset of the frame's bits in the
+ *                               payload (MSB first, byte aligned)
+ *
+ *   FS_COL_INDEX: sparse index, one FS_INDEX_ENTRY_LEN entry per block
+ *            of FS_BLOCK_ROWS rows:
+ *            u64 t_first | u64 t_last | f64 freq_min | f64 freq_max
+ *            | u8 type_mask | u8 crc_mask | u16 reserved | u32 reserved
+ *
+ *   FS_COL_PAYLOAD: packed bits of every frame
+ *
+ * t0 and file_info are those of the RAW stream that produced the
+ * frames, so iridium-store-query re-emits byte-identical RAW lines.
+ * Segments are written to a temporary name and linked into place once
+ * complete. The link never replaces a file: if the partition's name is
+ * taken (after a restart or an early rotation), NAME-1, NAME-2, ... is
+ * used instead, and iridium-store-query reads them in that order.
+ */
+
+#ifndef __FRAME_STORE_H__
+#define __FRAME_STORE_H__
+
+#include <stdint.h>
+
+#include "frame_bin.h"
+
+#define FS_MAGIC             "IRST"
+#define FS_VERSION           1
+#define FS_SUFFIX            ".irs"
+#define FS_BLOCK_ROWS        256
+#define FS_INDEX_ENTRY_LEN   40
+#define FS_DEFAULT_SEGMENT   60          /* seconds */
+#define FS_MAX_ROWS          (1 << 20)   /* rotate early past this */
+
+enum {
+    FS_COL_TS, FS_COL_FREQ, FS_COL_TYPE, FS_COL_FLAGS, FS_COL_ID,
+    FS_COL_MAG, FS_COL_NOISE, FS_COL_LEVEL, FS_COL_CONF, FS_COL_SYMS,
+    FS_COL_NBITS, FS_COL_BITOFF, FS_COL_INDEX, FS_COL_PAYLOAD,
+    FS_N_COLS
+};
+
+#define FS_HEADER_LEN        (64 + 8 * FS_N_COLS)
+
+/* FS_COL_FLAGS */
+#define FS_FLAG_DIR_MASK     0x03
+#define FS_FLAG_CRC_KNOWN    0x04        /* IDA frame, CRC checked */
+#define FS_FLAG_CRC_OK       0x08
+
+/* crc_mask bits in the sparse index */
+#define FS_CRC_BAD           0x1
+#define FS_CRC_OK            0x2
+#define FS_CRC_NONE          0x4
+
+static inline int fs_crc_bit(uint8_t flags)
+{
+    if (!(flags & FS_FLAG_CRC_KNOWN))
+        return FS_CRC_NONE;
+    return (flags & FS_FLAG_CRC_OK) ? FS_CRC_OK : FS_CRC_BAD;
+}
+
+/* Column element sizes, indexed by FS_COL_* (0 for the variable ones) */
+static const uint8_t fs_col_width[FS_N_COLS] = {
+    8, 8, 1, 1, 8, 4, 4, 4, 1, 2, 2, 4, 0, 0
+};
+
+/* ---- Writer (frame_store.c) ---- */
+
+/* Create dir if needed and start a store with the given partition length
+ * in seconds. Returns 0 on success, -1 with errno set. */
+int frame_store_open(const char *dir, int segment_sec, const char *file_info);
+
+/* Append one frame (bits one per byte; r->bits is not used). type is a
+ * frame_class_t, crc is -1 if unknown, else 0 (bad) or 1 (ok). Called
+ * from the store sink's worker thread only. */
+void frame_store_add(const frame_bin_rec_t *r, const uint8_t *bits,
+                     int type, int crc);
+
+/* Write the open segment and release everything */
+void frame_store_close(void);
+
+/* Frames and segments written so far */
+uint64_t frame_store_frames(void);
+uint64_t frame_store_segments(void);
+
+#endif
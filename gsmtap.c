@@ -24,6 +24,7 @@
 #include <unistd.h>
 
 #include "gsmtap.h"
+#include "udp_batch.h"
 
 /* Packed GSMTAP header (16 bytes) */
 typedef struct __attribute__((packed)) {
@@ -43,6 +44,7 @@ typedef struct __attribute__((packed)) {
 
 static int gsmtap_fd = -1;
 static struct sockaddr_in gsmtap_addr;
+static udp_batch_t gsmtap_batch;
 
 int gsmtap_init(const char *host, int port)
 {
@@ -55,6 +57,7 @@ int gsmtap_init(const char *host, int port)
     gsmtap_addr.sin_port = htons(port);
     inet_pton(AF_INET, host ? host : GSMTAP_DEFAULT_HOST,
               &gsmtap_addr.sin_addr);
+    udp_batch_init(&gsmtap_batch, gsmtap_fd, &gsmtap_addr);
     return 0;
 }
 
@@ -89,13 +92,19 @@ void gsmtap_send(const uint8_t *data, int len,
 
     memcpy(pkt + 16, data, len);
 
-    sendto(gsmtap_fd, pkt, 16 + len, 0,
-           (struct sockaddr *)&gsmtap_addr, sizeof(gsmtap_addr));
+    udp_batch_send(&gsmtap_batch, pkt, 16 + len);
+}
+
+void gsmtap_tick(void)
+{
+    if (gsmtap_fd >= 0)
+        udp_batch_tick(&gsmtap_batch);
 }
 
 void gsmtap_shutdown(void)
 {
     if (gsmtap_fd >= 0) {
+        udp_batch_destroy(&gsmtap_batch);
         close(gsmtap_fd);
         gsmtap_fd = -1;
     }
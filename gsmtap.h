@@ -37,7 +37,11 @@ void gsmtap_send(const uint8_t *data, int len,
                  double frequency, ir_direction_t direction,
                  int8_t signal_dbm);
 
-/* Close the GSMTAP socket. */
+/* Send queued packets once they are older than the batch deadline.
+ * Called periodically from the stats thread. */
+void gsmtap_tick(void);
+
+/* Flush queued packets and close the GSMTAP socket. */
 void gsmtap_shutdown(void);
 
 #endif
@@ -11,6 +11,8 @@
 #include <libhackrf/hackrf.h>
 
 #include "sdr.h"
+#include "sample_pool.h"
+#include "thread_place.h"
 
 extern double samp_rate;
 extern double center_freq;
@@ -69,8 +71,18 @@ hackrf_device *hackrf_setup(void) {
 }
 
 int hackrf_rx_cb(hackrf_transfer *t) {
+    static int placed = 0;
     unsigned i;
-    sample_buf_t *s = malloc(sizeof(*s) + t->valid_length * 4);
+
+    /* libhackrf owns the transfer thread, so place it from inside */
+    if (!placed) {
+        thread_place_self(ROLE_SDR, "hackrf-rx");
+        placed = 1;
+    }
+
+    sample_buf_t *s = sample_buf_get(t->valid_length, 0);
+    if (s == NULL)
+        return 0;
     s->format = SAMPLE_FMT_INT8;
     s->num = t->valid_length / 2;
     for (i = 0; i < s->num * 2; ++i)
@@ -78,6 +90,6 @@ int hackrf_rx_cb(hackrf_transfer *t) {
     if (running)
         push_samples(s);
     else
-        free(s);
+        sample_buf_release(s);
     return 0;
 }
@@ -7,6 +7,9 @@
 
 #include <libhackrf/hackrf.h>
 
+/* libhackrf's USB transfer size, the largest block hackrf_rx_cb() gets */
+#define HACKRF_TRANSFER_BYTES 262144
+
 void hackrf_list(void);
 hackrf_device *hackrf_setup(void);
 int hackrf_rx_cb(hackrf_transfer *t);
@@ -0,0 +1,252 @@
+/*
+ * Huge-page backed allocations for the large DSP buffers
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Huge-page backed allocations for the large DSP buffers
+ */
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "huge_alloc.h"
+
+#define THP_SIZE        (2UL * 1024 * 1024)
+#define MAX_REPORT      16
+
+typedef enum { BACK_HUGETLB = 0, BACK_THP, BACK_4K, BACK_COUNT } backing_t;
+
+static const char *backing_names[BACK_COUNT] = { "hugetlb", "thp", "4k" };
+
+/* Live allocations, so huge_free() knows how to unmap and the report
+ * knows what was asked for */
+typedef struct huge_block {
+    struct huge_block *next;
+    void *ptr;
+    void *map;              /* mapping to unmap; NULL if from posix_memalign */
+    size_t map_len;
+    size_t bytes;
+    backing_t backing;
+    const char *name;
+} huge_block_t;
+
+static pthread_mutex_t blocks_lock = PTHREAD_MUTEX_INITIALIZER;
+static huge_block_t *blocks = NULL;
+static size_t hugetlb_size = 0;     /* 0 = not read yet, 1 = unavailable */
+
+/* ---- Backends ---- */
+
+/* Default hugetlb page size from /proc/meminfo */
+static size_t read_hugetlb_size(void)
+{
+    FILE *f = fopen("/proc/meminfo", "r");
+    if (!f)
+        return 1;
+    char line[128];
+    unsigned long kb = 0;
+    while (fgets(line, sizeof(line), f))
+        if (sscanf(line, "Hugepagesize: %lu kB", &kb) == 1)
+            break;
+    fclose(f);
+    return kb > 0 ? kb * 1024 : 1;
+}
+
+static void *map_hugetlb(size_t bytes, size_t *map_len)
+{
+#ifdef MAP_HUGETLB
+    if (hugetlb_size == 0)
+        hugetlb_size = read_hugetlb_size();
+    if (hugetlb_size == 1)
+        return NULL;
+
+    /* Fails with ENOMEM unless the admin reserved enough pages */
+    size_t len = (bytes + hugetlb_size - 1) & ~(hugetlb_size - 1);
+    void *p = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (p == MAP_FAILED)
+        return NULL;
+    *map_len = len;
+    return p;
+#else
+    (void)bytes; (void)map_len;
+    return NULL;
+#endif
+}
+
+/* Over-map by one huge page and trim, so the buffer starts on a 2 MiB
+ * boundary and the kernel can back all of it with huge pages */
+static void *map_thp(size_t bytes, size_t *map_len)
+{
+#ifdef MADV_HUGEPAGE
+    size_t len = (bytes + THP_SIZE - 1) & ~(THP_SIZE - 1);
+    uint8_t *raw = mmap(NULL, len + THP_SIZE, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+        return NULL;
+
+    uint8_t *p = (uint8_t *)(((uintptr_t)raw + THP_SIZE - 1)
+                             & ~(uintptr_t)(THP_SIZE - 1));
+    if (p > raw)
+        munmap(raw, (size_t)(p - raw));
+    if (raw + len + THP_SIZE > p + len)
+        munmap(p + len, (size_t)(raw + len + THP_SIZE - (p + len)));
+
+    /* EINVAL when the kernel has no THP support */
+    if (madvise(p, len, MADV_HUGEPAGE) != 0) {
+        munmap(p, len);
+        return NULL;
+    }
+    *map_len = len;
+    return p;
+#else
+    (void)bytes; (void)map_len;
+    return NULL;
+#endif
+}
+
+/* ---- API ---- */
+
+void *huge_alloc(size_t bytes, const char *name)
+{
+    huge_block_t *b = calloc(1, sizeof(*b));
+    if (!b)
+        return NULL;
+    b->bytes = bytes;
+    b->name = name;
+
+    if (bytes >= THP_SIZE) {
+        b->map = map_hugetlb(bytes, &b->map_len);
+        b->backing = BACK_HUGETLB;
+        if (!b->map) {
+            b->map = map_thp(bytes, &b->map_len);
+            b->backing = BACK_THP;
+        }
+        b->ptr = b->map;
+    }
+    if (!b->ptr) {
+        /* Anonymous mappings above are already zero */
+        b->backing = BACK_4K;
+        if (posix_memalign(&b->ptr, 64, bytes > 0 ? bytes : 1) != 0) {
+            free(b);
+            return NULL;
+        }
+        memset(b->ptr, 0, bytes);
+    }
+
+    pthread_mutex_lock(&blocks_lock);
+    b->next = blocks;
+    blocks = b;
+    pthread_mutex_unlock(&blocks_lock);
+    return b->ptr;
+}
+
+void huge_free(void *p)
+{
+    if (!p)
+        return;
+
+    pthread_mutex_lock(&blocks_lock);
+    huge_block_t **pp = &blocks;
+    while (*pp && (*pp)->ptr != p)
+        pp = &(*pp)->next;
+    huge_block_t *b = *pp;
+    if (b)
+        *pp = b->next;
+    pthread_mutex_unlock(&blocks_lock);
+
+    if (!b)
+        return;
+    if (b->map)
+        munmap(b->map, b->map_len);
+    else
+        free(b->ptr);
+    free(b);
+}
+
+/* ---- Report ---- */
+
+/* AnonHugePages for the whole process; THP backing is decided page by
+ * page as the buffers are touched, so this is what madvise() achieved */
+static long thp_backed_kb(void)
+{
+    FILE *f = fopen("/proc/self/smaps_rollup", "r");
+    if (!f)
+        return -1;
+    char line[128];
+    long kb = -1;
+    while (fgets(line, sizeof(line), f))
+        if (sscanf(line, "AnonHugePages: %ld kB", &kb) == 1)
+            break;
+    fclose(f);
+    return kb;
+}
+
+void huge_alloc_report(FILE *out)
+{
+    struct {
+        const char *name;
+        unsigned count[BACK_COUNT];
+        size_t bytes;
+    } groups[MAX_REPORT];
+    int n_groups = 0;
+    int have_thp = 0;
+
+    pthread_mutex_lock(&blocks_lock);
+    for (huge_block_t *b = blocks; b; b = b->next) {
+        int g;
+        for (g = 0; g < n_groups; g++)
+            if (strcmp(groups[g].name, b->name) == 0)
+                break;
+        if (g == n_groups) {
+            if (n_groups == MAX_REPORT)
+                continue;
+            memset(&groups[g], 0, sizeof(groups[g]));
+            groups[g].name = b->name;
+            n_groups++;
+        }
+        groups[g].count[b->backing]++;
+        groups[g].bytes += b->bytes;
+        if (b->backing == BACK_THP)
+            have_thp = 1;
+    }
+    pthread_mutex_unlock(&blocks_lock);
+
+    if (n_groups == 0)
+        return;
+
+    /* Oldest first: the list is kept newest first */
+    fprintf(out, "huge pages:");
+    for (int g = n_groups - 1; g >= 0; g--) {
+        unsigned total = 0;
+        int kinds = 0;
+        for (int k = 0; k < BACK_COUNT; k++) {
+            total += groups[g].count[k];
+            kinds += groups[g].count[k] > 0;
+        }
+        fprintf(out, "%s %s %u x %.1f MiB", g == n_groups - 1 ? "" : " |",
+                groups[g].name, total,
+                groups[g].bytes / (1024.0 * 1024.0) / total);
+        for (int k = 0; k < BACK_COUNT; k++) {
+            if (groups[g].count[k] == 0)
+                continue;
+            if (kinds > 1)
+                fprintf(out, " %s %u", backing_names[k], groups[g].count[k]);
+            else
+                fprintf(out, " %s", backing_names[k]);
+        }
+    }
+    if (have_thp) {
+        long kb = thp_backed_kb();
+        if (kb >= 0)
+            fprintf(out, " | thp backed %.1f MiB", kb / 1024.0);
+    }
+    fprintf(out, "\n");
+}
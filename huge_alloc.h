@@ -0,0 +1,44 @@
+/*
+ * Huge-page backed allocations for the large DSP buffers
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Huge-page backed allocations for the large DSP buffers
+ *
+ * The detector's IQ ring and baseline history and each downmix worker's
+ * work buffers are tens of megabytes that are streamed through on every
+ * burst, which on 4 KiB pages means a TLB miss every few kilobytes.
+ * huge_alloc() backs them with huge pages where the system allows it:
+ *
+ *   hugetlb  MAP_HUGETLB from the reserved pool (vm.nr_hugepages)
+ *   thp      a 2 MiB aligned mapping with MADV_HUGEPAGE, so transparent
+ *            huge pages are used when THP is "always" or "madvise"
+ *   4k       posix_memalign, when neither is available
+ *
+ * Buffers below one huge page always take the last path. Memory comes
+ * back zeroed. Every allocation is recorded under its name, and
+ * huge_alloc_report() prints which buffers got what, including how much
+ * of the THP-advised memory the kernel has actually backed so far.
+ */
+
+#ifndef __HUGE_ALLOC_H__
+#define __HUGE_ALLOC_H__
+
+#include <stddef.h>
+#include <stdio.h>
+
+/* Zeroed, at least 64-byte aligned; NULL on failure. name groups the
+ * allocation in the report and must be a string literal. */
+void *huge_alloc(size_t bytes, const char *name);
+
+/* Free a huge_alloc() buffer; NULL is ignored */
+void huge_free(void *p);
+
+/* One line: count, size and backing per buffer name, and how much
+ * memory transparent huge pages back now */
+void huge_alloc_report(FILE *out);
+
+#endif
@@ -0,0 +1,266 @@
+/*
+ * Streaming JSON writer
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Streaming JSON writer -- escaping and printf-free number formatting
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "json_writer.h"
+
+void jw_init(json_writer_t *jw, char *buf, size_t size)
+{
+    jw->buf = buf;
+    jw->size = size;
+    jw->len = 0;
+    jw->overflow = (size == 0);
+    jw->depth = 0;
+    jw->after_key = 0;
+    jw->has_items = 0;
+    if (size > 0)
+        buf[0] = '\0';
+}
+
+/* ---- Output primitives ---- */
+
+static void jw_put(json_writer_t *jw, const char *s, size_t n)
+{
+    if (jw->overflow)
+        return;
+    if (n > jw->size - 1 - jw->len) {
+        jw->overflow = 1;
+        return;
+    }
+    memcpy(jw->buf + jw->len, s, n);
+    jw->len += n;
+    jw->buf[jw->len] = '\0';
+}
+
+static void jw_putc(json_writer_t *jw, char c)
+{
+    jw_put(jw, &c, 1);
+}
+
+/* Comma handling: called before every value and key */
+static void jw_sep(json_writer_t *jw)
+{
+    if (jw->after_key) {
+        jw->after_key = 0;
+        return;
+    }
+    uint32_t bit = 1u << (jw->depth & 31);
+    if (jw->has_items & bit)
+        jw_putc(jw, ',');
+    jw->has_items |= bit;
+}
+
+/* ---- Structure ---- */
+
+static void jw_open(json_writer_t *jw, char c)
+{
+    jw_sep(jw);
+    jw_putc(jw, c);
+    if (jw->depth < JW_MAX_DEPTH - 1)
+        jw->depth++;
+    else
+        jw->overflow = 1;
+    jw->has_items &= ~(1u << jw->depth);
+}
+
+static void jw_close(json_writer_t *jw, char c)
+{
+    jw_putc(jw, c);
+    if (jw->depth > 0)
+        jw->depth--;
+}
+
+void jw_object_begin(json_writer_t *jw) { jw_open(jw, '{'); }
+void jw_object_end(json_writer_t *jw)   { jw_close(jw, '}'); }
+void jw_array_begin(json_writer_t *jw)  { jw_open(jw, '['); }
+void jw_array_end(json_writer_t *jw)    { jw_close(jw, ']'); }
+
+/* ---- Strings ---- */
+
+static const char hex_digits[] = "0123456789abcdef";
+
+static void jw_escaped(json_writer_t *jw, const char *s, size_t n)
+{
+    jw_putc(jw, '"');
+    size_t run = 0;     /* start of the pending unescaped run */
+    for (size_t i = 0; i < n; i++) {
+        unsigned char c = (unsigned char)s[i];
+        char esc[6];
+        size_t elen = 2;
+
+        if (c == '"' || c == '\\') {
+            esc[1] = (char)c;
+        } else if (c == '\n') {
+            esc[1] = 'n';
+        } else if (c == '\r') {
+            esc[1] = 'r';
+        } else if (c == '\t') {
+            esc[1] = 't';
+        } else if (c < 0x20 || c == 0x7f) {
+            esc[1] = 'u';
+            esc[2] = '0';
+            esc[3] = '0';
+            esc[4] = hex_digits[c >> 4];
+            esc[5] = hex_digits[c & 0xf];
+            elen = 6;
+        } else {
+            continue;
+        }
+        esc[0] = '\\';
+        jw_put(jw, s + run, i - run);
+        jw_put(jw, esc, elen);
+        run = i + 1;
+    }
+    jw_put(jw, s + run, n - run);
+    jw_putc(jw, '"');
+}
+
+void jw_key(json_writer_t *jw, const char *key)
+{
+    jw_sep(jw);
+    jw_escaped(jw, key, strlen(key));
+    jw_putc(jw, ':');
+    jw->after_key = 1;
+}
+
+void jw_string_n(json_writer_t *jw, const char *s, size_t n)
+{
+    jw_sep(jw);
+    jw_escaped(jw, s, n);
+}
+
+void jw_string(json_writer_t *jw, const char *s)
+{
+    jw_string_n(jw, s ? s : "", s ? strlen(s) : 0);
+}
+
+void jw_char(json_writer_t *jw, char c)
+{
+    jw_string_n(jw, &c, c ? 1 : 0);
+}
+
+void jw_hex(json_writer_t *jw, const uint8_t *data, size_t n)
+{
+    jw_sep(jw);
+    jw_putc(jw, '"');
+    for (size_t i = 0; i < n; i++) {
+        char h[2] = { hex_digits[data[i] >> 4], hex_digits[data[i] & 0xf] };
+        jw_put(jw, h, 2);
+    }
+    jw_putc(jw, '"');
+}
+
+/* ---- Numbers ---- */
+
+/* Digits of v, most significant first, at least min_digits long */
+static size_t fmt_u64(char *out, uint64_t v, int min_digits)
+{
+    char tmp[20];
+    int n = 0;
+    do {
+        tmp[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    while (n < min_digits)
+        tmp[n++] = '0';
+    for (int i = 0; i < n; i++)
+        out[i] = tmp[n - 1 - i];
+    return n;
+}
+
+void jw_uint(json_writer_t *jw, uint64_t v)
+{
+    char out[20];
+    jw_sep(jw);
+    jw_put(jw, out, fmt_u64(out, v, 1));
+}
+
+void jw_int(json_writer_t *jw, int64_t v)
+{
+    char out[21];
+    size_t n = 0;
+    uint64_t u = (uint64_t)v;
+    if (v < 0) {
+        out[n++] = '-';
+        u = 0 - u;
+    }
+    n += fmt_u64(out + n, u, 1);
+    jw_sep(jw);
+    jw_put(jw, out, n);
+}
+
+static const double pow10_tab[10] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9
+};
+
+void jw_double(json_writer_t *jw, double v, int decimals)
+{
+    if (!isfinite(v)) {
+        jw_null(jw);
+        return;
+    }
+    if (decimals < 0) decimals = 0;
+    if (decimals > 9) decimals = 9;
+
+    char out[48];
+    size_t n = 0;
+
+    /* Beyond 2^53 / 10^decimals the fixed-point path loses precision, and
+     * near-ties (x.xxx5) need printf's exact decimal rounding to match the
+     * other outputs byte for byte. Both are rare. */
+    double r = fabs(v) * pow10_tab[decimals];
+    double frac = r - floor(r);
+    if (r >= 9.0e15 || fabs(frac - 0.5) < 1e-6) {
+        int len = snprintf(out, sizeof(out), "%.*f", decimals, v);
+        jw_sep(jw);
+        jw_put(jw, out, len > 0 ? (size_t)len : 0);
+        return;
+    }
+
+    uint64_t scale = (uint64_t)pow10_tab[decimals];
+    uint64_t scaled = (uint64_t)llround(r);
+    if (v < 0 && scaled != 0)
+        out[n++] = '-';
+    n += fmt_u64(out + n, scaled / scale, 1);
+    if (decimals > 0) {
+        out[n++] = '.';
+        n += fmt_u64(out + n, scaled % scale, decimals);
+    }
+
+    jw_sep(jw);
+    jw_put(jw, out, n);
+}
+
+/* ---- Literals ---- */
+
+void jw_bool(json_writer_t *jw, int b)
+{
+    jw_sep(jw);
+    if (b)
+        jw_put(jw, "true", 4);
+    else
+        jw_put(jw, "false", 5);
+}
+
+void jw_null(json_writer_t *jw)
+{
+    jw_sep(jw);
+    jw_put(jw, "null", 4);
+}
+
+void jw_raw(json_writer_t *jw, const char *json, size_t n)
+{
+    jw_sep(jw);
+    jw_put(jw, json, n);
+}
@@ -0,0 +1,116 @@
+/*
+ * Streaming JSON writer
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Streaming JSON writer
+ *
+ * Writes JSON into a caller-supplied buffer with no allocation and no
+ * printf. Commas between members and elements are inserted automatically,
+ * strings are escaped (quotes, backslash, control characters), and numbers
+ * are formatted directly: integers exactly, doubles as fixed-point with a
+ * given number of decimals (NaN/Inf become null).
+ *
+ *   char buf[512];
+ *   json_writer_t jw;
+ *   jw_init(&jw, buf, sizeof(buf));
+ *   jw_object_begin(&jw);
+ *   jw_key(&jw, "lat");  jw_double(&jw, 48.1234, 4);
+ *   jw_key(&jw, "tail"); jw_string(&jw, reg);
+ *   jw_object_end(&jw);
+ *   if (jw_ok(&jw)) send(fd, buf, jw_len(&jw), 0);
+ *
+ * If the buffer fills up the writer stops and jw_ok() returns 0; the
+ * buffer always holds a NUL-terminated prefix. The ACARS outputs drop
+ * such a document rather than send the truncated, invalid prefix.
+ */
+
+#ifndef __JSON_WRITER_H__
+#define __JSON_WRITER_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define JW_MAX_DEPTH 32
+
+typedef struct {
+    char *buf;
+    size_t size;
+    size_t len;
+    int overflow;
+    int depth;
+    int after_key;
+    uint32_t has_items;     /* bit per depth: container already has a member */
+} json_writer_t;
+
+void jw_init(json_writer_t *jw, char *buf, size_t size);
+
+/* ---- Structure ---- */
+
+void jw_object_begin(json_writer_t *jw);
+void jw_object_end(json_writer_t *jw);
+void jw_array_begin(json_writer_t *jw);
+void jw_array_end(json_writer_t *jw);
+void jw_key(json_writer_t *jw, const char *key);
+
+/* ---- Values ---- */
+
+void jw_string(json_writer_t *jw, const char *s);   /* NULL writes "" */
+void jw_string_n(json_writer_t *jw, const char *s, size_t n);
+void jw_char(json_writer_t *jw, char c);            /* one-character string */
+void jw_hex(json_writer_t *jw, const uint8_t *data, size_t n);
+void jw_int(json_writer_t *jw, int64_t v);
+void jw_uint(json_writer_t *jw, uint64_t v);
+void jw_double(json_writer_t *jw, double v, int decimals);  /* 0..9 */
+void jw_bool(json_writer_t *jw, int b);
+void jw_null(json_writer_t *jw);
+
+/* Insert pre-formatted JSON as one value (trusted input) */
+void jw_raw(json_writer_t *jw, const char *json, size_t n);
+
+/* ---- Key/value shorthands ---- */
+
+static inline void jw_kv_string(json_writer_t *jw, const char *k, const char *s)
+{
+    jw_key(jw, k);
+    jw_string(jw, s);
+}
+
+static inline void jw_kv_int(json_writer_t *jw, const char *k, int64_t v)
+{
+    jw_key(jw, k);
+    jw_int(jw, v);
+}
+
+static inline void jw_kv_uint(json_writer_t *jw, const char *k, uint64_t v)
+{
+    jw_key(jw, k);
+    jw_uint(jw, v);
+}
+
+static inline void jw_kv_double(json_writer_t *jw, const char *k, double v,
+                                int decimals)
+{
+    jw_key(jw, k);
+    jw_double(jw, v, decimals);
+}
+
+static inline void jw_kv_bool(json_writer_t *jw, const char *k, int b)
+{
+    jw_key(jw, k);
+    jw_bool(jw, b);
+}
+
+/* ---- Result ---- */
+
+static inline size_t jw_len(const json_writer_t *jw) { return jw->len; }
+static inline int jw_ok(const json_writer_t *jw) { return !jw->overflow; }
+static inline size_t jw_avail(const json_writer_t *jw)
+{
+    return jw->size - 1 - jw->len;
+}
+
+#endif
@@ -0,0 +1,378 @@
+/*
+ * Lock-free bounded queues for the pipeline edges
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Lock-free bounded queues for the pipeline edges -- SPSC ring, Vyukov
+ * MPMC ring, spin-then-futex waiting
+ */
+
+#define _GNU_SOURCE
+#include <limits.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "lf_queue.h"
+
+#define LFQ_SPIN   256      /* busy polls before yielding */
+#define LFQ_YIELD  16       /* sched_yield() rounds before sleeping */
+
+static inline void cpu_relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+static unsigned round_pow2(unsigned n)
+{
+    unsigned p = 1;
+    while (p < n)
+        p <<= 1;
+    return p;
+}
+
+/* ---- Waiting ---- */
+
+static void event_init(lfq_event_t *e)
+{
+    atomic_init(&e->word, 0);
+    atomic_init(&e->waiters, 0);
+#ifndef __linux__
+    pthread_mutex_init(&e->lock, NULL);
+    pthread_cond_init(&e->cond, NULL);
+#endif
+}
+
+static void event_destroy(lfq_event_t *e)
+{
+#ifndef __linux__
+    pthread_mutex_destroy(&e->lock);
+    pthread_cond_destroy(&e->cond);
+#else
+    (void)e;
+#endif
+}
+
+/* Called after publishing a change. The fence pairs with the one in
+ * event_wait(): either the waiter sees the change, or we see it waiting. */
+static inline void event_signal(lfq_event_t *e)
+{
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&e->waiters, memory_order_relaxed) == 0)
+        return;
+
+    atomic_fetch_add(&e->word, 1);
+#ifdef __linux__
+    syscall(SYS_futex, &e->word, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+#else
+    pthread_mutex_lock(&e->lock);
+    pthread_cond_broadcast(&e->cond);
+    pthread_mutex_unlock(&e->lock);
+#endif
+}
+
+/* Wait until ready(q) is true: spin, yield, then sleep */
+static void event_wait(lfq_event_t *e, int (*ready)(void *), void *q)
+{
+    for (int i = 0; i < LFQ_SPIN; i++) {
+        if (ready(q))
+            return;
+        cpu_relax();
+    }
+    for (int i = 0; i < LFQ_YIELD; i++) {
+        if (ready(q))
+            return;
+        sched_yield();
+    }
+
+    while (!ready(q)) {
+        atomic_fetch_add(&e->waiters, 1);
+        atomic_thread_fence(memory_order_seq_cst);
+        unsigned v = atomic_load(&e->word);
+        if (!ready(q)) {
+#ifdef __linux__
+            syscall(SYS_futex, &e->word, FUTEX_WAIT_PRIVATE, v, NULL, NULL, 0);
+#else
+            pthread_mutex_lock(&e->lock);
+            if (atomic_load(&e->word) == v)
+                pthread_cond_wait(&e->cond, &e->lock);
+            pthread_mutex_unlock(&e->lock);
+#endif
+        }
+        atomic_fetch_sub(&e->waiters, 1);
+    }
+}
+
+/* ---- SPSC ---- */
+
+int spsc_queue_init(spsc_queue_t *q, unsigned capacity)
+{
+    unsigned cap = round_pow2(capacity ? capacity : 1);
+    q->slots = calloc(cap, sizeof(void *));
+    if (!q->slots)
+        return -1;
+    q->mask = cap - 1;
+    atomic_init(&q->closed, 0);
+    atomic_init(&q->head, 0);
+    atomic_init(&q->tail, 0);
+    q->tail_cache = 0;
+    q->head_cache = 0;
+    event_init(&q->not_empty);
+    event_init(&q->not_full);
+    return 0;
+}
+
+void spsc_queue_destroy(spsc_queue_t *q)
+{
+    free(q->slots);
+    q->slots = NULL;
+    event_destroy(&q->not_empty);
+    event_destroy(&q->not_full);
+}
+
+int spsc_queue_add(spsc_queue_t *q, void *item)
+{
+    if (atomic_load_explicit(&q->closed, memory_order_relaxed))
+        return LFQ_CLOSED;
+
+    unsigned head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    if (head - q->tail_cache > q->mask) {
+        q->tail_cache = atomic_load_explicit(&q->tail, memory_order_acquire);
+        if (head - q->tail_cache > q->mask)
+            return LFQ_FULL;
+    }
+
+    q->slots[head & q->mask] = item;
+    atomic_store_explicit(&q->head, head + 1, memory_order_release);
+    event_signal(&q->not_empty);
+    return 0;
+}
+
+static int spsc_can_put(void *arg)
+{
+    spsc_queue_t *q = arg;
+    unsigned head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+    return head - tail <= q->mask ||
+           atomic_load_explicit(&q->closed, memory_order_relaxed);
+}
+
+int spsc_queue_put(spsc_queue_t *q, void *item)
+{
+    for (;;) {
+        int ret = spsc_queue_add(q, item);
+        if (ret != LFQ_FULL)
+            return ret;
+        event_wait(&q->not_full, spsc_can_put, q);
+    }
+}
+
+int spsc_queue_poll(spsc_queue_t *q, void *item)
+{
+    unsigned tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    if (tail == q->head_cache) {
+        /* Read closed first: items pushed before close() are then visible */
+        int closed = atomic_load(&q->closed);
+        q->head_cache = atomic_load_explicit(&q->head, memory_order_acquire);
+        if (tail == q->head_cache)
+            return closed ? LFQ_CLOSED : LFQ_EMPTY;
+    }
+
+    *(void **)item = q->slots[tail & q->mask];
+    atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+    event_signal(&q->not_full);
+    return 0;
+}
+
+static int spsc_can_take(void *arg)
+{
+    spsc_queue_t *q = arg;
+    unsigned tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    return tail != atomic_load_explicit(&q->head, memory_order_acquire) ||
+           atomic_load_explicit(&q->closed, memory_order_relaxed);
+}
+
+int spsc_queue_take(spsc_queue_t *q, void *item)
+{
+    for (;;) {
+        int ret = spsc_queue_poll(q, item);
+        if (ret != LFQ_EMPTY)
+            return ret;
+        event_wait(&q->not_empty, spsc_can_take, q);
+    }
+}
+
+void spsc_queue_close(spsc_queue_t *q)
+{
+    atomic_store(&q->closed, 1);
+    event_signal(&q->not_empty);
+    event_signal(&q->not_full);
+}
+
+unsigned spsc_queue_size(spsc_queue_t *q)
+{
+    unsigned tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    return head - tail;
+}
+
+/* ---- MPMC (Vyukov) ---- */
+
+int mpmc_queue_init(mpmc_queue_t *q, unsigned capacity)
+{
+    /* At least two cells, or a full cell and an empty one share a seq */
+    unsigned cap = round_pow2(capacity < 2 ? 2 : capacity);
+    q->cells = malloc(cap * sizeof(mpmc_cell_t));
+    if (!q->cells)
+        return -1;
+    for (unsigned i = 0; i < cap; i++) {
+        atomic_init(&q->cells[i].seq, i);
+        q->cells[i].data = NULL;
+    }
+    q->mask = cap - 1;
+    atomic_init(&q->closed, 0);
+    atomic_init(&q->enqueue_pos, 0);
+    atomic_init(&q->dequeue_pos, 0);
+    event_init(&q->not_empty);
+    event_init(&q->not_full);
+    return 0;
+}
+
+void mpmc_queue_destroy(mpmc_queue_t *q)
+{
+    free(q->cells);
+    q->cells = NULL;
+    event_destroy(&q->not_empty);
+    event_destroy(&q->not_full);
+}
+
+int mpmc_queue_add(mpmc_queue_t *q, void *item)
+{
+    if (atomic_load_explicit(&q->closed, memory_order_relaxed))
+        return LFQ_CLOSED;
+
+    size_t pos = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+    mpmc_cell_t *cell;
+    for (;;) {
+        cell = &q->cells[pos & q->mask];
+        size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+        if (dif == 0) {
+            if (atomic_compare_exchange_weak_explicit(&q->enqueue_pos, &pos,
+                                                      pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed))
+                break;
+        } else if (dif < 0) {
+            return LFQ_FULL;
+        } else {
+            pos = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+        }
+    }
+
+    cell->data = item;
+    atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+    event_signal(&q->not_empty);
+    return 0;
+}
+
+static int mpmc_can_put(void *arg)
+{
+    mpmc_queue_t *q = arg;
+    size_t pos = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+    size_t seq = atomic_load_explicit(&q->cells[pos & q->mask].seq,
+                                      memory_order_acquire);
+    return (intptr_t)seq - (intptr_t)pos >= 0 ||
+           atomic_load_explicit(&q->closed, memory_order_relaxed);
+}
+
+int mpmc_queue_put(mpmc_queue_t *q, void *item)
+{
+    for (;;) {
+        int ret = mpmc_queue_add(q, item);
+        if (ret != LFQ_FULL)
+            return ret;
+        event_wait(&q->not_full, mpmc_can_put, q);
+    }
+}
+
+int mpmc_queue_poll(mpmc_queue_t *q, void *item)
+{
+    size_t pos = atomic_load_explicit(&q->dequeue_pos, memory_order_relaxed);
+    mpmc_cell_t *cell;
+    for (;;) {
+        cell = &q->cells[pos & q->mask];
+        size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (dif == 0) {
+            if (atomic_compare_exchange_weak_explicit(&q->dequeue_pos, &pos,
+                                                      pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed))
+                break;
+        } else if (dif < 0) {
+            /* Empty. If closed, look once more: an item added before
+             * close() is visible now. */
+            if (!atomic_load(&q->closed))
+                return LFQ_EMPTY;
+            seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+            if ((intptr_t)seq - (intptr_t)(pos + 1) < 0)
+                return LFQ_CLOSED;
+            pos = atomic_load_explicit(&q->dequeue_pos, memory_order_relaxed);
+        } else {
+            pos = atomic_load_explicit(&q->dequeue_pos, memory_order_relaxed);
+        }
+    }
+
+    *(void **)item = cell->data;
+    atomic_store_explicit(&cell->seq, pos + q->mask + 1, memory_order_release);
+    event_signal(&q->not_full);
+    return 0;
+}
+
+static int mpmc_can_take(void *arg)
+{
+    mpmc_queue_t *q = arg;
+    size_t pos = atomic_load_explicit(&q->dequeue_pos, memory_order_relaxed);
+    size_t seq = atomic_load_explicit(&q->cells[pos & q->mask].seq,
+                                      memory_order_acquire);
+    return (intptr_t)seq - (intptr_t)(pos + 1) >= 0 ||
+           atomic_load_explicit(&q->closed, memory_order_relaxed);
+}
+
+int mpmc_queue_take(mpmc_queue_t *q, void *item)
+{
+    for (;;) {
+        int ret = mpmc_queue_poll(q, item);
+        if (ret != LFQ_EMPTY)
+            return ret;
+        event_wait(&q->not_empty, mpmc_can_take, q);
+    }
+}
+
+void mpmc_queue_close(mpmc_queue_t *q)
+{
+    atomic_store(&q->closed, 1);
+    event_signal(&q->not_empty);
+    event_signal(&q->not_full);
+}
+
+unsigned mpmc_queue_size(mpmc_queue_t *q)
+{
+    size_t deq = atomic_load_explicit(&q->dequeue_pos, memory_order_relaxed);
+    size_t enq = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+    return enq > deq ? (unsigned)(enq - deq) : 0;
+}
@@ -0,0 +1,118 @@
+/*
+ * Lock-free bounded queues for the pipeline edges
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Lock-free bounded queues for the pipeline edges
+ *
+ * Two fixed-capacity rings of pointers replace Blocking_Queue between
+ * the pipeline stages:
+ *
+ *   spsc_queue_t  one producer, one consumer (SDR/file -> detector).
+ *                 Head and tail each have one writer; each side caches
+ *                 the other's index and only re-reads it when the ring
+ *                 looks full or empty.
+ *   mpmc_queue_t  any number of producers and consumers (the sample
+ *                 buffer free list). Vyukov's bounded queue: one
+ *                 CAS per operation on a per-cell sequence number.
+ *
+ * Neither takes a lock on the fast path. A blocking call that finds the
+ * ring empty (or full) spins briefly, then yields, then sleeps on a
+ * futex (a mutex and condvar off Linux); the other side only makes the
+ * wake-up syscall when someone is actually asleep.
+ *
+ * Closing a queue wakes everyone. Producers get LFQ_CLOSED; consumers
+ * keep taking queued items and get LFQ_CLOSED once the ring is empty, so
+ * close-then-join drains a stage without a separate wait loop.
+ */
+
+#ifndef __LF_QUEUE_H__
+#define __LF_QUEUE_H__
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+
+#define LFQ_FULL    2
+#define LFQ_EMPTY   3
+#define LFQ_CLOSED  4
+
+#define LFQ_CACHELINE 64
+
+/* Sleep/wake point for one side of a queue */
+typedef struct {
+    atomic_uint word;
+    atomic_int waiters;
+#ifndef __linux__
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+#endif
+} lfq_event_t;
+
+/* ---- Single producer, single consumer ---- */
+
+typedef struct {
+    void **slots;
+    unsigned mask;
+    atomic_int closed;
+    lfq_event_t not_empty;
+    lfq_event_t not_full;
+
+    /* Producer side */
+    atomic_uint head __attribute__((aligned(LFQ_CACHELINE)));
+    unsigned tail_cache;
+
+    /* Consumer side */
+    atomic_uint tail __attribute__((aligned(LFQ_CACHELINE)));
+    unsigned head_cache;
+} spsc_queue_t;
+
+/* Capacity is rounded up to a power of two. Returns 0 or -1. */
+int spsc_queue_init(spsc_queue_t *q, unsigned capacity);
+void spsc_queue_destroy(spsc_queue_t *q);
+
+/* Non-blocking: 0, LFQ_FULL or LFQ_CLOSED */
+int spsc_queue_add(spsc_queue_t *q, void *item);
+/* Blocks while full: 0 or LFQ_CLOSED */
+int spsc_queue_put(spsc_queue_t *q, void *item);
+/* Non-blocking: 0, LFQ_EMPTY or LFQ_CLOSED (closed and empty) */
+int spsc_queue_poll(spsc_queue_t *q, void *item);
+/* Blocks while empty: 0 or LFQ_CLOSED (closed and empty) */
+int spsc_queue_take(spsc_queue_t *q, void *item);
+
+void spsc_queue_close(spsc_queue_t *q);
+unsigned spsc_queue_size(spsc_queue_t *q);
+
+/* ---- Multi producer, multi consumer ---- */
+
+typedef struct {
+    atomic_size_t seq;
+    void *data;
+} mpmc_cell_t;
+
+typedef struct {
+    mpmc_cell_t *cells;
+    size_t mask;
+    atomic_int closed;
+    lfq_event_t not_empty;
+    lfq_event_t not_full;
+
+    atomic_size_t enqueue_pos __attribute__((aligned(LFQ_CACHELINE)));
+    atomic_size_t dequeue_pos __attribute__((aligned(LFQ_CACHELINE)));
+} mpmc_queue_t;
+
+int mpmc_queue_init(mpmc_queue_t *q, unsigned capacity);
+void mpmc_queue_destroy(mpmc_queue_t *q);
+
+int mpmc_queue_add(mpmc_queue_t *q, void *item);
+int mpmc_queue_put(mpmc_queue_t *q, void *item);
+int mpmc_queue_poll(mpmc_queue_t *q, void *item);
+int mpmc_queue_take(mpmc_queue_t *q, void *item);
+
+void mpmc_queue_close(mpmc_queue_t *q);
+unsigned mpmc_queue_size(mpmc_queue_t *q);
+
+#endif
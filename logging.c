@@ -0,0 +1,407 @@
+/*
+ * Asynchronous rate-limited diagnostic logging
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Asynchronous rate-limited diagnostic logging -- per-thread SPSC rings
+ * drained by one logger thread
+ */
+
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "logging.h"
+
+#define LOG_MAX_RINGS   32
+#define LOG_RING_SLOTS  256             /* power of two */
+#define LOG_POLL_US     10000
+#define LOG_REPORT_NS   1000000000ULL
+
+static const char *cat_names[LOGC_COUNT] = {
+    "main", "sdr", "detect", "downmix", "demod", "doppler", "acars",
+};
+
+static const char *level_names[] = { "error", "warn", "info", "debug" };
+
+atomic_int log_levels[LOGC_COUNT] = {
+    [0 ... LOGC_COUNT - 1] = LOG_DEFAULT_LEVEL
+};
+static unsigned levels_set = 0;         /* categories given with --log */
+
+/* ---- Rate limiting ---- */
+
+/* Token bucket per category, kept as a theoretical arrival time (GCRA):
+ * each message moves it one interval later, and a message that would
+ * put it more than one second ahead of now is over the limit. One CAS
+ * per message, no lock. */
+static uint64_t interval_ns = 1000000000ULL / LOG_DEFAULT_RATE;
+static atomic_uint_fast64_t tat[LOGC_COUNT];
+static atomic_uint_fast64_t suppressed[LOGC_COUNT];
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int rate_allow(log_cat_t cat)
+{
+    if (interval_ns == 0)
+        return 1;
+
+    uint64_t now = now_ns();
+    uint_fast64_t t = atomic_load_explicit(&tat[cat], memory_order_relaxed);
+    for (;;) {
+        uint64_t base = t > now ? t : now;
+        if (base + interval_ns - now > 1000000000ULL)
+            return 0;
+        if (atomic_compare_exchange_weak_explicit(&tat[cat], &t,
+                                                  base + interval_ns,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed))
+            return 1;
+    }
+}
+
+void log_set_rate(int per_sec)
+{
+    interval_ns = per_sec > 0 ? 1000000000ULL / (uint64_t)per_sec : 0;
+}
+
+/* ---- Rings ---- */
+
+typedef struct {
+    uint16_t len;
+    char text[LOG_MSG_MAX];
+} log_rec_t;
+
+typedef struct {
+    atomic_int claimed;
+    atomic_int orphan;                  /* owner exited, recycle when empty */
+    log_rec_t *slots;
+    /* head is written by the owning thread, tail by the logger */
+    atomic_uint head __attribute__((aligned(64)));
+    atomic_uint tail __attribute__((aligned(64)));
+} log_ring_t;
+
+static log_ring_t rings[LOG_MAX_RINGS];
+static __thread log_ring_t *my_ring = NULL;
+static pthread_key_t ring_key;
+
+static atomic_int running = 0;
+static atomic_int writers = 0;          /* log_write() calls in progress */
+static pthread_t logger;
+
+static void ring_release(void *arg)
+{
+    log_ring_t *r = arg;
+    atomic_store_explicit(&r->orphan, 1, memory_order_release);
+}
+
+static log_ring_t *ring_claim(void)
+{
+    for (int i = 0; i < LOG_MAX_RINGS; i++) {
+        log_ring_t *r = &rings[i];
+        int expect = 0;
+        if (!atomic_compare_exchange_strong(&r->claimed, &expect, 1))
+            continue;
+        if (!r->slots) {
+            r->slots = malloc(LOG_RING_SLOTS * sizeof(log_rec_t));
+            if (!r->slots) {
+                atomic_store(&r->claimed, 0);
+                return NULL;
+            }
+        }
+        pthread_setspecific(ring_key, r);
+        my_ring = r;
+        return r;
+    }
+    return NULL;
+}
+
+/* ---- Producers ---- */
+
+static void write_sync(const char *fmt, va_list ap)
+{
+    char text[LOG_MSG_MAX];
+    int n = vsnprintf(text, sizeof(text), fmt, ap);
+    if (n < 0)
+        return;
+    if (n >= (int)sizeof(text))
+        n = sizeof(text) - 1;
+    while (n > 0 && text[n - 1] == '\n')
+        n--;
+    flockfile(stderr);
+    fwrite(text, 1, n, stderr);
+    fputc('\n', stderr);
+    funlockfile(stderr);
+}
+
+static void write_ring(log_ring_t *r, log_cat_t cat, const char *fmt,
+                       va_list ap)
+{
+    unsigned head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    if (head - tail >= LOG_RING_SLOTS) {
+        atomic_fetch_add_explicit(&suppressed[cat], 1, memory_order_relaxed);
+        return;
+    }
+
+    log_rec_t *rec = &r->slots[head & (LOG_RING_SLOTS - 1)];
+    int n = vsnprintf(rec->text, sizeof(rec->text), fmt, ap);
+    if (n < 0)
+        return;
+    if (n >= (int)sizeof(rec->text))
+        n = sizeof(rec->text) - 1;
+    while (n > 0 && rec->text[n - 1] == '\n')
+        n--;
+    rec->len = (uint16_t)n;
+
+    atomic_store_explicit(&r->head, head + 1, memory_order_release);
+}
+
+void log_write(log_cat_t cat, const char *fmt, ...)
+{
+    va_list ap;
+
+    if (!rate_allow(cat)) {
+        atomic_fetch_add_explicit(&suppressed[cat], 1, memory_order_relaxed);
+        return;
+    }
+
+    /* Announce ourselves before checking running, so log_stop() either
+     * sees us and waits, or we see it stopped and write directly */
+    atomic_fetch_add(&writers, 1);
+    log_ring_t *r = NULL;
+    if (atomic_load(&running))
+        r = my_ring ? my_ring : ring_claim();
+
+    va_start(ap, fmt);
+    if (r)
+        write_ring(r, cat, fmt, ap);
+    else
+        write_sync(fmt, ap);
+    va_end(ap);
+    atomic_fetch_sub_explicit(&writers, 1, memory_order_release);
+}
+
+/* ---- Logger thread ---- */
+
+static char out_buf[16384];
+static size_t out_len = 0;
+
+static void out_flush(void)
+{
+    if (out_len > 0) {
+        fwrite(out_buf, 1, out_len, stderr);
+        out_len = 0;
+    }
+}
+
+static int drain(void)
+{
+    int total = 0;
+
+    for (int i = 0; i < LOG_MAX_RINGS; i++) {
+        log_ring_t *r = &rings[i];
+        if (!atomic_load_explicit(&r->claimed, memory_order_acquire))
+            continue;
+
+        /* Read orphan first: once it is set the owner is gone, so a ring
+         * still empty afterwards stays empty */
+        int orphan = atomic_load_explicit(&r->orphan, memory_order_acquire);
+        unsigned tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+        unsigned head = atomic_load_explicit(&r->head, memory_order_acquire);
+
+        for (; tail != head; tail++) {
+            log_rec_t *rec = &r->slots[tail & (LOG_RING_SLOTS - 1)];
+            if (out_len + rec->len + 1 > sizeof(out_buf))
+                out_flush();
+            memcpy(out_buf + out_len, rec->text, rec->len);
+            out_len += rec->len;
+            out_buf[out_len++] = '\n';
+            total++;
+        }
+        atomic_store_explicit(&r->tail, tail, memory_order_release);
+
+        if (orphan) {
+            atomic_store(&r->orphan, 0);
+            atomic_store_explicit(&r->claimed, 0, memory_order_release);
+        }
+    }
+
+    out_flush();
+    return total;
+}
+
+static void report_suppressed(void)
+{
+    for (int c = 0; c < LOGC_COUNT; c++) {
+        uint64_t n = atomic_exchange_explicit(&suppressed[c], 0,
+                                              memory_order_relaxed);
+        if (n > 0)
+            fprintf(stderr, "log: %s: %llu messages suppressed\n",
+                    cat_names[c], (unsigned long long)n);
+    }
+}
+
+static void *logger_thread(void *arg)
+{
+    (void)arg;
+#ifdef __linux__
+    pthread_setname_np(pthread_self(), "logger");
+#endif
+
+    uint64_t last_report = now_ns();
+    while (atomic_load_explicit(&running, memory_order_acquire)) {
+        int n = drain();
+        uint64_t now = now_ns();
+        if (now - last_report >= LOG_REPORT_NS) {
+            report_suppressed();
+            last_report = now;
+        }
+        if (n == 0)
+            usleep(LOG_POLL_US);
+    }
+
+    /* log_stop() drains the rest once every writer is done */
+    return NULL;
+}
+
+/* ---- Configuration ---- */
+
+static int parse_level(const char *s, size_t len)
+{
+    if (len == 3 && strncasecmp(s, "off", 3) == 0)
+        return -1;
+    for (int l = 0; l <= LOGL_DEBUG; l++) {
+        if (strlen(level_names[l]) == len &&
+            strncasecmp(s, level_names[l], len) == 0)
+            return l;
+    }
+    return -2;
+}
+
+int log_parse_levels(const char *spec)
+{
+    const char *p = spec;
+
+    while (*p) {
+        const char *end = strchr(p, ',');
+        size_t len = end ? (size_t)(end - p) : strlen(p);
+        const char *eq = memchr(p, '=', len);
+        if (!eq)
+            return -1;
+
+        size_t name_len = eq - p;
+        int level = parse_level(eq + 1, len - name_len - 1);
+        if (level < -1)
+            return -1;
+
+        int found = 0;
+        for (int c = 0; c < LOGC_COUNT; c++) {
+            int all = name_len == 3 && strncasecmp(p, "all", 3) == 0;
+            if (all || (strlen(cat_names[c]) == name_len &&
+                        strncasecmp(p, cat_names[c], name_len) == 0)) {
+                atomic_store(&log_levels[c], level);
+                levels_set |= 1u << c;
+                found = 1;
+            }
+        }
+        if (!found)
+            return -1;
+
+        p = end ? end + 1 : p + len;
+    }
+    return 0;
+}
+
+void log_print_levels(FILE *f)
+{
+    for (int c = 0; c < LOGC_COUNT; c++) {
+        int l = atomic_load(&log_levels[c]);
+        fprintf(f, "%s%s=%s", c ? "," : "", cat_names[c],
+                l < 0 ? "off" : level_names[l]);
+    }
+}
+
+/* ---- Log file ---- */
+
+static char *log_path = NULL;
+
+/* Point fd 2 at path. dup2() swaps it atomically, so writers on other
+ * threads go to either the old file or the new one, never nowhere. */
+static int redirect_stderr(const char *path)
+{
+    int fd = open(path, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return -1;
+    int ret = dup2(fd, STDERR_FILENO);
+    close(fd);
+    return ret < 0 ? -1 : 0;
+}
+
+int log_open_file(const char *path)
+{
+    if (redirect_stderr(path) != 0)
+        return -1;
+    free(log_path);
+    log_path = strdup(path);
+    return 0;
+}
+
+int log_rotate(void)
+{
+    if (!log_path)
+        return -1;
+
+    char old[4096];
+    snprintf(old, sizeof(old), "%s.1", log_path);
+    flockfile(stderr);
+    int ret = rename(log_path, old) == 0 ? redirect_stderr(log_path) : -1;
+    funlockfile(stderr);
+    return ret;
+}
+
+void log_start(int verbose)
+{
+    for (int c = 0; c < LOGC_COUNT; c++) {
+        if (!(levels_set & (1u << c)))
+            atomic_store(&log_levels[c],
+                         verbose ? LOGL_DEBUG : LOG_DEFAULT_LEVEL);
+    }
+
+    pthread_key_create(&ring_key, ring_release);
+    atomic_store(&running, 1);
+    if (pthread_create(&logger, NULL, logger_thread, NULL) != 0)
+        atomic_store(&running, 0);
+}
+
+void log_stop(void)
+{
+    if (!atomic_load(&running))
+        return;
+    atomic_store(&running, 0);
+
+    /* Records written by calls that saw running set must still go out:
+     * wait for them, then drain once more after the logger's last pass */
+    while (atomic_load_explicit(&writers, memory_order_acquire) > 0)
+        sched_yield();
+    pthread_join(logger, NULL);
+    drain();
+    report_suppressed();
+}
@@ -0,0 +1,102 @@
+/*
+ * Asynchronous rate-limited diagnostic logging
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Asynchronous rate-limited diagnostic logging
+ *
+ * Diagnostics from the DSP and decoder threads go through log_msg()
+ * instead of fprintf(stderr). A call below its category's level costs
+ * one compare. A call that passes is checked against its category's
+ * token bucket (--log-rate messages per second, one second of burst),
+ * formatted into the calling thread's own ring, and written out by the
+ * logger thread, so the hot path never takes the stderr lock or makes a
+ * write syscall. Messages over the rate, or that find the thread's ring
+ * full, are counted and reported once a second as
+ *
+ *   log: doppler: 1234 messages suppressed
+ *
+ * Rings are single-producer/single-consumer and lock-free. A thread
+ * claims one on its first message and gives it back when it exits.
+ * Order is kept per thread; lines from different threads are interleaved
+ * roughly by time. Before log_start() and after log_stop(), and when no
+ * ring is free, messages are written synchronously.
+ */
+
+#ifndef __LOGGING_H__
+#define __LOGGING_H__
+
+#include <stdatomic.h>
+#include <stdio.h>
+
+typedef enum {
+    LOGC_MAIN = 0,
+    LOGC_SDR,
+    LOGC_DETECT,
+    LOGC_DOWNMIX,
+    LOGC_DEMOD,
+    LOGC_DOPPLER,
+    LOGC_ACARS,
+    LOGC_COUNT
+} log_cat_t;
+
+typedef enum {
+    LOGL_ERROR = 0,
+    LOGL_WARN,
+    LOGL_INFO,
+    LOGL_DEBUG,
+} log_level_t;
+
+#define LOG_DEFAULT_LEVEL  LOGL_WARN
+#define LOG_DEFAULT_RATE   100          /* messages/s per category */
+#define LOG_MSG_MAX        240          /* longer messages are truncated */
+
+extern atomic_int log_levels[LOGC_COUNT];
+
+static inline int log_enabled(log_cat_t cat, log_level_t level)
+{
+    return (int)level <= atomic_load_explicit(&log_levels[cat],
+                                              memory_order_relaxed);
+}
+
+/* Log one line (no trailing newline needed) if cat is at level or above */
+#define log_msg(cat, level, ...)                       \
+    do {                                               \
+        if (log_enabled((cat), (level)))               \
+            log_write((cat), __VA_ARGS__);             \
+    } while (0)
+
+/* Log one line unconditionally; log_msg() does the level check */
+void log_write(log_cat_t cat, const char *fmt, ...)
+    __attribute__((format(printf, 2, 3)));
+
+/* Parse CAT=LEVEL[,CAT=LEVEL...] (--log). CAT may be "all". Returns 0
+ * on success. */
+int log_parse_levels(const char *spec);
+
+/* Messages per second per category, 0 = unlimited (--log-rate) */
+void log_set_rate(int per_sec);
+
+/* Current levels as CAT=LEVEL,... (the --log syntax) */
+void log_print_levels(FILE *f);
+
+/* Send stderr, and with it every diagnostic, to path (--log-file).
+ * Returns 0 or -1 with errno set. */
+int log_open_file(const char *path);
+
+/* Rename the log file to PATH.1, replacing any older one, and carry on
+ * in a fresh PATH. Returns -1 if there is no log file or it fails. */
+int log_rotate(void);
+
+/* Apply -v (debug for categories not set with --log) and start the
+ * logger thread */
+void log_start(int verbose);
+
+/* Stop the logger thread, wait for log_write() calls in progress and
+ * write everything still queued */
+void log_stop(void);
+
+#endif
@@ -41,6 +41,7 @@
 #include "iridium.h"
 #include "burst_detect.h"
 #include "burst_downmix.h"
+#include "burst_pq.h"
 #include "qpsk_demod.h"
 #include "frame_output.h"
 #include "frame_decode.h"
@@ -49,34 +50,29 @@
 #include "doppler_pos.h"
 #include "gsmtap.h"
 #include "sbd_acars.h"
+#include "acars_dedup.h"
 #include "fftw_lock.h"
+#include "fftw_wisdom.h"
 #include "simd_kernels.h"
+#include "output_sink.h"
+#include "output_filter.h"
+#include "control.h"
+#include "shm_ring.h"
+#include "frame_store.h"
+#include "frame_bin.h"
+#include "logging.h"
+#include "lf_queue.h"
+#include "sample_pool.h"
+#include "thread_place.h"
+#include "task_pool.h"
+#include "frame_seq.h"
+#include "huge_alloc.h"
+#include "mem_budget.h"
 #include <fftw3.h>
 
 /* FFTW planner mutex (defined here, declared in fftw_lock.h) */
 pthread_mutex_t fftw_planner_mutex;
 
-/* FFTW wisdom file path */
-#define FFTW_WISDOM_FILE ".iridium-sniffer-fftw-wisdom"
-
-static void fftw_load_wisdom(void) {
-    const char *home = getenv("HOME");
-    if (!home) return;
-    char path[512];
-    snprintf(path, sizeof(path), "%s/%s", home, FFTW_WISDOM_FILE);
-    if (fftwf_import_wisdom_from_filename(path))
-        fprintf(stderr, "FFTW: loaded wisdom from %s\n", path);
-}
-
-static void fftw_save_wisdom(void) {
-    const char *home = getenv("HOME");
-    if (!home) return;
-    char path[512];
-    snprintf(path, sizeof(path), "%s/%s", home, FFTW_WISDOM_FILE);
-    if (fftwf_export_wisdom_to_filename(path))
-        fprintf(stderr, "FFTW: saved wisdom to %s\n", path);
-}
-
 #define C_FEK_BLOCKING_QUEUE_IMPLEMENTATION
 #define C_FEK_FAIR_LOCK_IMPLEMENTATION
 #include "blocking_queue.h"
@@ -142,9 +138,18 @@ char *save_bursts_dir = NULL;
 int diagnostic_mode = 0;
 int use_gardner = 1;
 int parsed_mode = 0;
+int no_raw = 0;
+int simplex_only = 0;
+int output_format = OUTPUT_FMT_RAW;
+int flush_policy = -1;  /* -1 = auto: per line on a tty, else timed */
+int flush_param = 0;
 int position_enabled = 0;
 double position_height = 0;
 int acars_enabled = 0;
+int acars_dedup_sec = ACARS_DEDUP_DEFAULT_SEC;
+int acars_threads = -1;     /* -1 = default for the build */
+int n_workers = 0;          /* task pool size, 0 = CPUs - 1 */
+size_t memory_budget = 0;   /* bytes, 0 = default buffer sizes */
 char *station_id = NULL;
 
 /* Multiple UDP endpoints for ACARS JSON streaming */
@@ -162,20 +167,34 @@ int feed_tcp_port = 0;
 /* ZMQ PUB output for multi-consumer iridium-toolkit compatibility */
 int zmq_enabled = 0;
 char *zmq_endpoint = NULL;
+int zmq_topic_prefix = 0;
 #define ZMQ_DEFAULT_ENDPOINT "tcp://*:7006"
 
+/* Shared-memory frame ring for local consumers */
+int shm_enabled = 0;
+char *shm_name = NULL;
+
+/* Indexed on-disk frame store */
+char *store_dir = NULL;
+int store_segment_sec = FS_DEFAULT_SEGMENT;
+
+/* Plan every FFT size for this configuration, save wisdom and exit */
+int generate_wisdom = 0;
+
+/* Runtime control socket and diagnostic log file */
+char *control_path = NULL;
+char *log_file = NULL;
+
 /* Threading state */
 volatile sig_atomic_t running = 1;
+static volatile sig_atomic_t flush_requested = 0;
 pid_t self_pid;
 
 /* Queues */
-#define SAMPLES_QUEUE_SIZE 4096
+#define SAMPLES_QUEUE_SIZE SAMPLE_POOL_MAX_BUFFERS   /* a pool buffer each */
 #define BURST_QUEUE_SIZE   2048
-#define FRAME_QUEUE_SIZE   512
-#define NUM_DOWNMIX_WORKERS 4
-Blocking_Queue samples_queue;
-Blocking_Queue burst_queue;
-Blocking_Queue frame_queue;
+spsc_queue_t samples_queue;     /* SDR or file reader -> detector */
+burst_pq_t burst_queue;         /* detector -> downmix workers */
 
 /* Atomic stats counters (for gr-iridium compatible status line) */
 atomic_ulong stat_n_detected = 0;
@@ -191,16 +210,57 @@ burst_detector_t *global_detector = NULL;
 /* Input file */
 FILE *in_file = NULL;
 
+/* ---- Output requirement profile ---- */
+/*
+ * Derived once from the enabled outputs. Each pipeline stage checks the
+ * profile instead of the individual output flags, so work whose results
+ * nobody consumes is skipped as early as possible.
+ */
+typedef struct {
+    int raw;            /* RAW lines are formatted (stdout or ZMQ) */
+    int ida;            /* ida_decode() results are consumed */
+    int frames;         /* frame_decode() IRA/IBC results are consumed */
+    int simplex_only;   /* only ring alerts wanted: detect/downmix simplex band */
+} output_profile_t;
+
+static output_profile_t profile;
+
+static void build_output_profile(void) {
+    int raw_stdout = !(diagnostic_mode || acars_enabled || no_raw);
+
+    profile.raw = raw_stdout || zmq_enabled;
+    profile.ida = parsed_mode || gsmtap_enabled || acars_enabled ||
+                  (web_enabled && !simplex_only);
+    profile.frames = web_enabled || position_enabled;
+    profile.simplex_only = simplex_only;
+
+    /* The frame store indexes every frame by type and CRC */
+    if (store_dir) {
+        profile.ida = 1;
+        profile.frames = 1;
+    }
+
+    /* --filter terms on frame type, CRC, sat or beam need decoder results */
+    unsigned needs = output_sink_filter_needs();
+    if (needs & FILTER_NEEDS_IDA)
+        profile.ida = 1;
+    if (needs & FILTER_NEEDS_FRAMES)
+        profile.frames = 1;
+
+    log_msg(LOGC_MAIN, LOGL_INFO,
+            "profile: raw=%d ida=%d frames=%d simplex_only=%d",
+            profile.raw, profile.ida, profile.frames, profile.simplex_only);
+}
+
 void parse_options(int argc, char **argv);
 
 /* ---- Sample buffer management ---- */
 
 void push_samples(sample_buf_t *buf) {
     atomic_fetch_add(&stat_sample_count, buf->num);
-    if (blocking_queue_add(&samples_queue, buf) == BQ_FULL) {
-        if (verbose)
-            fprintf(stderr, "WARNING: dropped samples\n");
-        free(buf);
+    if (spsc_queue_add(&samples_queue, buf) != 0) {
+        log_msg(LOGC_SDR, LOGL_INFO, "WARNING: dropped samples");
+        sample_buf_release(buf);
     }
 }
 
@@ -220,66 +280,83 @@ static inline int8_t clamp8(float v) {
     return (int8_t)v;
 }
 
+#define FILE_BLOCK_SAMPLES 32768   /* samples per read (each sample = I + Q) */
+
+/* Size of the file reader's sample blocks; CI16 is converted to int8 */
+static size_t file_block_bytes(void) {
+    return (iq_format == FMT_CF32) ? FILE_BLOCK_SAMPLES * 8
+                                   : FILE_BLOCK_SAMPLES * 2;
+}
+
 static void *spewer_thread(void *arg) {
     FILE *f = (FILE *)arg;
-    size_t block = 32768;  /* samples per read (each sample = I + Q) */
+    size_t block = FILE_BLOCK_SAMPLES;
+    size_t bytes = file_block_bytes();
+    int16_t *tmp = (iq_format == FMT_CI16) ? malloc(block * 4) : NULL;
 
     while (running) {
-        sample_buf_t *s;
         size_t r;
 
+        /* Waits for the detector to return a buffer; file input is
+         * never dropped */
+        sample_buf_t *s = sample_buf_get(bytes, 1);
+        if (s == NULL)
+            break;
+
         switch (iq_format) {
         case FMT_CI8:
             /* Native: 2 bytes per sample */
-            s = malloc(sizeof(*s) + block * 2);
             s->format = SAMPLE_FMT_INT8;
             r = fread(s->samples, 2, block, f);
             break;
 
-        case FMT_CI16: {
+        case FMT_CI16:
             /* 4 bytes per sample -> convert to int8 */
-            s = malloc(sizeof(*s) + block * 2);
             s->format = SAMPLE_FMT_INT8;
-            int16_t *tmp = malloc(block * 4);
-            r = fread(tmp, 4, block, f);
+            r = tmp ? fread(tmp, 4, block, f) : 0;
             for (size_t i = 0; i < r * 2; i++)
                 s->samples[i] = (int8_t)(tmp[i] >> 8);
-            free(tmp);
             break;
-        }
 
-        case FMT_CF32: {
+        case FMT_CF32:
             /* Pass float32 samples directly (no int8 quantization) */
-            s = malloc(sizeof(*s) + block * 8);
             s->format = SAMPLE_FMT_FLOAT;
             r = fread(s->samples, 8, block, f);
             break;
-        }
 
         default:
-            s = malloc(sizeof(*s));
             s->format = SAMPLE_FMT_INT8;
             r = 0;
             break;
         }
 
         if (r == 0) {
-            free(s);
+            sample_buf_release(s);
             break;
         }
         s->num = r;
-        if (blocking_queue_put(&samples_queue, s) != 0) {
-            free(s);
+        if (spsc_queue_put(&samples_queue, s) != 0) {
+            sample_buf_release(s);
             break;
         }
     }
+    free(tmp);
 
-    /* Wait for queue to drain */
-    while (running && samples_queue.queue_size > 0)
-        usleep(10000);
+    /* End of stream: the detector takes what is queued, then sees the
+     * close and shuts the pipeline down (detector_thread_fn) */
+    spsc_queue_close(&samples_queue);
+    return NULL;
+}
 
-    running = 0;
-    kill(self_pid, SIGINT);
+/* The detector returns when running is cleared, or when the file reader
+ * has closed samples_queue and every block is processed. In the second
+ * case the input is done, so start the shutdown the way a signal does. */
+static void *detector_thread_fn(void *arg) {
+    burst_detector_thread(arg);
+    if (running) {
+        running = 0;
+        kill(self_pid, SIGINT);
+    }
     return NULL;
 }
 
@@ -302,86 +379,216 @@ static void gsmtap_ida_cb(const uint8_t *data, int len,
     atomic_fetch_add(&gsmtap_sent_count, 1);
 }
 
-/* ---- Frame consumer: QPSK demod + output ---- */
+/* ---- Output sinks (each runs on its own worker thread) ---- */
 
-static void *frame_consumer_thread(void *arg) {
-    (void)arg;
-    while (1) {
-        downmix_frame_t *frame;
-        if (blocking_queue_take(&frame_queue, &frame) != 0)
-            break;
+/* RAW / parsed IDA lines to stdout and ZMQ */
+static void sink_frames(const output_item_t *item, void *user)
+{
+    (void)user;
+    if (parsed_mode && item->ida_ok)
+        frame_output_print_ida(&item->ida);
+    else if (profile.raw)
+        frame_output_print(item->demod);
+}
 
-        atomic_fetch_add(&stat_n_handled, 1);
-
-        demod_frame_t *demod = NULL;
-        if (qpsk_demod(frame, &demod)) {
-            atomic_fetch_add(&stat_n_ok_bursts, 1);
-            atomic_fetch_add(&stat_n_ok_sub, 1);
-
-            /* Try IDA decode if parsed output or GSMTAP is active */
-            int ida_ok = 0;
-            ida_burst_t burst;
-            if (parsed_mode || gsmtap_enabled || acars_enabled || web_enabled)
-                ida_ok = ida_decode(demod, &burst);
-
-            /* Output: parsed IDA line if available, otherwise RAW */
-            if (parsed_mode && ida_ok)
-                frame_output_print_ida(&burst);
-            else
-                frame_output_print(demod);
-
-            if (web_enabled || position_enabled) {
-                decoded_frame_t decoded;
-                if (frame_decode(demod, &decoded)) {
-                    if (decoded.type == FRAME_IRA) {
-                        if (web_enabled)
-                            web_map_add_ra(&decoded.ira, decoded.timestamp,
-                                            decoded.frequency);
-                        if (position_enabled)
-                            doppler_pos_add_measurement(&decoded.ira,
-                                                         decoded.frequency,
-                                                         decoded.timestamp);
-                    } else if (decoded.type == FRAME_IBC) {
-                        if (web_enabled)
-                            web_map_add_sat(&decoded.ibc, decoded.timestamp);
-                    }
-                }
-            }
+static void sink_gsmtap(const output_item_t *item, void *user)
+{
+    ida_context_t *ctx = (ida_context_t *)user;
+    if (item->ida_ok)
+        ida_reassemble(ctx, &item->ida, gsmtap_ida_cb, NULL);
+    ida_reassemble_flush(ctx, item->demod->timestamp);
+}
 
-            if (gsmtap_enabled) {
-                if (ida_ok)
-                    ida_reassemble(&ida_ctx, &burst, gsmtap_ida_cb, NULL);
-                ida_reassemble_flush(&ida_ctx, demod->timestamp);
-            }
+static void sink_acars(const output_item_t *item, void *user)
+{
+    ida_context_t *ctx = (ida_context_t *)user;
+    if (item->ida_ok)
+        ida_reassemble(ctx, &item->ida, acars_ida_cb, NULL);
+    ida_reassemble_flush(ctx, item->demod->timestamp);
+}
 
-            if (acars_enabled) {
-                if (ida_ok)
-                    ida_reassemble(&acars_ida_ctx, &burst,
-                                   acars_ida_cb, NULL);
-                ida_reassemble_flush(&acars_ida_ctx, demod->timestamp);
-            }
+/* Ring alerts, satellites and MT positions for the web map */
+static void sink_web(const output_item_t *item, void *user)
+{
+    ida_context_t *ctx = (ida_context_t *)user;
+    const decoded_frame_t *d = &item->decoded;
+
+    if (item->decoded_ok) {
+        if (d->type == FRAME_IRA)
+            web_map_add_ra(&d->ira, d->timestamp, d->frequency);
+        else if (d->type == FRAME_IBC)
+            web_map_add_sat(&d->ibc, d->timestamp);
+    }
 
-            if (web_enabled) {
-                if (ida_ok)
-                    ida_reassemble(&mtpos_ida_ctx, &burst,
-                                   mtpos_ida_cb, NULL);
-                ida_reassemble_flush(&mtpos_ida_ctx, demod->timestamp);
-            }
+    if (profile.ida) {
+        if (item->ida_ok)
+            ida_reassemble(ctx, &item->ida, mtpos_ida_cb, NULL);
+        ida_reassemble_flush(ctx, item->demod->timestamp);
+    }
+}
+
+static void sink_position(const output_item_t *item, void *user)
+{
+    (void)user;
+    const decoded_frame_t *d = &item->decoded;
+    if (item->decoded_ok && d->type == FRAME_IRA)
+        doppler_pos_add_measurement(&d->ira, d->frequency, d->timestamp);
+}
+
+/* Frame metadata for the binary encoders (bits stay in the demod frame) */
+static void frame_rec_from_demod(const demod_frame_t *d, frame_bin_rec_t *r)
+{
+    r->direction = (uint8_t)d->direction;
+    r->timestamp = d->timestamp;
+    r->id = d->id;
+    r->frequency = d->center_frequency;
+    r->magnitude = d->magnitude;
+    r->noise = d->noise;
+    r->level = d->level;
+    r->confidence = d->confidence;
+    r->payload_symbols = d->n_payload_symbols > 0 ? d->n_payload_symbols : 0;
+    r->n_bits = d->n_bits;
+}
+
+/* Binary frame records into the shared-memory ring */
+static void sink_shm(const output_item_t *item, void *user)
+{
+    (void)user;
+    static frame_bin_rec_t r;
+    uint8_t rec[FRAME_BIN_MAX_REC];
+    frame_rec_from_demod(item->demod, &r);
+    int len = frame_bin_encode_frame(rec, &r, item->demod->bits);
+    if (len > 0)
+        shm_ring_writer_publish(rec, len);
+}
+
+/* Columnar segments on disk, with type and CRC for iridium-store-query */
+static void sink_store(const output_item_t *item, void *user)
+{
+    (void)user;
+    static frame_bin_rec_t r;
+    frame_rec_from_demod(item->demod, &r);
+    frame_store_add(&r, item->demod->bits, output_item_class(item),
+                    item->ida_ok ? item->ida.crc_ok : -1);
+}
+
+static void register_output_sinks(void) {
+    if (profile.raw || parsed_mode)
+        output_sink_register("frames", SINK_BLOCK, sink_frames, NULL);
+    if (gsmtap_enabled)
+        output_sink_register("gsmtap", SINK_DROP_OLDEST, sink_gsmtap, &ida_ctx);
+    if (acars_enabled)
+        output_sink_register("acars", SINK_DROP_OLDEST, sink_acars, &acars_ida_ctx);
+    if (web_enabled)
+        output_sink_register("web", SINK_DROP_OLDEST, sink_web, &mtpos_ida_ctx);
+    if (position_enabled)
+        output_sink_register("position", SINK_DROP_OLDEST, sink_position, NULL);
+    if (shm_enabled)
+        output_sink_register("shm", SINK_DROP_OLDEST, sink_shm, NULL);
+    if (store_dir)
+        output_sink_register("store", SINK_DROP_OLDEST, sink_store, NULL);
+}
+
+/* ---- Pipeline tasks: downmix -> demod -> decode on the worker pool ---- */
+
+typedef struct {
+    uint64_t seq;               /* frame_seq slot of the burst */
+    downmix_frame_t *frame;
+    output_item_t *item;
+} frame_job_t;
+
+static void decode_task(task_worker_t *w, void *arg) {
+    (void)w;
+    frame_job_t *job = arg;
+    output_item_t *item = job->item;
 
+    /* Decoders run once here; sinks only read the results */
+    if (profile.ida)
+        item->ida_ok = ida_decode(item->demod, &item->ida);
+    if (profile.frames)
+        item->decoded_ok = frame_decode(item->demod, &item->decoded);
+
+    frame_seq_close(job->seq, item, item->demod->timestamp);
+    free(job);
+}
+
+static void demod_task(task_worker_t *w, void *arg) {
+    frame_job_t *job = arg;
+    downmix_frame_t *frame = job->frame;
+
+    atomic_fetch_add(&stat_n_handled, 1);
+
+    demod_frame_t *demod = NULL;
+    if (qpsk_demod(frame, &demod)) {
+        atomic_fetch_add(&stat_n_ok_bursts, 1);
+        atomic_fetch_add(&stat_n_ok_sub, 1);
+
+        job->item = output_item_new(demod);
+        job->frame = NULL;
+        if (!job->item) {
+            /* Out of memory: drop the frame */
             free(demod->bits);
             free(demod->llr);
             free(demod);
-        } else if (verbose) {
-            fprintf(stderr, "demod: UW check failed id=%lu freq=%.0f Hz dir=%s\n",
-                    (unsigned long)frame->id, frame->center_frequency,
-                    frame->direction == DIR_DOWNLINK ? "DL" :
-                    frame->direction == DIR_UPLINK ? "UL" : "??");
+            frame_seq_close(job->seq, NULL, 0);
+            free(job);
+        } else if (profile.ida || profile.frames) {
+            task_spawn(w, decode_task, job);
+        } else {
+            frame_seq_close(job->seq, job->item, demod->timestamp);
+            free(job);
         }
+    } else {
+        log_msg(LOGC_DEMOD, LOGL_DEBUG,
+                "demod: UW check failed id=%lu freq=%.0f Hz dir=%s",
+                (unsigned long)frame->id, frame->center_frequency,
+                frame->direction == DIR_DOWNLINK ? "DL" :
+                frame->direction == DIR_UPLINK ? "UL" : "??");
+        frame_seq_close(job->seq, NULL, 0);
+        free(job);
+    }
 
-        free(frame->samples);
-        free(frame);
+    free(frame->samples);
+    free(frame);
+}
+
+static void downmix_task(task_worker_t *w, void *arg) {
+    burst_data_t *burst = arg;
+    burst_downmix_t *dm = task_worker_ctx(w);
+    uint64_t seq = burst->seq;
+
+    downmix_frame_t *frames = NULL;
+    int n_frames = burst_downmix_process(dm, burst, &frames);
+    burst_data_free(burst);
+
+    if (n_frames > 0 && frames) {
+        /* Process returns a single malloc'd frame */
+        frame_job_t *job = malloc(sizeof(*job));
+        if (!job) {
+            /* Out of memory: drop the frame */
+            free(frames->samples);
+            free(frames);
+            frame_seq_close(seq, NULL, 0);
+            return;
+        }
+        job->seq = seq;
+        job->frame = frames;
+        job->item = NULL;
+        task_spawn(w, demod_task, job);
+    } else {
+        free(frames);
+        frame_seq_close(seq, NULL, 0);
     }
-    return NULL;
+}
+
+/* Pool source: the next burst by priority, until burst_queue closes */
+static int next_burst(task_fn_t *fn, void **arg) {
+    burst_data_t *burst;
+    if (burst_pq_take(&burst_queue, &burst) != 0)
+        return -1;
+    *fn = downmix_task;
+    *arg = burst;
+    return 0;
 }
 
 /* ---- Stats thread (gr-iridium/iridium-extractor compatible format) ---- */
@@ -400,11 +607,29 @@ static void *stats_thread_fn(void *arg) {
     unsigned long prev_det = 0, prev_ok = 0, prev_sub = 0;
     unsigned long prev_handled = 0, prev_samples = 0;
     unsigned q_max = 0;
+    int tick = 0;
+    int huge_reported = 0;
 
+    /* 100 ms tick drives the timed stdout flush; stats print every 10th */
     while (running) {
-        usleep(1000000);
+        usleep(100000);
         if (!running) break;
 
+        if (flush_requested) {
+            flush_requested = 0;
+            frame_output_flush();
+        } else {
+            frame_output_tick();
+        }
+        if (gsmtap_enabled)
+            gsmtap_tick();
+        if (acars_enabled)
+            acars_tick();
+
+        if (++tick < 10)
+            continue;
+        tick = 0;
+
         unsigned long now = now_ms();
         double dt = (now - prev_t) / 1000.0;
         double elapsed = (now - t0) / 1000.0;
@@ -426,7 +651,7 @@ static void *stats_thread_fn(void *arg) {
         unsigned long dsamp = samp    - prev_samples;
 
         /* Track max queue depth */
-        unsigned qsz = (unsigned)samples_queue.queue_size;
+        unsigned qsz = spsc_queue_size(&samples_queue);
         if (qsz > q_max) q_max = qsz;
 
         /* Rates */
@@ -497,12 +722,19 @@ static void *stats_thread_fn(void *arg) {
             fprintf(stderr, " | ok: %10lu", sub);
             fprintf(stderr, " | ok_avg: %3.0f/s", ok_rate_avg);
             fprintf(stderr, " | d: %lu", dropped);
+            output_sinks_print_stats(stderr);
             fprintf(stderr, "\n");
         }
 
         /* Suppress unused variable warning */
         (void)dsamp;
 
+        /* Once, after the buffers have seen a second of traffic */
+        if (!huge_reported) {
+            huge_reported = 1;
+            huge_alloc_report(stderr);
+        }
+
         /* Doppler positioning: attempt solve every 10 seconds */
         if (position_enabled && (int)elapsed % 10 == 0 && elapsed > 5) {
             doppler_solution_t sol;
@@ -536,6 +768,38 @@ static void sig_handler(int signo) {
     running = 0;
 }
 
+/* SIGUSR1: flush buffered output (picked up by the stats thread) */
+static void sigusr1_handler(int signo) {
+    (void)signo;
+    flush_requested = 1;
+}
+
+/* ---- --generate-wisdom ---- */
+
+/*
+ * Every size the detector and downmix contexts plan with FFTW_MEASURE
+ * for this sample rate. The sync word FFTs use FFTW_ESTIMATE and the
+ * RRC and anti-alias filters are direct-form FIRs, so they need none.
+ */
+static int generate_wisdom_main(void) {
+    burst_config_t det_config = {
+        .center_frequency = center_freq,
+        .sample_rate = (int)samp_rate,
+    };
+    downmix_config_t dm_config = { 0 };
+    int cfo_size, corr_size;
+    burst_downmix_fft_sizes(&dm_config, &cfo_size, &corr_size);
+
+    fftw_wisdom_job_t jobs[] = {
+        { burst_detector_fft_size(&det_config), FFTW_FORWARD },
+        { cfo_size, FFTW_FORWARD },
+        { corr_size, FFTW_FORWARD },
+        { corr_size, FFTW_BACKWARD },
+    };
+    return fftw_wisdom_generate(jobs, sizeof(jobs) / sizeof(jobs[0])) == 0
+        ? 0 : 1;
+}
+
 /* ---- Main ---- */
 
 int main(int argc, char **argv) {
@@ -559,9 +823,16 @@ int main(int argc, char **argv) {
     signal(SIGINT, sig_handler);
     signal(SIGTERM, sig_handler);
     signal(SIGPIPE, SIG_IGN);
+    signal(SIGUSR1, sigusr1_handler);
     self_pid = getpid();
 
     parse_options(argc, argv);
+    if (generate_wisdom)
+        return generate_wisdom_main();
+    if (log_file && log_open_file(log_file) != 0)
+        err(1, "Cannot open log file %s", log_file);
+    log_start(verbose);
+    build_output_profile();
 
     /* Initialize SIMD dispatch (must be before any DSP) */
     simd_init(no_simd);
@@ -576,24 +847,47 @@ int main(int argc, char **argv) {
     }
 
     fftw_lock_init();
-    fftw_load_wisdom();
+    fftw_wisdom_load();
     frame_output_init(file_info);
+    if (flush_policy < 0)
+        flush_policy = isatty(STDOUT_FILENO) ? FLUSH_LINE : FLUSH_TIME;
+    frame_output_set_flush((flush_policy_t)flush_policy, flush_param);
 
 #ifdef HAVE_ZMQ
     if (zmq_enabled) {
         const char *ep = zmq_endpoint ? zmq_endpoint : ZMQ_DEFAULT_ENDPOINT;
-        if (frame_output_zmq_init(ep) != 0)
+        if (frame_output_zmq_init(ep, zmq_topic_prefix) != 0)
             errx(1, "Failed to bind ZMQ PUB socket on %s", ep);
-        fprintf(stderr, "ZMQ: publishing on %s\n", ep);
+        fprintf(stderr, "ZMQ: publishing on %s%s\n", ep,
+                zmq_topic_prefix ? " (topic prefixes)" : "");
     }
 #endif
 
-    if (web_enabled || gsmtap_enabled || position_enabled)
+    if (shm_enabled) {
+        const char *name = shm_name ? shm_name : SHM_RING_DEFAULT_NAME;
+        if (shm_ring_writer_open(name, SHM_RING_DEFAULT_SIZE, file_info) != 0)
+            err(1, "Failed to create shared-memory ring %s", name);
+        fprintf(stderr, "SHM: publishing frames on %s (%d MiB ring)\n",
+                name, SHM_RING_DEFAULT_SIZE >> 20);
+    }
+
+    if (store_dir) {
+        if (frame_store_open(store_dir, store_segment_sec, file_info) != 0)
+            err(1, "Cannot use frame store directory %s", store_dir);
+        fprintf(stderr, "Store: writing %d s segments to %s\n",
+                store_segment_sec, store_dir);
+    }
+
+    if (profile.frames)
         frame_decode_init();
 
-    if (parsed_mode || gsmtap_enabled || acars_enabled || web_enabled)
+    if (profile.ida)
         ida_decode_init();
 
+    if (profile.simplex_only)
+        fprintf(stderr, "Simplex only: processing ring alert band "
+                "(>= %.1f MHz)\n", IR_SIMPLEX_FREQUENCY_MIN / 1e6);
+
     if (position_enabled) {
         doppler_pos_init();
         /* Height aiding defaults to 0m (sea level) unless user specifies
@@ -633,14 +927,6 @@ int main(int argc, char **argv) {
         fprintf(stderr, ")\n");
     }
 
-    blocking_queue_init(&samples_queue, SAMPLES_QUEUE_SIZE);
-    blocking_queue_init(&burst_queue, BURST_QUEUE_SIZE);
-    blocking_queue_init(&frame_queue, FRAME_QUEUE_SIZE);
-
-    /* Create burst detector and all downmix workers here in the main thread,
-     * before the SDR starts. FFTW_MEASURE plan creation can take several
-     * seconds without wisdom; doing it here ensures the detector is fully
-     * initialized before any samples arrive, preventing startup queue saturation. */
     burst_config_t det_config = {
         .center_frequency = center_freq,
         .sample_rate = (int)samp_rate,
@@ -653,52 +939,108 @@ int main(int argc, char **argv) {
         .threshold = (float)threshold_db,
         .history_size = IR_DEFAULT_HISTORY_SIZE,
         .use_gpu = use_gpu,
+        .min_frequency = profile.simplex_only ? IR_SIMPLEX_FREQUENCY_MIN : 0,
     };
+    unsigned burst_queue_size = BURST_QUEUE_SIZE;
+    int work_size = 0;
+
+    if (n_workers == 0)
+        n_workers = task_pool_default_workers();
+
+    /* A memory budget fixes every large buffer's size up front */
+    if (memory_budget > 0) {
+        mem_plan_t plan = {
+            .budget = memory_budget,
+            .sample_rate = (int)samp_rate,
+            .burst_span = burst_detector_max_span(&det_config),
+            .max_workers = n_workers,
+        };
+        if (mem_budget_plan(&plan) != 0)
+            errx(1, "--memory-budget too small: %.0f MiB needed at %.0f Hz",
+                 plan.minimum / (1024.0 * 1024.0), samp_rate);
+        mem_budget_print(&plan, stderr);
+
+        sample_pool_set_bytes(plan.sample_pool_bytes);
+        burst_queue_size = plan.burst_queue;
+        det_config.ring_size = plan.ring_samples;
+        det_config.copy_slots = plan.copy_slots;
+        work_size = plan.work_size;
+        n_workers = plan.workers;
+    }
+
+    if (spsc_queue_init(&samples_queue, SAMPLES_QUEUE_SIZE) != 0 ||
+        burst_pq_init(&burst_queue, burst_queue_size) != 0)
+        errx(1, "Cannot allocate pipeline queues");
+
+    /* Create the burst detector and every worker's downmix state here in
+     * the main thread, before the SDR starts. Sizes without wisdom get
+     * FFTW_ESTIMATE plans at once and are measured in the background, so
+     * this takes milliseconds; each context swaps in the measured plans
+     * itself. */
     burst_detector_t *det = burst_detector_create(&det_config);
     global_detector = det;
 
-    burst_downmix_t *dm[NUM_DOWNMIX_WORKERS];
-    for (int i = 0; i < NUM_DOWNMIX_WORKERS; i++) {
-        downmix_config_t dm_config = { 0 };
+    burst_downmix_t **dm = malloc(sizeof(*dm) * n_workers);
+    if (!dm)
+        errx(1, "Cannot allocate downmix state");
+    for (int i = 0; i < n_workers; i++) {
+        downmix_config_t dm_config = {
+            .min_frequency = profile.simplex_only ? IR_SIMPLEX_FREQUENCY_MIN : 0,
+            .work_size = work_size,
+        };
         dm[i] = burst_downmix_create(&dm_config);
+        if (!dm[i])
+            errx(1, "Cannot create downmix state for worker %d", i);
     }
 
+    fftw_wisdom_background_start();
+
     /* Launch burst detector thread */
-    pthread_create(&detector, NULL, burst_detector_thread, det);
+    pthread_create(&detector, NULL, detector_thread_fn, det);
 #ifdef __linux__
     pthread_setname_np(detector, "detector");
 #endif
+    thread_place_apply(detector, ROLE_DETECTOR, "detector");
 
-    /* Launch downmix worker pool */
-    pthread_t downmix_workers[NUM_DOWNMIX_WORKERS];
-    for (int i = 0; i < NUM_DOWNMIX_WORKERS; i++) {
-        pthread_create(&downmix_workers[i], NULL, burst_downmix_thread, dm[i]);
-#ifdef __linux__
-        char name[16];
-        snprintf(name, sizeof(name), "downmix-%d", i);
-        pthread_setname_np(downmix_workers[i], name);
-#endif
-    }
+    /* Output sinks, one worker each, fed in timestamp order by the
+     * sequencer */
+    register_output_sinks();
+    if (output_sinks_start() != 0)
+        errx(1, "Cannot start output sinks");
+    frame_seq_init(output_sinks_dispatch);
 
-    /* Launch frame consumer (QPSK demod + output) */
-    pthread_t frame_consumer;
-    pthread_create(&frame_consumer, NULL, frame_consumer_thread, NULL);
-#ifdef __linux__
-    pthread_setname_np(frame_consumer, "demod");
-#endif
+    /* Launch the worker pool: downmix, demod and decode tasks */
+    task_pool_t *pool = task_pool_create(n_workers, next_burst, (void **)dm);
+    if (!pool)
+        errx(1, "Cannot start worker pool");
 
     /* Launch stats thread */
     pthread_create(&stats, NULL, stats_thread_fn, NULL);
 #ifdef __linux__
     pthread_setname_np(stats, "stats");
 #endif
+    thread_place_apply(stats, ROLE_STATS, "stats");
+
+    /* Control socket, once everything it can reach is running */
+    if (control_path) {
+        unsigned ctl_needs = 0;
+        if (profile.ida)
+            ctl_needs |= FILTER_NEEDS_IDA;
+        if (profile.frames)
+            ctl_needs |= FILTER_NEEDS_FRAMES;
+        if (control_start(control_path, det, ctl_needs) != 0)
+            errx(1, "Cannot start control socket");
+    }
 
     if (live) {
         int sdr_started = 0;
 #ifdef HAVE_BLADERF
         if (!sdr_started && bladerf_num >= 0) {
             bladerf_dev = bladerf_setup(bladerf_num);
+            if (sample_pool_init(bladerf_block_bytes()) != 0)
+                errx(1, "Cannot allocate sample buffers");
             pthread_create(&bladerf_thread, NULL, bladerf_stream_thread, bladerf_dev);
+            thread_place_apply(bladerf_thread, ROLE_SDR, "bladerf-rx");
             sdr_started = 1;
         }
 #endif
@@ -706,6 +1048,7 @@ int main(int argc, char **argv) {
         if (!sdr_started && usrp_serial != NULL) {
             usrp = usrp_setup(usrp_serial);
             pthread_create(&usrp_thread, NULL, usrp_stream_thread, (void *)usrp);
+            thread_place_apply(usrp_thread, ROLE_SDR, "usrp-rx");
             sdr_started = 1;
         }
 #endif
@@ -713,12 +1056,15 @@ int main(int argc, char **argv) {
         if (!sdr_started && (soapy_num >= 0 || soapy_args)) {
             soapy = soapy_setup(soapy_num, soapy_args);
             pthread_create(&soapy_thread, NULL, soapy_stream_thread, (void *)soapy);
+            thread_place_apply(soapy_thread, ROLE_SDR, "soapy-rx");
             sdr_started = 1;
         }
 #endif
 #ifdef HAVE_HACKRF
         if (!sdr_started && serial != NULL) {
             hackrf = hackrf_setup();
+            if (sample_pool_init(HACKRF_TRANSFER_BYTES) != 0)
+                errx(1, "Cannot allocate sample buffers");
             hackrf_start_rx(hackrf, hackrf_rx_cb, NULL);
             sdr_started = 1;
         }
@@ -727,10 +1073,13 @@ int main(int argc, char **argv) {
             errx(1, "No SDR selected. Use -i to specify a device "
                  "(run --list to see available devices)");
     } else if (in_file != NULL) {
+        if (sample_pool_init(file_block_bytes()) != 0)
+            errx(1, "Cannot allocate sample buffers");
         pthread_create(&spewer, NULL, spewer_thread, in_file);
 #ifdef __linux__
         pthread_setname_np(spewer, "spewer");
 #endif
+        thread_place_apply(spewer, ROLE_SDR, "spewer");
     }
 
     /* Wait for signal */
@@ -742,6 +1091,7 @@ int main(int argc, char **argv) {
         pause();
     }
     running = 0;
+    control_stop();
 
     /* Shutdown SDR */
     if (live) {
@@ -773,25 +1123,61 @@ int main(int argc, char **argv) {
 #endif
     }
 
-    /* Drain queues and join threads in pipeline order */
-    blocking_queue_close(&samples_queue);
+    /* Close queues and join threads in pipeline order. The detector stops
+     * as soon as running is cleared and unprocessed sample blocks are
+     * discarded; burst and frame queues are drained by their consumers
+     * before take() reports the close. */
+    spsc_queue_close(&samples_queue);
+    pthread_join(detector, NULL);
+    {
+        /* Returning these also unblocks a file reader waiting for a
+         * buffer; its next put sees the closed queue */
+        sample_buf_t *s;
+        while (spsc_queue_poll(&samples_queue, &s) == 0)
+            sample_buf_release(s);
+    }
     if (!live && in_file != NULL)
         pthread_join(spewer, NULL);
-    pthread_join(detector, NULL);
 
-    /* Wait for burst_queue to drain before closing */
-    while (burst_queue.queue_size > 0)
-        usleep(10000);
-    blocking_queue_close(&burst_queue);
-    for (int i = 0; i < NUM_DOWNMIX_WORKERS; i++)
-        pthread_join(downmix_workers[i], NULL);
-
-    /* Wait for frame_queue to drain before closing */
-    while (frame_queue.queue_size > 0)
-        usleep(10000);
-    blocking_queue_close(&frame_queue);
-    pthread_join(frame_consumer, NULL);
+    /* Workers drain burst_queue and finish every task they hold; each
+     * burst's output has gone through the sequencer by the time they exit */
+    burst_pq_close(&burst_queue);
+    task_pool_join(pool);
+    spsc_queue_destroy(&samples_queue);
+    fftw_wisdom_background_stop();
+    for (int i = 0; i < n_workers; i++)
+        burst_downmix_destroy(dm[i]);
+    free(dm);
+    output_sinks_shutdown();
     pthread_join(stats, NULL);
+    frame_output_flush();
+    log_stop();
+
+    if (sample_pool_overflows() > 0)
+        fprintf(stderr, "iridium-sniffer: dropped %lu sample blocks "
+                "(sample buffer pool exhausted)\n", sample_pool_overflows());
+    sample_pool_shutdown();
+
+    if (frame_seq_late() > 0)
+        fprintf(stderr, "iridium-sniffer: %lu frames emitted behind a later "
+                "timestamp\n", frame_seq_late());
+
+    {
+        unsigned long shed[BURST_PQ_BUCKETS], total = 0;
+        burst_pq_shed_counts(&burst_queue, shed);
+        for (int i = 0; i < BURST_PQ_BUCKETS; i++)
+            total += shed[i];
+        if (total > 0) {
+            fprintf(stderr, "iridium-sniffer: shed %lu bursts under load "
+                    "(SNR dB", total);
+            for (int i = 0; i < BURST_PQ_BUCKETS; i++)
+                if (shed[i] > 0)
+                    fprintf(stderr, " %s: %lu", burst_pq_bucket_name(i),
+                            shed[i]);
+            fprintf(stderr, ")\n");
+        }
+    }
+    burst_pq_destroy(&burst_queue);
 
     if (web_enabled)
         web_map_shutdown();
@@ -808,14 +1194,32 @@ int main(int argc, char **argv) {
     }
 
 #ifdef HAVE_ZMQ
-    if (zmq_enabled)
+    if (zmq_enabled) {
+        unsigned long zmq_sent, zmq_dropped;
         frame_output_zmq_shutdown();
+        frame_output_zmq_stats(&zmq_sent, &zmq_dropped);
+        fprintf(stderr, "iridium-sniffer: published %lu ZMQ messages "
+                "(%lu dropped)\n", zmq_sent, zmq_dropped);
+    }
 #endif
 
+    if (shm_enabled) {
+        fprintf(stderr, "iridium-sniffer: published %llu frames to shared memory\n",
+                (unsigned long long)shm_ring_writer_count());
+        shm_ring_writer_close();
+    }
+
+    if (store_dir) {
+        frame_store_close();
+        fprintf(stderr, "iridium-sniffer: stored %llu frames in %llu segments\n",
+                (unsigned long long)frame_store_frames(),
+                (unsigned long long)frame_store_segments());
+    }
+
     if (in_file != NULL)
         fclose(in_file);
 
-    fftw_save_wisdom();
+    fftw_wisdom_save();
     free(file_info);
     fprintf(stderr, "iridium-sniffer: shutdown complete\n");
     return 0;
@@ -0,0 +1,117 @@
+/*
+ * Memory budget: size the pipeline's buffers from a byte budget
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Memory budget: size the pipeline's buffers from a byte budget
+ */
+
+#include <stdlib.h>
+
+#include "mem_budget.h"
+#include "sample_pool.h"
+
+#define MIB                 (1024.0 * 1024.0)
+#define PAGE_BYTES          4096
+
+/* Frames, FFTW buffers and plans of one worker besides its work buffers */
+#define WORKER_EXTRA_BYTES  (2UL * 1024 * 1024)
+
+#define MIN_SAMPLE_BUFFERS  16
+#define MIN_COPY_SLOTS      2
+#define MAX_COPY_SLOTS      64
+#define MIN_BURST_QUEUE     128
+#define MAX_BURST_QUEUE     2048
+
+/* Bursts per second of ring on a busy sky; sizes burst_queue so queued
+ * bursts span about as much time as the ring holds */
+#define BURSTS_PER_SEC      1024
+
+int mem_budget_parse(const char *s, size_t *bytes)
+{
+    char *end;
+    double v = strtod(s, &end);
+    if (end == s || v <= 0)
+        return -1;
+
+    switch (*end) {
+    case 'k': case 'K': v *= 1024;                end++; break;
+    case 'm': case 'M': v *= 1024 * 1024;         end++; break;
+    case 'g': case 'G': v *= 1024.0 * 1024 * 1024; end++; break;
+    }
+    if (*end == 'i' && end[1] == 'B')
+        end += 2;
+    else if (*end == 'B')
+        end++;
+    if (*end != '\0')
+        return -1;
+
+    *bytes = (size_t)v;
+    return 0;
+}
+
+static size_t min_size(size_t a, size_t b) { return a < b ? a : b; }
+
+int mem_budget_plan(mem_plan_t *p)
+{
+    size_t span = p->burst_span;
+    size_t work = (span + 4095) & ~(size_t)4095;
+    size_t per_worker = work * (2 * 8 + 2 * 4) + WORKER_EXTRA_BYTES;
+    size_t per_buffer = MEM_SAMPLE_BLOCK_BYTES + PAGE_BYTES;
+    size_t per_slot = span * 8;
+    size_t ring_default = span > (size_t)(2 * p->sample_rate)
+                        ? span : (size_t)(2 * p->sample_rate);
+
+    /* Smallest working plan: one worker, a ring of one span */
+    p->workers = 1;
+    p->ring_samples = span;
+    p->sample_pool_bytes = MIN_SAMPLE_BUFFERS * per_buffer;
+    p->copy_slots = MIN_COPY_SLOTS;
+    p->work_size = (int)work;
+    p->minimum = MEM_BASE_BYTES + per_worker + span * 8
+               + MIN_SAMPLE_BUFFERS * per_buffer + MIN_COPY_SLOTS * per_slot;
+    if (p->budget < p->minimum)
+        return -1;
+
+    /* Share what is left: workers first, then ring, sample buffers and
+     * burst copies. Each share is capped at the default configuration. */
+    size_t surplus = p->budget - p->minimum;
+
+    size_t n = min_size(surplus * 45 / 100 / per_worker,
+                        (size_t)(p->max_workers - 1));
+    p->workers += (int)n;
+    surplus -= n * per_worker;
+
+    n = min_size(surplus * 45 / 100 / 8, ring_default - span);
+    p->ring_samples += n;
+    surplus -= n * 8;
+
+    n = min_size(surplus * 30 / 100 / per_buffer,
+                 SAMPLE_POOL_BYTES / per_buffer - MIN_SAMPLE_BUFFERS);
+    p->sample_pool_bytes += n * per_buffer;
+    surplus -= n * per_buffer;
+
+    n = min_size(surplus / per_slot, MAX_COPY_SLOTS - MIN_COPY_SLOTS);
+    p->copy_slots += (int)n;
+
+    size_t q = p->ring_samples * BURSTS_PER_SEC / (size_t)p->sample_rate;
+    p->burst_queue = (unsigned)(q < MIN_BURST_QUEUE ? MIN_BURST_QUEUE
+                              : q > MAX_BURST_QUEUE ? MAX_BURST_QUEUE : q);
+    return 0;
+}
+
+void mem_budget_print(const mem_plan_t *p, FILE *out)
+{
+    fprintf(out, "Memory budget %.0f MiB: %d worker%s (%.1f MiB each), "
+            "ring %.2f s (%.1f MiB), %d burst copy slots (%.1f MiB each), "
+            "sample pool %.1f MiB, burst queue %u\n",
+            p->budget / MIB, p->workers, p->workers == 1 ? "" : "s",
+            (p->work_size * 24.0 + WORKER_EXTRA_BYTES) / MIB,
+            (double)p->ring_samples / p->sample_rate,
+            p->ring_samples * 8 / MIB,
+            p->copy_slots, p->burst_span * 8 / MIB,
+            p->sample_pool_bytes / MIB, p->burst_queue);
+}
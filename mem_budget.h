@@ -0,0 +1,76 @@
+/*
+ * Memory budget: size the pipeline's buffers from a byte budget
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Memory budget: size the pipeline's buffers from a byte budget
+ *
+ * The defaults are sized for a desktop: 64 MiB of sample buffers, a
+ * ring of at least two seconds, 48 MiB of work buffers per worker and
+ * burst copies allocated on demand. On a 1-2 GB board a backlog can push
+ * that past the OOM killer. --memory-budget=SIZE instead plans every large
+ * allocation up front:
+ *
+ *   sample pool      its size in bytes; the pool fits as many of the
+ *                    source's blocks as that holds
+ *   detector ring    down to one maximum burst span
+ *   burst copies     a fixed pool of span-sized slots; when it is empty
+ *                    a burst keeps its ring pin or is dropped
+ *   workers          count, each with work buffers of one burst span
+ *   burst_queue      depth in proportion to the ring
+ *
+ * Everything the plan covers comes from a fixed pool, so the budget
+ * holds under any backlog. The fixed MEM_BASE_BYTES allowance is all
+ * that covers the rest of the process: code, FFTW plans, and also the
+ * per-frame jobs, output items and sink queues, which are allocated as
+ * frames arrive and are not bounded by the plan. A budget too small for
+ * one worker and a minimal ring at the chosen sample rate is rejected.
+ */
+
+#ifndef __MEM_BUDGET_H__
+#define __MEM_BUDGET_H__
+
+#include <stddef.h>
+#include <stdio.h>
+
+/* Block size the minimal plan's sample pool assumes: 32768 cf32
+ * samples from a file, or one HackRF transfer. A source with larger
+ * blocks fits fewer in the planned bytes, and fails to start if fewer
+ * than SAMPLE_POOL_MIN_BUFFERS fit. */
+#define MEM_SAMPLE_BLOCK_BYTES  (256 * 1024)
+
+/* Allowance for everything outside the plan */
+#define MEM_BASE_BYTES          (48UL * 1024 * 1024)
+
+typedef struct {
+    /* Inputs */
+    size_t budget;          /* bytes */
+    int sample_rate;
+    size_t burst_span;      /* samples; burst_detector_max_span() */
+    int max_workers;        /* --workers, or the CPU default */
+
+    /* Plan */
+    size_t sample_pool_bytes;
+    unsigned burst_queue;
+    size_t ring_samples;
+    int copy_slots;
+    int work_size;          /* samples per downmix work buffer */
+    int workers;
+    size_t minimum;         /* smallest budget that works, in bytes */
+} mem_plan_t;
+
+/* Parse SIZE as bytes with an optional K, M or G suffix (powers of
+ * 1024), e.g. 768M or 1.5G. Returns 0 or -1. */
+int mem_budget_parse(const char *s, size_t *bytes);
+
+/* Fill in the plan from the inputs. Returns -1 if the budget is below
+ * plan->minimum. */
+int mem_budget_plan(mem_plan_t *plan);
+
+/* One line describing the plan */
+void mem_budget_print(const mem_plan_t *plan, FILE *out);
+
+#endif
@@ -29,6 +29,14 @@
 #include "soapysdr.h"
 #endif
 
+#include "iridium.h"
+#include "frame_output.h"
+#include "output_sink.h"
+#include "logging.h"
+#include "thread_place.h"
+#include "task_pool.h"
+#include "mem_budget.h"
+
 typedef enum {
     FMT_CI8 = 0,
     FMT_CI16,
@@ -78,10 +86,22 @@ extern int gsmtap_port;
 extern int diagnostic_mode;
 extern int use_gardner;
 extern int parsed_mode;
+extern int no_raw;
+extern int simplex_only;
+extern int output_format;
+extern int flush_policy;
+extern int flush_param;
 extern int position_enabled;
 extern double position_height;
 extern int acars_enabled;
 extern int acars_json;
+extern int acars_dedup_sec;
+extern int acars_threads;
+extern int n_workers;
+extern size_t memory_budget;
+extern char *control_path;
+extern char *log_file;
+extern int generate_wisdom;
 extern char *station_id;
 #define ACARS_UDP_MAX 4
 extern char *acars_udp_hosts[ACARS_UDP_MAX];
@@ -93,6 +113,11 @@ extern char *feed_tcp_host;
 extern int feed_tcp_port;
 extern int zmq_enabled;
 extern char *zmq_endpoint;
+extern int zmq_topic_prefix;
+extern int shm_enabled;
+extern char *shm_name;
+extern char *store_dir;
+extern int store_segment_sec;
 
 static void usage(int exitcode) {
     fprintf(stderr,
@@ -130,10 +155,24 @@ static void usage(int exitcode) {
 #endif
 "    --no-simd               disable SIMD acceleration (use scalar kernels)\n"
 "\n"
+"Threads:\n"
+"    --workers=N             downmix/demod/decode worker threads (default:\n"
+"                             online CPUs - 1, max 64)\n"
+"    --cpu-affinity=ROLE=CPUS  pin a thread role to CPUs, e.g. detector=2 or\n"
+"                             worker=4-7 (repeatable; roles: sdr, detector,\n"
+"                             worker, stats, output)\n"
+"    --realtime[=PRIO]       SCHED_FIFO for the SDR reader (PRIO) and the\n"
+"                             detector (PRIO-1) (default: 50)\n"
+"    --memory-budget=SIZE    size queues, ring, worker count and buffers to\n"
+"                             fit SIZE (e.g. 768M, 1.5G); with --workers,\n"
+"                             that is the most workers used\n"
+"\n"
 "Web map:\n"
 "    --web[=PORT]            enable live web map (default port: 8888)\n"
 "    --position[=HEIGHT_M]   estimate receiver position from Doppler shift\n"
 "                             optional height aiding in meters (implies --web)\n"
+"    --simplex-only          only process the simplex band (ring alerts);\n"
+"                             skips duplex bursts, IBC and IDA decoding\n"
 "\n"
 "GSMTAP:\n"
 "    --gsmtap[=HOST:PORT]    send IDA frames as GSMTAP/LAPDm via UDP\n"
@@ -145,6 +184,19 @@ static void usage(int exitcode) {
 "    --diagnostic            setup verification mode (suppresses RAW output)\n"
 "    --no-gardner           disable Gardner timing recovery (enabled by default)\n"
 "    --parsed               output parsed IDA lines (pipe to reassembler.py)\n"
+"    --no-raw               do not write RAW frames to stdout\n"
+"    --output-format=FMT    stdout frame format: raw (default) or bin\n"
+"                             (convert bin back with iridium-bin2raw)\n"
+"    --flush=MODE           stdout flush policy: line, bytes[:N], time[:MS]\n"
+"                             (default: line on a terminal, else time:100;\n"
+"                             N at most 1048576; SIGUSR1 forces a flush)\n"
+"    --sink-policy=NAME:POL queue overflow policy per output sink (repeatable)\n"
+"                             sinks: frames, gsmtap, acars, web, position,\n"
+"                             shm, store\n"
+"                             POL: block, drop-newest, drop-oldest\n"
+"    --filter=[SINK:]EXPR   only pass matching frames to all sinks or one sink\n"
+"                             (once per sink), e.g. type=ira,beam=12 or\n"
+"                             gsmtap:type=ida,crc=ok,conf>=80\n"
 "    --acars               decode and display ACARS messages from IDA\n"
 "    --acars-json          output ACARS as JSON (compatible with acars.py)\n"
 "    --acars-udp=HOST:PORT stream ACARS JSON via UDP (repeatable, max 4)\n"
@@ -153,13 +205,35 @@ static void usage(int exitcode) {
 "                             tcp://HOST:PORT for airframes.io direct\n"
 "                             bare --feed defaults to tcp://feed.airframes.io:5590\n"
 "    --station=ID          station identifier for ACARS JSON output\n"
+"    --acars-dedup=SEC     drop repeated ACARS messages seen within SEC\n"
+"                             seconds (default: 30, 0 = off)\n"
+"    --acars-threads=N     ACARS decode worker threads, 0 = decode inline\n"
+"                             (default: 2 with libacars, else 0; max 8)\n"
 #ifdef HAVE_ZMQ
 "    --zmq[=ENDPOINT]     publish output via ZMQ PUB socket for multi-consumer\n"
 "                             (default: tcp://*:7006, compatible with iridium-toolkit)\n"
+"    --zmq-topics         send [topic][line] messages (topics RAW.DL, RAW.UL,\n"
+"                             IDA) so subscribers can filter server-side\n"
 #endif
+"    --shm[=NAME]         publish binary frames to a shared-memory ring for\n"
+"                             local readers (default: /iridium-sniffer)\n"
+"    --store=DIR          archive frames in indexed segment files under DIR\n"
+"                             (query with iridium-store-query)\n"
+"    --store-segment=SEC  seconds of frames per segment file (default: 60)\n"
 "    -v, --verbose           verbose output to stderr\n"
+"    --log=CAT=LEVEL[,...]  diagnostic level per category (all, main, sdr,\n"
+"                             detect, downmix, demod, doppler, acars;\n"
+"                             off, error, warn, info, debug; default: warn,\n"
+"                             debug with -v)\n"
+"    --log-rate=N         diagnostic messages/s per category before\n"
+"                             suppression (default: 100, 0 = unlimited)\n"
+"    --log-file=PATH      write diagnostics to PATH instead of stderr\n"
+"    --control=PATH       accept runtime commands on a Unix socket at PATH\n"
+"                             (try: echo help | socat - UNIX-CONNECT:PATH)\n"
 "    -h, --help              show this help\n"
 "    --list                  list available SDR interfaces\n"
+"    --generate-wisdom       plan every FFT size for -r in parallel, save\n"
+"                             ~/.iridium-sniffer-fftw-wisdom and exit\n"
 "\n"
 "The output format is compatible with iridium-toolkit. Pipe to iridium-parser.py:\n"
 "    iridium-sniffer -l | python3 iridium-toolkit/iridium-parser.py\n"
@@ -213,8 +287,29 @@ void parse_options(int argc, char **argv) {
         OPT_ACARS_UDP,
         OPT_FEED,
         OPT_STATION,
+        OPT_ACARS_DEDUP,
+        OPT_ACARS_THREADS,
         OPT_SOAPY_SETTING,
         OPT_ZMQ,
+        OPT_SHM,
+        OPT_STORE,
+        OPT_STORE_SEGMENT,
+        OPT_NO_RAW,
+        OPT_SIMPLEX_ONLY,
+        OPT_FLUSH,
+        OPT_OUTPUT_FORMAT,
+        OPT_ZMQ_TOPICS,
+        OPT_SINK_POLICY,
+        OPT_FILTER,
+        OPT_LOG,
+        OPT_LOG_RATE,
+        OPT_CPU_AFFINITY,
+        OPT_REALTIME,
+        OPT_WORKERS,
+        OPT_MEMORY_BUDGET,
+        OPT_LOG_FILE,
+        OPT_CONTROL,
+        OPT_GENERATE_WISDOM,
     };
 
     static const struct option longopts[] = {
@@ -228,6 +323,8 @@ void parse_options(int argc, char **argv) {
         { "file-info",      required_argument, NULL, OPT_FILE_INFO },
         { "format",         required_argument, NULL, OPT_FORMAT },
         { "verbose",        no_argument,       NULL, 'v' },
+        { "log",            required_argument, NULL, OPT_LOG },
+        { "log-rate",       required_argument, NULL, OPT_LOG_RATE },
         { "help",           no_argument,       NULL, 'h' },
         { "list",           no_argument,       NULL, OPT_LIST },
         { "hackrf-lna",     required_argument, NULL, OPT_HACKRF_LNA },
@@ -238,6 +335,13 @@ void parse_options(int argc, char **argv) {
         { "soapy-gain",     required_argument, NULL, OPT_SOAPY_GAIN },
         { "no-gpu",         no_argument,       NULL, OPT_NO_GPU },
         { "no-simd",        no_argument,       NULL, OPT_NO_SIMD },
+        { "cpu-affinity",   required_argument, NULL, OPT_CPU_AFFINITY },
+        { "realtime",       optional_argument, NULL, OPT_REALTIME },
+        { "workers",        required_argument, NULL, OPT_WORKERS },
+        { "memory-budget",  required_argument, NULL, OPT_MEMORY_BUDGET },
+        { "log-file",       required_argument, NULL, OPT_LOG_FILE },
+        { "control",        required_argument, NULL, OPT_CONTROL },
+        { "generate-wisdom", no_argument,      NULL, OPT_GENERATE_WISDOM },
         { "web",            optional_argument, NULL, OPT_WEB },
         { "gsmtap",         optional_argument, NULL, OPT_GSMTAP },
         { "save-bursts",    required_argument, NULL, OPT_SAVE_BURSTS },
@@ -251,8 +355,20 @@ void parse_options(int argc, char **argv) {
         { "acars-udp",      required_argument, NULL, OPT_ACARS_UDP },
         { "feed",           optional_argument, NULL, OPT_FEED },
         { "station",        required_argument, NULL, OPT_STATION },
+        { "acars-dedup",    required_argument, NULL, OPT_ACARS_DEDUP },
+        { "acars-threads",  required_argument, NULL, OPT_ACARS_THREADS },
         { "soapy-setting",  required_argument, NULL, OPT_SOAPY_SETTING },
         { "zmq",            optional_argument, NULL, OPT_ZMQ },
+        { "shm",            optional_argument, NULL, OPT_SHM },
+        { "store",          required_argument, NULL, OPT_STORE },
+        { "store-segment",  required_argument, NULL, OPT_STORE_SEGMENT },
+        { "no-raw",         no_argument,       NULL, OPT_NO_RAW },
+        { "simplex-only",   no_argument,       NULL, OPT_SIMPLEX_ONLY },
+        { "flush",          required_argument, NULL, OPT_FLUSH },
+        { "output-format",  required_argument, NULL, OPT_OUTPUT_FORMAT },
+        { "zmq-topics",     no_argument,       NULL, OPT_ZMQ_TOPICS },
+        { "sink-policy",    required_argument, NULL, OPT_SINK_POLICY },
+        { "filter",         required_argument, NULL, OPT_FILTER },
         { NULL,             0,                 NULL, 0 }
     };
 
@@ -321,6 +437,37 @@ void parse_options(int argc, char **argv) {
                 verbose = 1;
                 break;
 
+            case OPT_LOG:
+                if (log_parse_levels(optarg) != 0)
+                    errx(1, "Invalid --log '%s'. Use CAT=LEVEL[,...] with CAT "
+                         "all, main, sdr, detect, downmix, demod, doppler or "
+                         "acars and LEVEL off, error, warn, info or debug.",
+                         optarg);
+                break;
+
+            case OPT_LOG_RATE: {
+                int rate = atoi(optarg);
+                if (rate < 0 || rate > 100000)
+                    errx(1, "Invalid --log-rate '%s'. Use 0-100000 "
+                         "messages/s.", optarg);
+                log_set_rate(rate);
+                break;
+            }
+
+            case OPT_LOG_FILE:
+                log_file = strdup(optarg);
+                break;
+
+            case OPT_GENERATE_WISDOM:
+                generate_wisdom = 1;
+                break;
+
+            case OPT_CONTROL:
+                if (strlen(optarg) >= 108)
+                    errx(1, "--control path too long (max 107 characters)");
+                control_path = strdup(optarg);
+                break;
+
             case OPT_FILE_INFO:
                 file_info = strdup(optarg);
                 break;
@@ -349,6 +496,31 @@ void parse_options(int argc, char **argv) {
             case OPT_SOAPY_GAIN:  soapy_gain_val   = atof(optarg); break;
             case OPT_NO_GPU:      use_gpu = 0;                       break;
             case OPT_NO_SIMD:     no_simd = 1;                       break;
+            case OPT_CPU_AFFINITY:
+                if (thread_place_parse(optarg) != 0)
+                    errx(1, "Invalid --cpu-affinity '%s'. Use ROLE=CPUS with "
+                         "ROLE sdr, detector, worker, stats or output "
+                         "and CPUS like 2 or 0-3,8.", optarg);
+                break;
+            case OPT_WORKERS:
+                n_workers = atoi(optarg);
+                if (n_workers < 1 || n_workers > TASK_POOL_MAX_WORKERS)
+                    errx(1, "Invalid --workers '%s'. Use 1-%d.", optarg,
+                         TASK_POOL_MAX_WORKERS);
+                break;
+            case OPT_MEMORY_BUDGET:
+                if (mem_budget_parse(optarg, &memory_budget) != 0)
+                    errx(1, "Invalid --memory-budget '%s'. Use a size like "
+                         "768M or 1.5G.", optarg);
+                break;
+            case OPT_REALTIME: {
+                int prio = optarg ? atoi(optarg) : THREAD_PLACE_DEFAULT_PRIO;
+                if (prio < 2 || prio > 99)
+                    errx(1, "Invalid --realtime priority '%s'. Use 2-99.",
+                         optarg);
+                thread_place_set_realtime(prio);
+                break;
+            }
             case OPT_WEB:
                 web_enabled = 1;
                 if (optarg) web_port = atoi(optarg);
@@ -388,6 +560,62 @@ void parse_options(int argc, char **argv) {
                 parsed_mode = 1;
                 break;
 
+            case OPT_NO_RAW:
+                no_raw = 1;
+                break;
+
+            case OPT_SIMPLEX_ONLY:
+                simplex_only = 1;
+                break;
+
+            case OPT_SINK_POLICY:
+                if (output_sink_parse_policy(optarg) != 0)
+                    errx(1, "Invalid --sink-policy '%s'. Use NAME:POLICY with "
+                         "POLICY block, drop-newest or drop-oldest.", optarg);
+                break;
+
+            case OPT_FILTER: {
+                char err[128];
+                if (output_sink_parse_filter(optarg, err, sizeof(err)) != 0)
+                    errx(1, "Invalid --filter '%s': %s", optarg, err);
+                break;
+            }
+
+            case OPT_OUTPUT_FORMAT:
+                if (strcmp(optarg, "raw") == 0)
+                    output_format = OUTPUT_FMT_RAW;
+                else if (strcmp(optarg, "bin") == 0)
+                    output_format = OUTPUT_FMT_BIN;
+                else
+                    errx(1, "Unknown output format '%s'. Use raw or bin.", optarg);
+                break;
+
+            case OPT_FLUSH: {
+                char *colon = strchr(optarg, ':');
+                if (colon)
+                    *colon = '\0';
+                if (strcmp(optarg, "line") == 0)
+                    flush_policy = FLUSH_LINE;
+                else if (strcmp(optarg, "bytes") == 0)
+                    flush_policy = FLUSH_BYTES;
+                else if (strcmp(optarg, "time") == 0)
+                    flush_policy = FLUSH_TIME;
+                else
+                    errx(1, "Unknown flush policy '%s'. Use line, "
+                         "bytes[:N] or time[:MS].", optarg);
+                flush_param = 0;
+                if (colon) {
+                    flush_param = atoi(colon + 1);
+                    if (flush_policy == FLUSH_LINE || flush_param <= 0)
+                        errx(1, "Invalid --flush parameter: %s", colon + 1);
+                    if (flush_policy == FLUSH_BYTES &&
+                        flush_param > FLUSH_MAX_BYTES)
+                        errx(1, "Invalid --flush parameter: %s. Use at most "
+                             "%d bytes.", colon + 1, FLUSH_MAX_BYTES);
+                }
+                break;
+            }
+
             case OPT_POSITION:
                 position_enabled = 1;
                 web_enabled = 1;  /* position implies web map */
@@ -468,6 +696,19 @@ void parse_options(int argc, char **argv) {
                 station_id = strdup(optarg);
                 break;
 
+            case OPT_ACARS_DEDUP:
+                acars_dedup_sec = atoi(optarg);
+                if (acars_dedup_sec < 0 || acars_dedup_sec > 3600)
+                    errx(1, "Invalid --acars-dedup '%s'. Use 0-3600 seconds.",
+                         optarg);
+                break;
+
+            case OPT_ACARS_THREADS:
+                acars_threads = atoi(optarg);
+                if (acars_threads < 0 || acars_threads > 8)
+                    errx(1, "Invalid --acars-threads '%s'. Use 0-8.", optarg);
+                break;
+
             case OPT_ZMQ:
 #ifdef HAVE_ZMQ
                 zmq_enabled = 1;
@@ -478,6 +719,34 @@ void parse_options(int argc, char **argv) {
 #endif
                 break;
 
+            case OPT_SHM:
+                shm_enabled = 1;
+                if (optarg) {
+                    if (optarg[0] != '/' || strchr(optarg + 1, '/'))
+                        errx(1, "Invalid --shm name '%s'. Use /NAME.", optarg);
+                    shm_name = strdup(optarg);
+                }
+                break;
+
+            case OPT_STORE:
+                store_dir = strdup(optarg);
+                break;
+
+            case OPT_STORE_SEGMENT:
+                store_segment_sec = atoi(optarg);
+                if (store_segment_sec < 1 || store_segment_sec > 86400)
+                    errx(1, "Invalid --store-segment '%s'. Use 1-86400 seconds.",
+                         optarg);
+                break;
+
+            case OPT_ZMQ_TOPICS:
+#ifdef HAVE_ZMQ
+                zmq_topic_prefix = 1;
+#else
+                errx(1, "--zmq-topics requires ZMQ support (install libzmq3-dev and rebuild)");
+#endif
+                break;
+
             case OPT_SOAPY_SETTING:
 #ifdef HAVE_SOAPYSDR
                 if (soapy_setting_count >= SOAPY_SETTINGS_MAX)
@@ -523,7 +792,7 @@ void parse_options(int argc, char **argv) {
     )
         live = 1;
 
-    if (!live && in_file == NULL)
+    if (!live && in_file == NULL && !generate_wisdom)
         usage(1);
 
     if (live && in_file != NULL)
@@ -548,4 +817,19 @@ void parse_options(int argc, char **argv) {
 
     if (center_freq <= 0)
         errx(1, "Invalid center frequency: %.0f", center_freq);
+
+    if (zmq_topic_prefix && !zmq_enabled)
+        errx(1, "--zmq-topics requires --zmq");
+
+    if (output_format == OUTPUT_FMT_BIN && parsed_mode)
+        errx(1, "--output-format=bin cannot be combined with --parsed");
+
+    if (simplex_only) {
+        if (parsed_mode || gsmtap_enabled || acars_enabled)
+            errx(1, "--simplex-only carries ring alerts only; it cannot be "
+                 "combined with --parsed, --gsmtap or --acars");
+        if (center_freq + samp_rate / 2 <= IR_SIMPLEX_FREQUENCY_MIN)
+            errx(1, "--simplex-only: simplex band (>= %.1f MHz) is outside "
+                 "the captured bandwidth", IR_SIMPLEX_FREQUENCY_MIN / 1e6);
+    }
 }
@@ -0,0 +1,294 @@
+/*
+ * Output filter expressions
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Output filter expressions -- compiler and per-frame evaluator
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "output_filter.h"
+
+#define FILTER_MAX_TERMS  16
+#define FILTER_MAX_VALUES 8
+
+typedef enum {
+    F_TYPE, F_DIR, F_FREQ, F_CONF, F_LEVEL, F_MAG, F_CRC, F_SAT, F_BEAM,
+} filter_field_t;
+
+typedef enum {
+    OP_EQ, OP_NE, OP_LT, OP_LE, OP_GT, OP_GE,
+} filter_op_t;
+
+/* Symbolic values, compared as numbers (types are frame_class_t) */
+enum { CRC_BAD, CRC_OK };
+
+typedef struct {
+    filter_field_t field;
+    filter_op_t op;
+    int n_values;
+    double lo[FILTER_MAX_VALUES];   /* lo == hi unless a range */
+    double hi[FILTER_MAX_VALUES];
+} filter_term_t;
+
+struct output_filter {
+    int n_terms;
+    filter_term_t terms[FILTER_MAX_TERMS];
+};
+
+static const struct {
+    const char *name;
+    filter_field_t field;
+    int symbolic;
+    unsigned needs;
+} fields[] = {
+    { "type",  F_TYPE,  1, FILTER_NEEDS_IDA | FILTER_NEEDS_FRAMES },
+    { "dir",   F_DIR,   1, 0 },
+    { "freq",  F_FREQ,  0, 0 },
+    { "conf",  F_CONF,  0, 0 },
+    { "level", F_LEVEL, 0, 0 },
+    { "mag",   F_MAG,   0, 0 },
+    { "crc",   F_CRC,   1, FILTER_NEEDS_IDA },
+    { "sat",   F_SAT,   0, FILTER_NEEDS_FRAMES },
+    { "beam",  F_BEAM,  0, FILTER_NEEDS_FRAMES },
+};
+#define N_FIELDS ((int)(sizeof(fields) / sizeof(fields[0])))
+
+/* ---- Compiler ---- */
+
+static int parse_symbol(filter_field_t field, const char *s, double *out)
+{
+    static const struct { filter_field_t field; const char *name; int v; } syms[] = {
+        { F_TYPE, "ira", FRAME_CLASS_IRA },  { F_TYPE, "ibc", FRAME_CLASS_IBC },
+        { F_TYPE, "ida", FRAME_CLASS_IDA },  { F_TYPE, "other", FRAME_CLASS_OTHER },
+        { F_DIR, "dl", DIR_DOWNLINK }, { F_DIR, "ul", DIR_UPLINK },
+        { F_CRC, "ok", CRC_OK },   { F_CRC, "bad", CRC_BAD },
+    };
+    for (size_t i = 0; i < sizeof(syms) / sizeof(syms[0]); i++) {
+        if (syms[i].field == field && strcmp(syms[i].name, s) == 0) {
+            *out = syms[i].v;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static int parse_number(const char *s, double *out)
+{
+    char *end;
+    *out = strtod(s, &end);
+    return (end == s || *end != '\0') ? -1 : 0;
+}
+
+/* Parse one VALUE or LO-HI. A leading '-' is a sign, not a range. */
+static int parse_value(int symbolic, filter_field_t field, char *s,
+                       double *lo, double *hi)
+{
+    if (symbolic) {
+        if (parse_symbol(field, s, lo) != 0)
+            return -1;
+        *hi = *lo;
+        return 0;
+    }
+
+    char *dash = strchr(s + 1, '-');
+    if (dash && dash[-1] != 'e' && dash[-1] != 'E') {
+        *dash = '\0';
+        if (parse_number(s, lo) != 0 || parse_number(dash + 1, hi) != 0)
+            return -1;
+        return *lo <= *hi ? 0 : -1;
+    }
+    if (parse_number(s, lo) != 0)
+        return -1;
+    *hi = *lo;
+    return 0;
+}
+
+static int compile_term(char *term, filter_term_t *t,
+                        char *err, size_t err_size)
+{
+    /* Field name runs up to the operator */
+    size_t nlen = strcspn(term, "=!<>");
+    if (nlen == 0 || term[nlen] == '\0') {
+        snprintf(err, err_size, "expected FIELD OP VALUE in '%s'", term);
+        return -1;
+    }
+
+    int fi;
+    for (fi = 0; fi < N_FIELDS; fi++)
+        if (strlen(fields[fi].name) == nlen &&
+            strncmp(fields[fi].name, term, nlen) == 0)
+            break;
+    if (fi == N_FIELDS) {
+        snprintf(err, err_size, "unknown field '%.*s'", (int)nlen, term);
+        return -1;
+    }
+    t->field = fields[fi].field;
+
+    char *op = term + nlen;
+    char *val;
+    if (strncmp(op, "!=", 2) == 0)      { t->op = OP_NE; val = op + 2; }
+    else if (strncmp(op, "<=", 2) == 0) { t->op = OP_LE; val = op + 2; }
+    else if (strncmp(op, ">=", 2) == 0) { t->op = OP_GE; val = op + 2; }
+    else if (*op == '<')                { t->op = OP_LT; val = op + 1; }
+    else if (*op == '>')                { t->op = OP_GT; val = op + 1; }
+    else if (*op == '=')                { t->op = OP_EQ; val = op + 1; }
+    else {
+        snprintf(err, err_size, "bad operator in '%s'", term);
+        return -1;
+    }
+
+    int ordered = t->op != OP_EQ && t->op != OP_NE;
+    if (ordered && fields[fi].symbolic) {
+        snprintf(err, err_size, "'%s' only supports = and !=", fields[fi].name);
+        return -1;
+    }
+
+    t->n_values = 0;
+    char *save = NULL;
+    for (char *v = strtok_r(val, "|", &save); v; v = strtok_r(NULL, "|", &save)) {
+        if (t->n_values == FILTER_MAX_VALUES || (ordered && t->n_values == 1)) {
+            snprintf(err, err_size, "too many values for '%s'", fields[fi].name);
+            return -1;
+        }
+        char shown[32];
+        snprintf(shown, sizeof(shown), "%s", v);
+        if (parse_value(fields[fi].symbolic, t->field, v,
+                        &t->lo[t->n_values], &t->hi[t->n_values]) != 0 ||
+            (ordered && t->lo[t->n_values] != t->hi[t->n_values])) {
+            snprintf(err, err_size, "bad value '%s' for '%s'", shown,
+                     fields[fi].name);
+            return -1;
+        }
+        /* Frequencies are written in MHz */
+        if (t->field == F_FREQ) {
+            t->lo[t->n_values] *= 1e6;
+            t->hi[t->n_values] *= 1e6;
+        }
+        t->n_values++;
+    }
+    if (t->n_values == 0) {
+        snprintf(err, err_size, "missing value for '%s'", fields[fi].name);
+        return -1;
+    }
+    return 0;
+}
+
+output_filter_t *output_filter_compile(const char *expr, char *err,
+                                       size_t err_size)
+{
+    output_filter_t *f = calloc(1, sizeof(*f));
+    char *copy = strdup(expr);
+    char *save = NULL;
+
+    for (char *term = strtok_r(copy, ",", &save); term;
+         term = strtok_r(NULL, ",", &save)) {
+        if (f->n_terms == FILTER_MAX_TERMS) {
+            snprintf(err, err_size, "more than %d terms", FILTER_MAX_TERMS);
+            goto fail;
+        }
+        if (compile_term(term, &f->terms[f->n_terms], err, err_size) != 0)
+            goto fail;
+        f->n_terms++;
+    }
+
+    if (f->n_terms == 0) {
+        snprintf(err, err_size, "empty filter");
+        goto fail;
+    }
+    free(copy);
+    return f;
+
+fail:
+    free(copy);
+    free(f);
+    return NULL;
+}
+
+/* ---- Evaluation ---- */
+
+/* Look up a field. Returns 0 if the frame does not have it (e.g. beam of
+ * an IDA frame), which fails the term whatever the operator. */
+static int field_value(filter_field_t field, const output_item_t *item,
+                       double *out)
+{
+    const demod_frame_t *d = item->demod;
+    const decoded_frame_t *dec = &item->decoded;
+
+    switch (field) {
+    case F_TYPE:
+        *out = output_item_class(item);
+        return 1;
+    case F_DIR:   *out = d->direction;        return 1;
+    case F_FREQ:  *out = d->center_frequency; return 1;
+    case F_CONF:  *out = d->confidence;       return 1;
+    case F_LEVEL: *out = d->level;            return 1;
+    case F_MAG:   *out = d->magnitude;        return 1;
+    case F_CRC:
+        if (!item->ida_ok)
+            return 0;
+        *out = item->ida.crc_ok ? CRC_OK : CRC_BAD;
+        return 1;
+    case F_SAT:
+    case F_BEAM:
+        if (!item->decoded_ok)
+            return 0;
+        if (dec->type == FRAME_IRA)
+            *out = field == F_SAT ? dec->ira.sat_id : dec->ira.beam_id;
+        else if (dec->type == FRAME_IBC)
+            *out = field == F_SAT ? dec->ibc.sat_id : dec->ibc.beam_id;
+        else
+            return 0;
+        return 1;
+    }
+    return 0;
+}
+
+int output_filter_match(const output_filter_t *f, const output_item_t *item)
+{
+    for (int i = 0; i < f->n_terms; i++) {
+        const filter_term_t *t = &f->terms[i];
+        double v;
+        if (!field_value(t->field, item, &v))
+            return 0;
+
+        int hit;
+        switch (t->op) {
+        case OP_LT: hit = v <  t->lo[0]; break;
+        case OP_LE: hit = v <= t->lo[0]; break;
+        case OP_GT: hit = v >  t->lo[0]; break;
+        case OP_GE: hit = v >= t->lo[0]; break;
+        default:
+            hit = 0;
+            for (int k = 0; k < t->n_values && !hit; k++)
+                hit = v >= t->lo[k] && v <= t->hi[k];
+            if (t->op == OP_NE)
+                hit = !hit;
+            break;
+        }
+        if (!hit)
+            return 0;
+    }
+    return 1;
+}
+
+unsigned output_filter_needs(const output_filter_t *f)
+{
+    unsigned needs = 0;
+    for (int i = 0; i < f->n_terms; i++)
+        for (int k = 0; k < N_FIELDS; k++)
+            if (fields[k].field == f->terms[i].field)
+                needs |= fields[k].needs;
+    return needs;
+}
+
+void output_filter_free(output_filter_t *f)
+{
+    free(f);
+}
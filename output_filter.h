@@ -0,0 +1,65 @@
+/*
+ * Output filter expressions
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Output filter expressions
+ *
+ * A filter is a comma-separated list of terms that must all match:
+ *
+ *   FIELD=VALUE[|VALUE...]    any of the values
+ *   FIELD!=VALUE[|VALUE...]   none of the values
+ *   FIELD<N  FIELD<=N  FIELD>N  FIELD>=N
+ *   FIELD=LO-HI               inclusive range (numeric fields)
+ *
+ * Fields:
+ *   type    ira, ibc, ida, other
+ *   dir     dl, ul
+ *   freq    center frequency in MHz
+ *   conf    demod confidence, 0-100
+ *   level   average signal amplitude
+ *   mag     burst magnitude, dB
+ *   crc     ok, bad (IDA frames only)
+ *   sat     satellite ID (IRA/IBC only)
+ *   beam    beam ID (IRA/IBC only)
+ *
+ * Examples:
+ *   type=ira,beam=12|13
+ *   type=ida,crc=ok,conf>=80
+ *   dir=dl,freq=1626.0-1626.5
+ *
+ * Filters are compiled at startup, and may be replaced at runtime from
+ * the control socket. They are evaluated before an item is queued to a
+ * sink, so rejected frames are never formatted or sent.
+ */
+
+#ifndef __OUTPUT_FILTER_H__
+#define __OUTPUT_FILTER_H__
+
+#include <stddef.h>
+
+#include "output_sink.h"
+
+/* Decoder results a filter depends on */
+#define FILTER_NEEDS_IDA     0x1
+#define FILTER_NEEDS_FRAMES  0x2
+
+typedef struct output_filter output_filter_t;
+
+/* Compile expr. Returns NULL and writes a message to err on a syntax
+ * error. */
+output_filter_t *output_filter_compile(const char *expr, char *err,
+                                       size_t err_size);
+
+/* Non-zero if the item passes every term */
+int output_filter_match(const output_filter_t *f, const output_item_t *item);
+
+/* FILTER_NEEDS_* bits for the fields the filter uses */
+unsigned output_filter_needs(const output_filter_t *f);
+
+void output_filter_free(output_filter_t *f);
+
+#endif
@@ -0,0 +1,493 @@
+/*
+ * Asynchronous output sinks
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Asynchronous output sinks -- one bounded queue and worker per sink
+ */
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "output_sink.h"
+#include "output_filter.h"
+#include "thread_place.h"
+
+#include "blocking_queue.h"
+
+/* ---- Sink table ---- */
+
+typedef struct {
+    char name[16];
+    sink_policy_t policy;
+    sink_handler_t handler;
+    void *user;
+    Blocking_Queue queue;
+    pthread_t thread;
+    const output_filter_t *filter;      /* sink's own, or NULL */
+    atomic_int enabled;
+    atomic_ulong n_handled;
+    atomic_ulong n_dropped;
+    atomic_ulong n_filtered;
+} output_sink_t;
+
+static output_sink_t sinks[OUTPUT_SINK_MAX];
+static int n_sinks = 0;
+static int sinks_started = 0;
+
+/* Command-line policy overrides, applied at registration */
+static struct {
+    char name[16];
+    sink_policy_t policy;
+} overrides[OUTPUT_SINK_MAX];
+static int n_overrides = 0;
+
+/* Filters: one for all sinks, plus per-sink ones, each with its source
+ * text. Set from the command line, or replaced at runtime under
+ * filter_lock, which dispatch holds while it evaluates them. */
+static output_filter_t *global_filter = NULL;
+static char *global_filter_text = NULL;
+static struct {
+    char name[16];
+    output_filter_t *filter;
+    char *text;
+} sink_filters[OUTPUT_SINK_MAX];
+static int n_sink_filters = 0;
+static pthread_mutex_t filter_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static const char *policy_names[] = { "block", "drop-newest", "drop-oldest" };
+
+/* ---- Items ---- */
+
+output_item_t *output_item_new(demod_frame_t *demod)
+{
+    output_item_t *item = malloc(sizeof(*item));
+    if (!item)
+        return NULL;
+    item->demod = demod;
+    item->ida_ok = 0;
+    item->decoded_ok = 0;
+    atomic_init(&item->refs, 1);
+    return item;
+}
+
+static void output_item_release(output_item_t *item)
+{
+    if (atomic_fetch_sub(&item->refs, 1) != 1)
+        return;
+    free(item->demod->bits);
+    free(item->demod->llr);
+    free(item->demod);
+    free(item);
+}
+
+/* ---- Registration ---- */
+
+int output_sink_parse_policy(const char *spec)
+{
+    const char *colon = strchr(spec, ':');
+    if (!colon || colon == spec || (size_t)(colon - spec) >= sizeof(overrides[0].name))
+        return -1;
+    if (n_overrides >= OUTPUT_SINK_MAX)
+        return -1;
+
+    sink_policy_t policy;
+    if (strcmp(colon + 1, "block") == 0)
+        policy = SINK_BLOCK;
+    else if (strcmp(colon + 1, "drop-newest") == 0)
+        policy = SINK_DROP_NEWEST;
+    else if (strcmp(colon + 1, "drop-oldest") == 0)
+        policy = SINK_DROP_OLDEST;
+    else
+        return -1;
+
+    memcpy(overrides[n_overrides].name, spec, colon - spec);
+    overrides[n_overrides].name[colon - spec] = '\0';
+    overrides[n_overrides].policy = policy;
+    n_overrides++;
+    return 0;
+}
+
+/* Length of a "NAME:" prefix, 0 if there is none, -1 if malformed */
+static int filter_name_len(const char *spec, char *err, size_t err_size)
+{
+    /* "NAME:" prefix only if it looks like a sink name */
+    size_t nlen = strspn(spec, "abcdefghijklmnopqrstuvwxyz0123456789_-");
+    if (spec[nlen] != ':')
+        return 0;
+    if (nlen == 0 || nlen >= sizeof(sink_filters[0].name)) {
+        snprintf(err, err_size, "bad sink name");
+        return -1;
+    }
+    return (int)nlen;
+}
+
+/* The sink_filters entry for name, added if missing; NULL if full */
+static int sink_filter_slot(const char *name, size_t nlen)
+{
+    for (int i = 0; i < n_sink_filters; i++)
+        if (strlen(sink_filters[i].name) == nlen &&
+            strncmp(sink_filters[i].name, name, nlen) == 0)
+            return i;
+    if (n_sink_filters >= OUTPUT_SINK_MAX)
+        return -1;
+    memcpy(sink_filters[n_sink_filters].name, name, nlen);
+    sink_filters[n_sink_filters].name[nlen] = '\0';
+    sink_filters[n_sink_filters].filter = NULL;
+    sink_filters[n_sink_filters].text = NULL;
+    return n_sink_filters++;
+}
+
+int output_sink_parse_filter(const char *spec, char *err, size_t err_size)
+{
+    int nlen = filter_name_len(spec, err, err_size);
+    if (nlen < 0)
+        return -1;
+    const char *expr = nlen ? spec + nlen + 1 : spec;
+
+    /* One --filter per target; a second one is a typo, not a replacement */
+    int i = -1;
+    if (nlen == 0) {
+        if (global_filter) {
+            snprintf(err, err_size, "filter for all sinks given twice");
+            return -1;
+        }
+    } else {
+        i = sink_filter_slot(spec, nlen);
+        if (i < 0) {
+            snprintf(err, err_size, "too many sink filters");
+            return -1;
+        }
+        if (sink_filters[i].filter) {
+            snprintf(err, err_size, "filter for sink %s given twice",
+                     sink_filters[i].name);
+            return -1;
+        }
+    }
+
+    output_filter_t *f = output_filter_compile(expr, err, err_size);
+    if (!f)
+        return -1;
+
+    if (nlen == 0) {
+        global_filter = f;
+        global_filter_text = strdup(expr);
+    } else {
+        sink_filters[i].filter = f;
+        sink_filters[i].text = strdup(expr);
+    }
+    return 0;
+}
+
+int output_sink_set_filter(const char *spec, unsigned allowed_needs,
+                           char *err, size_t err_size)
+{
+    int nlen = filter_name_len(spec, err, err_size);
+    if (nlen < 0)
+        return -1;
+    const char *expr = nlen ? spec + nlen + 1 : spec;
+
+    output_sink_t *s = NULL;
+    for (int i = 0; nlen && i < n_sinks; i++)
+        if (strlen(sinks[i].name) == (size_t)nlen &&
+            strncmp(sinks[i].name, spec, nlen) == 0)
+            s = &sinks[i];
+    if (nlen && !s) {
+        snprintf(err, err_size, "no sink '%.*s'", nlen, spec);
+        return -1;
+    }
+
+    output_filter_t *f = NULL;
+    if (strcmp(expr, "none") != 0) {
+        f = output_filter_compile(expr, err, err_size);
+        if (!f)
+            return -1;
+        /* The decoders were chosen at startup */
+        if (output_filter_needs(f) & ~allowed_needs) {
+            snprintf(err, err_size, "filter needs decoder results this run "
+                     "does not produce; give it with --filter at startup");
+            output_filter_free(f);
+            return -1;
+        }
+    }
+    char *text = f ? strdup(expr) : NULL;
+
+    pthread_mutex_lock(&filter_lock);
+    output_filter_t *old;
+    char *old_text;
+    if (!s) {
+        old = global_filter;
+        old_text = global_filter_text;
+        global_filter = f;
+        global_filter_text = text;
+    } else {
+        int i = sink_filter_slot(spec, nlen);
+        if (i < 0) {
+            pthread_mutex_unlock(&filter_lock);
+            snprintf(err, err_size, "too many sink filters");
+            output_filter_free(f);
+            free(text);
+            return -1;
+        }
+        old = sink_filters[i].filter;
+        old_text = sink_filters[i].text;
+        sink_filters[i].filter = f;
+        sink_filters[i].text = text;
+        s->filter = f;
+    }
+    pthread_mutex_unlock(&filter_lock);
+
+    output_filter_free(old);
+    free(old_text);
+    return 0;
+}
+
+int output_sink_enable(const char *name, int on)
+{
+    for (int i = 0; i < n_sinks; i++) {
+        if (strcmp(sinks[i].name, name) == 0) {
+            atomic_store(&sinks[i].enabled, on);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+unsigned output_sink_filter_needs(void)
+{
+    unsigned needs = global_filter ? output_filter_needs(global_filter) : 0;
+    for (int i = 0; i < n_sink_filters; i++)
+        needs |= output_filter_needs(sink_filters[i].filter);
+    return needs;
+}
+
+int output_sink_register(const char *name, sink_policy_t policy,
+                         sink_handler_t handler, void *user)
+{
+    if (n_sinks >= OUTPUT_SINK_MAX || sinks_started)
+        return -1;
+
+    for (int i = 0; i < n_overrides && i < OUTPUT_SINK_MAX; i++)
+        if (strcmp(overrides[i].name, name) == 0)
+            policy = overrides[i].policy;
+
+    output_sink_t *s = &sinks[n_sinks++];
+    snprintf(s->name, sizeof(s->name), "%s", name);
+    s->policy = policy;
+    s->handler = handler;
+    s->user = user;
+    s->filter = NULL;
+    for (int i = 0; i < n_sink_filters && i < OUTPUT_SINK_MAX; i++)
+        if (strcmp(sink_filters[i].name, name) == 0)
+            s->filter = sink_filters[i].filter;
+    atomic_init(&s->enabled, 1);
+    atomic_init(&s->n_handled, 0);
+    atomic_init(&s->n_dropped, 0);
+    atomic_init(&s->n_filtered, 0);
+    blocking_queue_init(&s->queue, OUTPUT_SINK_QUEUE_SIZE);
+    return 0;
+}
+
+int output_sinks_count(void)
+{
+    return n_sinks;
+}
+
+/* ---- Workers ---- */
+
+static void *sink_thread(void *arg)
+{
+    output_sink_t *s = (output_sink_t *)arg;
+
+    while (1) {
+        output_item_t *item;
+        if (blocking_queue_take(&s->queue, &item) != 0 || !item)
+            break;
+        s->handler(item, s->user);
+        atomic_fetch_add(&s->n_handled, 1);
+        output_item_release(item);
+    }
+    return NULL;
+}
+
+/* Queued items, read under the queue's own lock */
+static unsigned queue_depth(Blocking_Queue *q)
+{
+    pthread_mutex_lock(&q->mutex);
+    unsigned n = q->queue_size;
+    pthread_mutex_unlock(&q->mutex);
+    return n;
+}
+
+/* Let a worker finish what is queued, then stop it. The NULL marker is
+ * queued behind every item, so the worker handles them all first. */
+static void stop_sink(output_sink_t *s)
+{
+    blocking_queue_put(&s->queue, NULL);
+    pthread_join(s->thread, NULL);
+    blocking_queue_close(&s->queue);
+}
+
+int output_sinks_start(void)
+{
+    for (int i = 0; i < n_sink_filters; i++) {
+        int found = 0;
+        for (int k = 0; k < n_sinks; k++)
+            if (strcmp(sinks[k].name, sink_filters[i].name) == 0)
+                found = 1;
+        if (!found)
+            fprintf(stderr, "WARNING: --filter for inactive sink '%s' ignored\n",
+                    sink_filters[i].name);
+    }
+
+    for (int i = 0; i < n_sinks; i++) {
+        int err = pthread_create(&sinks[i].thread, NULL, sink_thread,
+                                 &sinks[i]);
+        if (err != 0) {
+            fprintf(stderr, "output: cannot start sink '%s': %s\n",
+                    sinks[i].name, strerror(err));
+            while (--i >= 0)
+                stop_sink(&sinks[i]);
+            return -1;
+        }
+        char name[16];
+        snprintf(name, sizeof(name), "sink-%.10s", sinks[i].name);
+#ifdef __linux__
+        pthread_setname_np(sinks[i].thread, name);
+#endif
+        thread_place_apply(sinks[i].thread, ROLE_OUTPUT, name);
+    }
+    sinks_started = 1;
+    return 0;
+}
+
+/* ---- Dispatch ---- */
+
+static void sink_enqueue(output_sink_t *s, output_item_t *item)
+{
+    switch (s->policy) {
+    case SINK_BLOCK:
+        if (blocking_queue_put(&s->queue, item) == 0)
+            return;
+        break;
+
+    case SINK_DROP_NEWEST:
+        if (blocking_queue_add(&s->queue, item) == 0)
+            return;
+        break;
+
+    case SINK_DROP_OLDEST:
+        /* A few attempts: the worker may race us for the oldest item */
+        for (int tries = 0; tries < 4; tries++) {
+            if (blocking_queue_add(&s->queue, item) == 0)
+                return;
+            output_item_t *oldest;
+            if (blocking_queue_poll(&s->queue, &oldest) == 0) {
+                atomic_fetch_add(&s->n_dropped, 1);
+                output_item_release(oldest);
+            }
+        }
+        break;
+    }
+
+    atomic_fetch_add(&s->n_dropped, 1);
+    output_item_release(item);
+}
+
+void output_sinks_dispatch(output_item_t *item)
+{
+    /* Filters run before anything is queued, so rejected frames are
+     * never formatted or sent */
+    pthread_mutex_lock(&filter_lock);
+    if (global_filter && !output_filter_match(global_filter, item)) {
+        pthread_mutex_unlock(&filter_lock);
+        output_item_release(item);
+        return;
+    }
+
+    int accept[OUTPUT_SINK_MAX];
+    int n_accept = 0;
+    for (int i = 0; i < n_sinks; i++) {
+        if (!atomic_load_explicit(&sinks[i].enabled, memory_order_relaxed)) {
+            accept[i] = 0;
+            continue;
+        }
+        accept[i] = !sinks[i].filter || output_filter_match(sinks[i].filter, item);
+        if (accept[i])
+            n_accept++;
+        else
+            atomic_fetch_add(&sinks[i].n_filtered, 1);
+    }
+    pthread_mutex_unlock(&filter_lock);
+
+    /* One reference per accepting sink on top of the caller's */
+    atomic_fetch_add(&item->refs, n_accept);
+    for (int i = 0; i < n_sinks; i++)
+        if (accept[i])
+            sink_enqueue(&sinks[i], item);
+    output_item_release(item);
+}
+
+/* ---- Shutdown ---- */
+
+void output_sinks_shutdown(void)
+{
+    if (!sinks_started)
+        return;
+
+    for (int i = 0; i < n_sinks; i++) {
+        /* Closed queues refuse takes, so drain before closing */
+        stop_sink(&sinks[i]);
+        blocking_queue_destroy(&sinks[i].queue);
+    }
+    sinks_started = 0;
+
+    output_filter_free(global_filter);
+    free(global_filter_text);
+    global_filter = NULL;
+    global_filter_text = NULL;
+    for (int i = 0; i < n_sink_filters; i++) {
+        output_filter_free(sink_filters[i].filter);
+        free(sink_filters[i].text);
+    }
+    n_sink_filters = 0;
+}
+
+/* ---- Stats ---- */
+
+void output_sinks_print_stats(FILE *f)
+{
+    for (int i = 0; i < n_sinks; i++) {
+        fprintf(f, " | %s: q=%u d=%lu", sinks[i].name,
+                queue_depth(&sinks[i].queue),
+                atomic_load(&sinks[i].n_dropped));
+        if (sinks[i].filter)
+            fprintf(f, " f=%lu", atomic_load(&sinks[i].n_filtered));
+    }
+}
+
+void output_sinks_describe(FILE *f)
+{
+    pthread_mutex_lock(&filter_lock);
+    if (global_filter_text)
+        fprintf(f, "filter %s\n", global_filter_text);
+    for (int i = 0; i < n_sinks; i++) {
+        output_sink_t *s = &sinks[i];
+        fprintf(f, "sink %s %s policy=%s queue=%u handled=%lu dropped=%lu "
+                "filtered=%lu", s->name,
+                atomic_load(&s->enabled) ? "on" : "off",
+                policy_names[s->policy], queue_depth(&s->queue),
+                atomic_load(&s->n_handled), atomic_load(&s->n_dropped),
+                atomic_load(&s->n_filtered));
+        for (int k = 0; k < n_sink_filters; k++)
+            if (s->filter && sink_filters[k].filter == s->filter)
+                fprintf(f, " filter=%s", sink_filters[k].text);
+        fprintf(f, "\n");
+    }
+    pthread_mutex_unlock(&filter_lock);
+}
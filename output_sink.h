@@ -0,0 +1,134 @@
+/*
+ * Asynchronous output sinks
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Asynchronous output sinks
+ *
+ * Every output (stdout/ZMQ lines, GSMTAP, ACARS, web map, positioning)
+ * registers as a sink with its own bounded queue and worker thread. The
+ * demod thread wraps each frame and its decoder results in one
+ * reference-counted output_item_t and hands it to every sink, so a slow
+ * sink only backs up its own queue. What happens when a queue is full
+ * is chosen per sink:
+ *
+ *   block        wait for space (lossless, back-pressures demod)
+ *   drop-newest  discard the incoming item
+ *   drop-oldest  discard the oldest queued item to make room
+ */
+
+#ifndef __OUTPUT_SINK_H__
+#define __OUTPUT_SINK_H__
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "qpsk_demod.h"
+#include "ida_decode.h"
+#include "frame_decode.h"
+
+#define OUTPUT_SINK_MAX        8
+#define OUTPUT_SINK_QUEUE_SIZE 1024
+
+typedef enum {
+    SINK_BLOCK = 0,
+    SINK_DROP_NEWEST,
+    SINK_DROP_OLDEST,
+} sink_policy_t;
+
+/* One demodulated frame plus decoder results, shared read-only by all
+ * sinks. Freed when the last sink releases it. */
+typedef struct {
+    demod_frame_t *demod;
+    int ida_ok;
+    ida_burst_t ida;
+    int decoded_ok;
+    decoded_frame_t decoded;
+    atomic_int refs;
+} output_item_t;
+
+/* Frame classes, as used by --filter type= and the frame store */
+typedef enum {
+    FRAME_CLASS_OTHER = 0,
+    FRAME_CLASS_IRA,
+    FRAME_CLASS_IBC,
+    FRAME_CLASS_IDA,
+} frame_class_t;
+
+static inline frame_class_t output_item_class(const output_item_t *item)
+{
+    if (item->decoded_ok && item->decoded.type == FRAME_IRA)
+        return FRAME_CLASS_IRA;
+    if (item->decoded_ok && item->decoded.type == FRAME_IBC)
+        return FRAME_CLASS_IBC;
+    if (item->ida_ok)
+        return FRAME_CLASS_IDA;
+    return FRAME_CLASS_OTHER;
+}
+
+/* Sink handler, called on the sink's worker thread */
+typedef void (*sink_handler_t)(const output_item_t *item, void *user);
+
+/* Register a sink before output_sinks_start(). The default policy can be
+ * overridden from the command line (output_sink_parse_policy). Returns 0
+ * on success, -1 if the sink table is full. */
+int output_sink_register(const char *name, sink_policy_t policy,
+                         sink_handler_t handler, void *user);
+
+/* Parse a NAME:POLICY override (--sink-policy). Returns 0 on success. */
+int output_sink_parse_policy(const char *spec);
+
+/* Parse and compile a [NAME:]EXPR filter (--filter, see output_filter.h).
+ * Without NAME the filter applies to every sink; a sink's own filter is
+ * applied in addition. At most one filter per target. Returns 0 on
+ * success, else -1 with a message in err. */
+int output_sink_parse_filter(const char *spec, char *err, size_t err_size);
+
+/* FILTER_NEEDS_* bits of every parsed filter, so the demod thread runs
+ * the decoders the filters depend on */
+unsigned output_sink_filter_needs(void);
+
+/* Replace a filter while running (control socket). spec is as for
+ * --filter, with EXPR "none" removing the filter. A filter needing
+ * decoder results outside allowed_needs (FILTER_NEEDS_*) is refused,
+ * since the decoders were chosen at startup. Returns 0 or -1 with a
+ * message in err. */
+int output_sink_set_filter(const char *spec, unsigned allowed_needs,
+                           char *err, size_t err_size);
+
+/* Stop or resume handing new items to a running sink; items already
+ * queued are still handled. Returns -1 for an unknown sink. */
+int output_sink_enable(const char *name, int on);
+
+/* Start one worker thread per registered sink. Returns -1, with none
+ * left running, if a thread cannot be started. */
+int output_sinks_start(void);
+
+/* Number of registered sinks */
+int output_sinks_count(void);
+
+/* Wrap a demodulated frame (takes ownership of demod, bits and llr).
+ * Returns NULL if out of memory; demod then stays the caller's. */
+output_item_t *output_item_new(demod_frame_t *demod);
+
+/* Queue the item to every sink according to its policy. Consumes the
+ * caller's reference. */
+void output_sinks_dispatch(output_item_t *item);
+
+/* Drain every queue, then stop and join the workers */
+void output_sinks_shutdown(void);
+
+/* Append " | name: q=DEPTH d=DROPPED" for each sink to the stats line,
+ * plus " f=FILTERED" for sinks with a filter */
+void output_sinks_print_stats(FILE *f);
+
+/* One "sink NAME on|off policy=... queue=N handled=N dropped=N
+ * filtered=N [filter=EXPR]" line per sink, preceded by "filter EXPR"
+ * if a global filter is set */
+void output_sinks_describe(FILE *f);
+
+#endif
@@ -30,6 +30,7 @@
 
 #include "qpsk_demod.h"
 #include "iridium.h"
+#include "logging.h"
 
 extern char *save_bursts_dir;
 extern int use_gardner;
@@ -344,7 +345,8 @@ static void save_burst_iq(downmix_frame_t *in, const char *dir_name)
     struct stat st = {0};
     if (stat(dir_name, &st) == -1) {
         if (mkdir(dir_name, 0755) == -1 && errno != EEXIST) {
-            fprintf(stderr, "Warning: failed to create burst save directory: %s\n",
+            log_msg(LOGC_DEMOD, LOGL_WARN,
+                    "Warning: failed to create burst save directory: %s",
                     strerror(errno));
             return;
         }
@@ -363,7 +365,8 @@ static void save_burst_iq(downmix_frame_t *in, const char *dir_name)
     snprintf(iq_file, sizeof(iq_file), "%s.cf32", filename);
     FILE *f = fopen(iq_file, "wb");
     if (!f) {
-        fprintf(stderr, "Warning: failed to save burst IQ: %s\n", strerror(errno));
+        log_msg(LOGC_DEMOD, LOGL_WARN, "Warning: failed to save burst IQ: %s",
+                strerror(errno));
         return;
     }
     fwrite(in->samples, sizeof(float complex), in->num_samples, f);
@@ -0,0 +1,127 @@
+/*
+ * Recycled sample-buffer pool
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Recycled sample-buffer pool -- fixed page-aligned buffers on a
+ * lock-free free list
+ */
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "sample_pool.h"
+#include "lf_queue.h"
+#include "logging.h"
+
+static uint8_t *pool_mem = NULL;
+static size_t buf_stride = 0;           /* bytes per buffer, page multiple */
+static size_t buf_payload = 0;          /* sample bytes per buffer */
+static mpmc_queue_t free_list;
+static int n_buffers = 0;
+static size_t pool_bytes = 0;           /* hard limit; 0 = SAMPLE_POOL_BYTES */
+static atomic_int pool_state = 0;       /* 0 = none, 1 = ready */
+static atomic_ulong n_overflows = 0;
+
+/* The source's thread uses the pool only after this returns, and
+ * buffers reach other threads through the samples queue afterwards, so
+ * no lock is needed */
+int sample_pool_init(size_t bytes)
+{
+    if (atomic_load(&pool_state) != 0)
+        return -1;
+
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    buf_stride = (sizeof(sample_buf_t) + bytes + page - 1) & ~(page - 1);
+    buf_payload = buf_stride - sizeof(sample_buf_t);
+
+    /* The count follows from the real block size, so the pool stays
+     * within its bytes whatever the source's MTU */
+    size_t n = (pool_bytes ? pool_bytes : SAMPLE_POOL_BYTES) / buf_stride;
+    if (n < SAMPLE_POOL_MIN_BUFFERS && pool_bytes) {
+        log_msg(LOGC_SDR, LOGL_ERROR, "Sample pool: blocks of %zu bytes "
+                "need %zu MiB for %d buffers, the memory budget allows "
+                "%zu MiB", bytes,
+                (buf_stride * SAMPLE_POOL_MIN_BUFFERS) >> 20,
+                SAMPLE_POOL_MIN_BUFFERS, pool_bytes >> 20);
+        return -1;
+    }
+    n_buffers = n < SAMPLE_POOL_MIN_BUFFERS ? SAMPLE_POOL_MIN_BUFFERS
+              : n > SAMPLE_POOL_MAX_BUFFERS ? SAMPLE_POOL_MAX_BUFFERS
+              : (int)n;
+
+    if (posix_memalign((void **)&pool_mem, page,
+                       buf_stride * n_buffers) != 0 ||
+        mpmc_queue_init(&free_list, n_buffers) != 0) {
+        free(pool_mem);
+        pool_mem = NULL;
+        return -1;
+    }
+
+    /* Touch every page now rather than on the streaming path */
+    memset(pool_mem, 0, buf_stride * n_buffers);
+    for (int i = 0; i < n_buffers; i++) {
+        sample_buf_t *s = (sample_buf_t *)(pool_mem + (size_t)i * buf_stride);
+        mpmc_queue_add(&free_list, s);
+    }
+
+    log_msg(LOGC_SDR, LOGL_INFO, "Sample pool: %d buffers of %zu bytes",
+            n_buffers, buf_payload);
+    atomic_store_explicit(&pool_state, 1, memory_order_release);
+    return 0;
+}
+
+void sample_pool_set_bytes(size_t bytes)
+{
+    pool_bytes = bytes;
+}
+
+sample_buf_t *sample_buf_get(size_t bytes, int wait)
+{
+    int state = atomic_load_explicit(&pool_state, memory_order_acquire);
+    if (state != 1 || bytes > buf_payload) {
+        atomic_fetch_add(&n_overflows, 1);
+        return NULL;
+    }
+
+    sample_buf_t *s;
+    int ret = wait ? mpmc_queue_take(&free_list, &s)
+                   : mpmc_queue_poll(&free_list, &s);
+    if (ret != 0) {
+        if (!wait) {
+            atomic_fetch_add(&n_overflows, 1);
+            log_msg(LOGC_SDR, LOGL_INFO,
+                    "WARNING: sample buffer pool exhausted, block dropped");
+        }
+        return NULL;
+    }
+    return s;
+}
+
+void sample_buf_release(sample_buf_t *s)
+{
+    if (s)
+        mpmc_queue_add(&free_list, s);
+}
+
+unsigned long sample_pool_overflows(void)
+{
+    return atomic_load(&n_overflows);
+}
+
+void sample_pool_shutdown(void)
+{
+    if (atomic_load(&pool_state) != 1)
+        return;
+    mpmc_queue_close(&free_list);
+    mpmc_queue_destroy(&free_list);
+    free(pool_mem);
+    pool_mem = NULL;
+    atomic_store(&pool_state, 0);
+}
@@ -0,0 +1,70 @@
+/*
+ * Recycled sample-buffer pool
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Recycled sample-buffer pool
+ *
+ * The SDR backends and the file reader take sample_buf_t blocks from a
+ * fixed pool instead of malloc()ing one per block, and the detector
+ * hands them back when it is done. sample_pool_init() allocates the pool
+ * for the source's block size (the sources use one block size per
+ * stream) before the source starts: page-aligned, prefaulted buffers,
+ * with the free list kept in a lock-free MPMC ring. Nothing is allocated
+ * or faulted in on the streaming path.
+ *
+ * The pool holds SAMPLE_POOL_BYTES of samples rather than a fixed count
+ * of buffers: about 0.8 s of cf32 or 3.3 s of int8 at 10 MSPS, whatever
+ * the block size. Every queued block holds a pool buffer, so this is all
+ * the buffering between the source and the detector. A detector that
+ * falls that far behind is not catching up; the source then drops
+ * blocks instead of the process growing to the samples_queue depth
+ * times the block size (a gigabyte for 256 KiB blocks). Small blocks
+ * are capped at SAMPLE_POOL_MAX_BUFFERS, the samples_queue depth.
+ *
+ * When every buffer is in flight, a live source drops the block and the
+ * pool counts an overflow. The file reader waits for a buffer instead.
+ * A request larger than the pool's buffers is an overflow too.
+ */
+
+#ifndef __SAMPLE_POOL_H__
+#define __SAMPLE_POOL_H__
+
+#include <stddef.h>
+
+#include "sdr.h"
+
+#define SAMPLE_POOL_BYTES        (64UL * 1024 * 1024)
+#define SAMPLE_POOL_MIN_BUFFERS  16
+#define SAMPLE_POOL_MAX_BUFFERS  4096     /* samples_queue depth */
+
+/* Hold at most bytes of buffers instead of SAMPLE_POOL_BYTES
+ * (--memory-budget); only before sample_pool_init(). The limit is then
+ * hard: blocks too large for SAMPLE_POOL_MIN_BUFFERS of them to fit make
+ * sample_pool_init() fail. */
+void sample_pool_set_bytes(size_t bytes);
+
+/* Allocate and prefault the pool for blocks of up to bytes. Call once,
+ * before the source delivers its first block, off the sample path.
+ * Returns 0, or -1 if the memory is not available or the blocks do not
+ * fit the limit set with sample_pool_set_bytes(). */
+int sample_pool_init(size_t bytes);
+
+/* A buffer with room for bytes of samples, or NULL on overflow. With
+ * wait set, blocks until a buffer is free instead (NULL only if the
+ * request is too large or the pool is shut down). */
+sample_buf_t *sample_buf_get(size_t bytes, int wait);
+
+/* Return a buffer to the pool; safe from any thread */
+void sample_buf_release(sample_buf_t *s);
+
+/* Overflows so far (blocks dropped for lack of a buffer) */
+unsigned long sample_pool_overflows(void);
+
+/* Free the pool. All buffers must have been released. */
+void sample_pool_shutdown(void);
+
+#endif
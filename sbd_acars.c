@@ -13,12 +13,14 @@
  * SPDX-License-Identifier: GPL-3.0-or-later
  */
 
+#define _GNU_SOURCE
 #include <arpa/inet.h>
 #include <errno.h>
-#include <netdb.h>
 #include <netinet/in.h>
-#include <netinet/tcp.h>
+#include <pthread.h>
 #include <stdarg.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -27,6 +29,12 @@
 #include <unistd.h>
 
 #include "sbd_acars.h"
+#include "udp_batch.h"
+#include "airframes_feed.h"
+#include "json_writer.h"
+#include "acars_dedup.h"
+#include "logging.h"
+#include "blocking_queue.h"
 
 #ifdef HAVE_LIBACARS
 #include <libacars/libacars.h>
@@ -40,6 +48,8 @@
 
 int acars_json = 0;
 extern int acars_enabled;
+extern int acars_dedup_sec;
+extern int acars_threads;
 static const char *station = NULL;
 
 /* ---- UDP JSON streaming (up to 4 endpoints) ---- */
@@ -47,184 +57,175 @@ static const char *station = NULL;
 #define UDP_MAX 4
 static int udp_count = 0;
 static int udp_fds[UDP_MAX];
-static struct sockaddr_in udp_addrs[UDP_MAX];
+static udp_batch_t udp_batches[UDP_MAX];
 
 /* ---- Aggregator feed: UDP endpoint (iridium-toolkit format) ---- */
 
 static int hub_fd = -1;
 static struct sockaddr_in hub_addr;
+static udp_batch_t hub_batch;
 
-/* ---- Aggregator feed: TCP endpoint (iridium-toolkit format) ---- */
+/* JSON messages are built on the stack with json_writer */
+#define JSON_BUF_SIZE 8192
 
-static int airframes_fd = -1;
-static char *airframes_saved_host = NULL;
-static int airframes_saved_port = 0;
+/* ---- Message output buffers ----
+ *
+ * Decoders write each message's text lines, JSON and feed records into an
+ * acars_out_t. It is flushed to stdout, UDP and the feeds in one go, so
+ * messages decoded on the worker pool come out whole and in order. */
 
-/* JSON output buffer -- used to build JSON for dual stdout/UDP dispatch */
-#define JSON_BUF_SIZE 8192
-static char json_buf[JSON_BUF_SIZE];
-static int json_pos = 0;
+enum { OUT_TEXT, OUT_JSON, OUT_HUB };
 
-static void json_buf_reset(void) { json_pos = 0; json_buf[0] = '\0'; }
+typedef struct {
+    char *buf;
+    size_t len, cap;
+    size_t last;        /* offset of the last record header, or SIZE_MAX */
+} acars_out_t;
 
-static void json_buf_append(const char *fmt, ...)
-    __attribute__((format(printf, 1, 2)));
+#define OUT_HDR 5       /* u8 kind | u32 length */
 
-static void json_buf_append(const char *fmt, ...)
+static int out_reserve(acars_out_t *o, size_t n)
 {
-    if (json_pos >= JSON_BUF_SIZE - 1) return;
-    va_list ap;
-    va_start(ap, fmt);
-    int n = vsnprintf(json_buf + json_pos, JSON_BUF_SIZE - json_pos, fmt, ap);
-    va_end(ap);
-    if (n > 0) json_pos += n;
-    if (json_pos >= JSON_BUF_SIZE) json_pos = JSON_BUF_SIZE - 1;
+    if (o->len + n <= o->cap)
+        return 0;
+    size_t cap = o->cap ? o->cap : 1024;
+    while (cap < o->len + n)
+        cap *= 2;
+    char *p = realloc(o->buf, cap);
+    if (!p)
+        return -1;
+    o->buf = p;
+    o->cap = cap;
+    return 0;
 }
 
-static void json_buf_emit(void)
+/* Append data to the last record if it has the same kind, else start one */
+static void out_append(acars_out_t *o, int kind, const char *data, size_t len)
 {
-    if (json_pos == 0) return;
-
-    /* stdout (--acars-json) */
-    if (acars_json) {
-        fwrite(json_buf, 1, json_pos, stdout);
-        putchar('\n');
-        fflush(stdout);
-    }
-
-    /* UDP streams (--acars-udp, one or more endpoints) */
-    for (int i = 0; i < udp_count; i++) {
-        if (udp_fds[i] >= 0) {
-            sendto(udp_fds[i], json_buf, json_pos, 0,
-                   (struct sockaddr *)&udp_addrs[i], sizeof(udp_addrs[i]));
-        }
+    int extend = kind == OUT_TEXT && o->len > 0 && o->last != SIZE_MAX &&
+                 o->buf[o->last] == OUT_TEXT;
+    if (out_reserve(o, len + (extend ? 0 : OUT_HDR)) != 0)
+        return;
+    if (!extend) {
+        o->last = o->len;
+        o->buf[o->len] = (char)kind;
+        memset(o->buf + o->len + 1, 0, 4);
+        o->len += OUT_HDR;
     }
+    uint32_t rec_len;
+    memcpy(&rec_len, o->buf + o->last + 1, 4);
+    rec_len += (uint32_t)len;
+    memcpy(o->buf + o->last + 1, &rec_len, 4);
+    memcpy(o->buf + o->len, data, len);
+    o->len += len;
 }
 
-/* Forward declarations */
-static void format_timestamp(uint64_t ts_ns, char *buf, int bufsz);
-static double ts_to_unix(uint64_t ts_ns);
-
-/* ---- acarshub JSON buffer (iridium-toolkit compat format) ---- */
-
-static char hub_buf[JSON_BUF_SIZE];
-static int hub_pos = 0;
+static void out_printf(acars_out_t *o, const char *fmt, ...)
+    __attribute__((format(printf, 2, 3)));
 
-static void hub_buf_reset(void) { hub_pos = 0; hub_buf[0] = '\0'; }
-
-static void hub_buf_append(const char *fmt, ...)
-    __attribute__((format(printf, 1, 2)));
-
-static void hub_buf_append(const char *fmt, ...)
+static void out_printf(acars_out_t *o, const char *fmt, ...)
 {
-    if (hub_pos >= JSON_BUF_SIZE - 1) return;
+    char tmp[1024];
     va_list ap;
     va_start(ap, fmt);
-    int n = vsnprintf(hub_buf + hub_pos, JSON_BUF_SIZE - hub_pos, fmt, ap);
+    int n = vsnprintf(tmp, sizeof(tmp), fmt, ap);
     va_end(ap);
-    if (n > 0) hub_pos += n;
-    if (hub_pos >= JSON_BUF_SIZE) hub_pos = JSON_BUF_SIZE - 1;
-}
-
-/* Attempt TCP connection to airframes endpoint (hostname resolved via getaddrinfo) */
-static int airframes_connect(const char *host, int port)
-{
-    char port_str[16];
-    snprintf(port_str, sizeof(port_str), "%d", port);
-
-    struct addrinfo hints = { .ai_family = AF_INET, .ai_socktype = SOCK_STREAM };
-    struct addrinfo *res = NULL;
-    if (getaddrinfo(host, port_str, &hints, &res) != 0 || !res)
-        return -1;
-
-    int fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
-    if (fd < 0) {
-        freeaddrinfo(res);
-        return -1;
-    }
-
-    if (connect(fd, res->ai_addr, res->ai_addrlen) != 0) {
-        close(fd);
-        freeaddrinfo(res);
-        return -1;
+    if (n < 0)
+        return;
+    if ((size_t)n < sizeof(tmp)) {
+        out_append(o, OUT_TEXT, tmp, n);
+        return;
     }
-    freeaddrinfo(res);
-
-    /* Disable Nagle for low-latency sends */
-    int flag = 1;
-    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
 
-    return fd;
+    /* Long libacars text output */
+    char *big = malloc(n + 1);
+    if (!big)
+        return;
+    va_start(ap, fmt);
+    vsnprintf(big, n + 1, fmt, ap);
+    va_end(ap);
+    out_append(o, OUT_TEXT, big, n);
+    free(big);
 }
 
-static void hub_buf_emit(void)
+#ifndef HAVE_LIBACARS
+/* Only the fallback text formatter prints a character at a time */
+static void out_putc(acars_out_t *o, char c)
 {
-    if (hub_pos == 0) return;
+    out_append(o, OUT_TEXT, &c, 1);
+}
+#endif
 
-    /* UDP to acarshub */
-    if (hub_fd >= 0)
-        sendto(hub_fd, hub_buf, hub_pos, 0,
-               (struct sockaddr *)&hub_addr, sizeof(hub_addr));
-
-    /* TCP to airframes.io */
-    if (airframes_fd >= 0 || airframes_saved_host) {
-        /* Reconnect if needed */
-        if (airframes_fd < 0 && airframes_saved_host) {
-            airframes_fd = airframes_connect(airframes_saved_host,
-                                             airframes_saved_port);
-            if (airframes_fd >= 0)
-                fprintf(stderr, "ACARS: reconnected to airframes %s:%d\n",
-                        airframes_saved_host, airframes_saved_port);
-        }
+/* One dumpvdl2-format JSON message for stdout and UDP */
+static void json_emit(acars_out_t *o, const char *json, size_t len)
+{
+    if (len > 0)
+        out_append(o, OUT_JSON, json, len);
+}
 
-        if (airframes_fd >= 0) {
-            /* Send JSON + newline over TCP (MSG_NOSIGNAL avoids SIGPIPE) */
-            ssize_t r = send(airframes_fd, hub_buf, hub_pos, MSG_NOSIGNAL);
-            if (r > 0)
-                r = send(airframes_fd, "\n", 1, MSG_NOSIGNAL);
-            if (r <= 0) {
-                /* Connection lost -- close and retry next message */
-                close(airframes_fd);
-                airframes_fd = -1;
-            }
-        }
-    }
+/* One iridium-toolkit format message for acarshub / airframes.io */
+static void hub_emit(acars_out_t *o, const char *json, size_t len)
+{
+    if (len > 0)
+        out_append(o, OUT_HUB, json, len);
 }
 
-/* JSON string escaping for acarshub output */
-static void hub_json_escape(const char *in, int inlen, char *out, int outsz)
+static void out_flush(acars_out_t *o)
 {
-    int o = 0;
-    for (int i = 0; i < inlen && o < outsz - 2; i++) {
-        unsigned char c = (unsigned char)in[i];
-        if (c == '"') {
-            if (o + 2 >= outsz) break;
-            out[o++] = '\\'; out[o++] = '"';
-        } else if (c == '\\') {
-            if (o + 2 >= outsz) break;
-            out[o++] = '\\'; out[o++] = '\\';
-        } else if (c == '\n') {
-            if (o + 2 >= outsz) break;
-            out[o++] = '\\'; out[o++] = 'n';
-        } else if (c == '\r') {
-            if (o + 2 >= outsz) break;
-            out[o++] = '\\'; out[o++] = 'r';
-        } else if (c == '\t') {
-            if (o + 2 >= outsz) break;
-            out[o++] = '\\'; out[o++] = 't';
-        } else if (c < 0x20 || c == 0x7f) {
-            if (o + 6 >= outsz) break;
-            o += snprintf(out + o, outsz - o, "\\u%04x", c);
-        } else {
-            out[o++] = (char)c;
+    int wrote_stdout = 0;
+
+    for (size_t pos = 0; pos + OUT_HDR <= o->len; ) {
+        int kind = o->buf[pos];
+        uint32_t len;
+        memcpy(&len, o->buf + pos + 1, 4);
+        const char *data = o->buf + pos + OUT_HDR;
+        pos += OUT_HDR + len;
+
+        switch (kind) {
+        case OUT_TEXT:
+            fwrite(data, 1, len, stdout);
+            wrote_stdout = 1;
+            break;
+        case OUT_JSON:
+            /* stdout (--acars-json) */
+            if (acars_json) {
+                fwrite(data, 1, len, stdout);
+                putchar('\n');
+                wrote_stdout = 1;
+            }
+            /* UDP streams (--acars-udp, one or more endpoints) */
+            for (int i = 0; i < udp_count; i++) {
+                if (udp_fds[i] >= 0)
+                    udp_batch_send(&udp_batches[i], data, len);
+            }
+            break;
+        case OUT_HUB:
+            /* UDP to acarshub */
+            if (hub_fd >= 0)
+                udp_batch_send(&hub_batch, data, len);
+            /* TCP to airframes.io (queued, written by the feeder thread) */
+            if (airframes_feed_active())
+                airframes_feed_send(data, len);
+            break;
         }
     }
-    out[o] = '\0';
+    if (wrote_stdout)
+        fflush(stdout);
+
+    o->len = 0;
+    o->last = SIZE_MAX;
 }
 
+/* Forward declarations */
+static void format_timestamp(uint64_t ts_ns, char *buf, int bufsz);
+static double ts_to_unix(uint64_t ts_ns);
+
+/* ---- acarshub / airframes output (iridium-toolkit compat format) ---- */
+
 /* Emit iridium-toolkit compatible JSON to acarshub endpoint.
  * Called from both libacars and fallback paths with pre-extracted fields. */
-static void hub_emit_acars(const char *mode, const char *reg, char ack,
+static void hub_emit_acars(acars_out_t *o,
+                            const char *mode, const char *reg, char ack,
                             const char *label, char blk_id, int block_end,
                             int ul, const char *text, int text_len,
                             const char *flight, const char *msg_num,
@@ -232,75 +233,67 @@ static void hub_emit_acars(const char *mode, const char *reg, char ack,
                             uint64_t timestamp, double frequency,
                             float magnitude, const uint8_t *hdr, int hdr_len)
 {
-    if (hub_fd < 0 && airframes_fd < 0 && !airframes_saved_host) return;
+    if (hub_fd < 0 && !airframes_feed_active()) return;
 
     /* Timestamp as ISO-8601 */
     char ts_buf[32];
     format_timestamp(timestamp, ts_buf, sizeof(ts_buf));
 
-    /* Escape strings */
-    char esc_reg[64], esc_label[16], esc_text[2048];
-    hub_json_escape(reg ? reg : "", reg ? (int)strlen(reg) : 0,
-                    esc_reg, sizeof(esc_reg));
-    hub_json_escape(label ? label : "", label ? (int)strlen(label) : 0,
-                    esc_label, sizeof(esc_label));
-    if (text && text_len > 0)
-        hub_json_escape(text, text_len, esc_text, sizeof(esc_text));
-    else
-        esc_text[0] = '\0';
-
-    /* Header as hex string */
-    char hdr_hex[64] = "";
-    if (hdr && hdr_len > 0) {
-        int hp = 0;
-        for (int i = 0; i < hdr_len && hp < (int)sizeof(hdr_hex) - 3; i++)
-            hp += snprintf(hdr_hex + hp, sizeof(hdr_hex) - hp, "%02x", hdr[i]);
-    }
-
-    hub_buf_reset();
+    char buf[JSON_BUF_SIZE];
+    json_writer_t jw;
+    jw_init(&jw, buf, sizeof(buf));
+    jw_object_begin(&jw);
 
     /* app block -- must say "iridium-toolkit" for acarshub detection */
-    hub_buf_append("{\"app\":{\"name\":\"iridium-toolkit\",\"version\":\"0.0.1\"}");
+    jw_key(&jw, "app");
+    jw_object_begin(&jw);
+    jw_kv_string(&jw, "name", "iridium-toolkit");
+    jw_kv_string(&jw, "version", "0.0.1");
+    jw_object_end(&jw);
 
     /* source block */
-    hub_buf_append(",\"source\":{\"transport\":\"iridium\","
-                   "\"protocol\":\"acars\"");
+    jw_key(&jw, "source");
+    jw_object_begin(&jw);
+    jw_kv_string(&jw, "transport", "iridium");
+    jw_kv_string(&jw, "protocol", "acars");
     if (station)
-        hub_buf_append(",\"station_id\":\"%s\"", station);
-    hub_buf_append("}");
+        jw_kv_string(&jw, "station_id", station);
+    jw_object_end(&jw);
 
     /* acars block */
-    hub_buf_append(",\"acars\":{\"timestamp\":\"%s\"", ts_buf);
-    hub_buf_append(",\"errors\":%d", errors);
-    hub_buf_append(",\"link_direction\":\"%s\"", ul ? "uplink" : "downlink");
-    hub_buf_append(",\"block_end\":%s", block_end ? "true" : "false");
-    hub_buf_append(",\"mode\":\"%s\"", mode ? mode : "");
-    hub_buf_append(",\"tail\":\"%s\"", esc_reg);
-    hub_buf_append(",\"label\":\"%s\"", esc_label);
-    hub_buf_append(",\"block_id\":\"%c\"", blk_id);
-    hub_buf_append(",\"ack\":\"%c\"", (ack == 0x15) ? '!' : ack);
-
-    if (flight && flight[0]) {
-        char esc_flt[32];
-        hub_json_escape(flight, (int)strlen(flight), esc_flt, sizeof(esc_flt));
-        hub_buf_append(",\"flight\":\"%s\"", esc_flt);
-    }
-    if (msg_num && msg_num[0]) {
-        char esc_mn[16];
-        hub_json_escape(msg_num, (int)strlen(msg_num), esc_mn, sizeof(esc_mn));
-        hub_buf_append(",\"message_number\":\"%s\"", esc_mn);
-    }
-
-    hub_buf_append(",\"text\":\"%s\"", esc_text);
-    hub_buf_append("}");
+    jw_key(&jw, "acars");
+    jw_object_begin(&jw);
+    jw_kv_string(&jw, "timestamp", ts_buf);
+    jw_kv_int(&jw, "errors", errors);
+    jw_kv_string(&jw, "link_direction", ul ? "uplink" : "downlink");
+    jw_kv_bool(&jw, "block_end", block_end);
+    jw_kv_string(&jw, "mode", mode);
+    jw_kv_string(&jw, "tail", reg);
+    jw_kv_string(&jw, "label", label);
+    jw_key(&jw, "block_id");
+    jw_char(&jw, blk_id);
+    jw_key(&jw, "ack");
+    jw_char(&jw, (ack == 0x15) ? '!' : ack);
+    if (flight && flight[0])
+        jw_kv_string(&jw, "flight", flight);
+    if (msg_num && msg_num[0])
+        jw_kv_string(&jw, "message_number", msg_num);
+    jw_key(&jw, "text");
+    jw_string_n(&jw, text ? text : "", text && text_len > 0 ? text_len : 0);
+    jw_object_end(&jw);
 
     /* top-level freq, level, header */
-    hub_buf_append(",\"freq\":%.1f", frequency);
-    hub_buf_append(",\"level\":%.2f", (double)magnitude);
-    hub_buf_append(",\"header\":\"%s\"", hdr_hex);
-
-    hub_buf_append("}");
-    hub_buf_emit();
+    jw_kv_double(&jw, "freq", frequency, 1);
+    jw_kv_double(&jw, "level", magnitude, 2);
+    jw_key(&jw, "header");
+    jw_hex(&jw, hdr, hdr && hdr_len > 0 ? hdr_len : 0);
+    jw_object_end(&jw);
+
+    if (jw_ok(&jw))
+        hub_emit(o, buf, jw_len(&jw));
+    else
+        log_msg(LOGC_ACARS, LOGL_WARN,
+                "ACARS: feed JSON over %d bytes dropped", JSON_BUF_SIZE);
 }
 
 /* ---- Stats counters ---- */
@@ -312,8 +305,8 @@ static int stat_sbd_single = 0;     /* single-packet messages */
 static int stat_sbd_multi_ok = 0;   /* completed multi-packet messages */
 static int stat_sbd_multi_frag = 0; /* multi-packet fragments processed */
 static int stat_sbd_broken = 0;     /* orphan/expired fragments */
-static int stat_acars_total = 0;    /* ACARS messages decoded */
-static int stat_acars_errors = 0;   /* ACARS with CRC/parity errors */
+static atomic_int stat_acars_total = 0;    /* ACARS messages decoded */
+static atomic_int stat_acars_errors = 0;   /* ACARS with CRC/parity errors */
 
 /* ---- Timestamp handling ---- */
 
@@ -411,8 +404,6 @@ static sbd_multi_t sbd_multi[SBD_MAX_MULTI];
 
 #include <libacars/json.h>
 
-static la_reasm_ctx *reasm_ctx = NULL;
-
 /* Iridium message metadata for the JSON envelope */
 typedef struct {
     const char *station;
@@ -459,7 +450,8 @@ static la_type_descriptor const la_DEF_iridium_message = {
     .json_key = "iridium",
 };
 
-static void acars_parse_libacars(const uint8_t *data, int len, int ul,
+static void acars_parse_libacars(acars_out_t *o, la_reasm_ctx *reasm,
+                                  const uint8_t *data, int len, int ul,
                                   uint64_t timestamp, double frequency,
                                   float magnitude)
 {
@@ -492,7 +484,7 @@ static void acars_parse_libacars(const uint8_t *data, int len, int ul,
     tv.tv_usec = (long)((unix_time - (double)tv.tv_sec) * 1000000.0);
 
     la_proto_node *tree = la_acars_parse_and_reassemble(
-        data, len, dir, reasm_ctx, tv);
+        data, len, dir, reasm, tv);
     if (!tree)
         return;
 
@@ -511,9 +503,9 @@ static void acars_parse_libacars(const uint8_t *data, int len, int ul,
         return;
     }
 
-    stat_acars_total++;
+    atomic_fetch_add(&stat_acars_total, 1);
     if (msg->err)
-        stat_acars_errors++;
+        atomic_fetch_add(&stat_acars_errors, 1);
 
     if (acars_json || udp_count > 0) {
         if (msg->err) {
@@ -539,11 +531,8 @@ static void acars_parse_libacars(const uint8_t *data, int len, int ul,
         ir_node->next = tree;
 
         la_vstring *vstr = la_proto_tree_format_json(NULL, ir_node);
-        if (vstr && vstr->str) {
-            json_buf_reset();
-            json_buf_append("%.*s", (int)vstr->len, vstr->str);
-            json_buf_emit();
-        }
+        if (vstr && vstr->str)
+            json_emit(o, vstr->str, vstr->len);
         if (vstr)
             la_vstring_destroy(vstr, true);
 
@@ -558,24 +547,23 @@ static void acars_parse_libacars(const uint8_t *data, int len, int ul,
         char ts_buf[32];
         format_timestamp(timestamp, ts_buf, sizeof(ts_buf));
 
-        printf("ACARS: %s %s ", ts_buf, ul ? "UL" : "DL");
+        out_printf(o, "ACARS: %s %s ", ts_buf, ul ? "UL" : "DL");
         if (ir_hdr && ir_hdr_len > 0) {
-            printf("[hdr:%s] ", "iridium");
+            out_printf(o, "[hdr:%s] ", "iridium");
         }
 
         la_vstring *vstr = la_proto_tree_format_text(NULL, tree);
         if (vstr && vstr->str) {
             /* Print the full decoded output from libacars */
-            printf("\n%s", vstr->str);
+            out_printf(o, "\n%s", vstr->str);
         }
         if (vstr)
             la_vstring_destroy(vstr, true);
 
-        fflush(stdout);
     }
 
     /* acarshub/airframes compat output (iridium-toolkit format) */
-    if ((hub_fd >= 0 || airframes_fd >= 0 || airframes_saved_host) &&
+    if ((hub_fd >= 0 || airframes_feed_active()) &&
         !msg->err) {
         char mode_str[2] = { msg->mode, '\0' };
 
@@ -590,7 +578,7 @@ static void acars_parse_libacars(const uint8_t *data, int len, int ul,
         const char *txt = msg->txt ? msg->txt : "";
         int txt_len = msg->txt ? (int)strlen(msg->txt) : 0;
 
-        hub_emit_acars(mode_str, tail, msg->ack, msg->label, msg->block_id,
+        hub_emit_acars(o, mode_str, tail, msg->ack, msg->label, msg->block_id,
                        block_end, ul, txt, txt_len,
                        msg->flight_id, msg->msg_num, msg->msg_num_seq,
                        0, timestamp, frequency, magnitude,
@@ -608,44 +596,13 @@ static void acars_parse_libacars(const uint8_t *data, int len, int ul,
  * manually without libacars (no ARINC-622/ADS-C/CPDLC decoding).
  * ================================================================ */
 
-/* ---- JSON string escaping (only needed in fallback path) ---- */
-
-static void json_escape(const char *in, int inlen, char *out, int outsz)
-{
-    int o = 0;
-    for (int i = 0; i < inlen && o < outsz - 2; i++) {
-        unsigned char c = (unsigned char)in[i];
-        if (c == '"') {
-            if (o + 2 >= outsz) break;
-            out[o++] = '\\'; out[o++] = '"';
-        } else if (c == '\\') {
-            if (o + 2 >= outsz) break;
-            out[o++] = '\\'; out[o++] = '\\';
-        } else if (c == '\n') {
-            if (o + 2 >= outsz) break;
-            out[o++] = '\\'; out[o++] = 'n';
-        } else if (c == '\r') {
-            if (o + 2 >= outsz) break;
-            out[o++] = '\\'; out[o++] = 'r';
-        } else if (c == '\t') {
-            if (o + 2 >= outsz) break;
-            out[o++] = '\\'; out[o++] = 't';
-        } else if (c < 0x20 || c == 0x7f) {
-            if (o + 6 >= outsz) break;
-            o += snprintf(out + o, outsz - o, "\\u%04x", c);
-        } else {
-            out[o++] = (char)c;
-        }
-    }
-    out[o] = '\0';
-}
-
 /* Fallback JSON: same dumpvdl2/dumphfdl envelope as the libacars path,
  * but ACARS fields are manually extracted (no ARINC-622 decoding).
  * Field names match libacars' la_acars_format_json output:
  *   err, crc_ok, more, reg, mode, label, blk_id, ack,
  *   flight, msg_num, msg_num_seq, sublabel, mfi, msg_text */
-static void acars_output_json(const uint8_t *data, int len, int ul,
+static void acars_output_json(acars_out_t *o,
+                               const uint8_t *data, int len, int ul,
                                uint64_t timestamp, double frequency,
                                float magnitude, const uint8_t *hdr, int hdr_len)
 {
@@ -706,61 +663,76 @@ static void acars_output_json(const uint8_t *data, int len, int ul,
     long tv_sec = (long)unix_time;
     long tv_usec = (long)((unix_time - (double)tv_sec) * 1000000.0);
 
-    /* Escape text for JSON */
-    char esc_text[2048];
-    if (txt && txt_len > 0)
-        json_escape((const char *)txt, txt_len, esc_text, sizeof(esc_text));
-    else
-        esc_text[0] = '\0';
-
-    char esc_reg[64], esc_label[16], esc_flight[32], esc_msgnum[16];
-    json_escape(reg, (int)strlen(reg), esc_reg, sizeof(esc_reg));
-    json_escape(label, (int)strlen(label), esc_label, sizeof(esc_label));
-    json_escape(flight, (int)strlen(flight), esc_flight, sizeof(esc_flight));
-    json_escape(msg_num, (int)strlen(msg_num), esc_msgnum, sizeof(esc_msgnum));
-
-    json_buf_reset();
+    char buf[JSON_BUF_SIZE];
+    json_writer_t jw;
+    jw_init(&jw, buf, sizeof(buf));
+    jw_object_begin(&jw);
 
     /* Iridium envelope (matches dumpvdl2 "vdl2" / dumphfdl "hfdl") */
-    json_buf_append("{\"iridium\":{\"app\":{\"name\":\"iridium-sniffer\","
-                    "\"ver\":\"1.0\"}");
+    jw_key(&jw, "iridium");
+    jw_object_begin(&jw);
+    jw_key(&jw, "app");
+    jw_object_begin(&jw);
+    jw_kv_string(&jw, "name", "iridium-sniffer");
+    jw_kv_string(&jw, "ver", "1.0");
+    jw_object_end(&jw);
     if (station)
-        json_buf_append(",\"station\":\"%s\"", station);
-    json_buf_append(",\"t\":{\"sec\":%ld,\"usec\":%ld}", tv_sec, tv_usec);
-    json_buf_append(",\"freq\":%lld", (long long)(int64_t)frequency);
-    json_buf_append(",\"sig_level\":%.2f", (double)magnitude);
+        jw_kv_string(&jw, "station", station);
+    jw_key(&jw, "t");
+    jw_object_begin(&jw);
+    jw_kv_int(&jw, "sec", tv_sec);
+    jw_kv_int(&jw, "usec", tv_usec);
+    jw_object_end(&jw);
+    jw_kv_int(&jw, "freq", (int64_t)frequency);
+    jw_kv_double(&jw, "sig_level", magnitude, 2);
 
     if (hdr && hdr_len > 0) {
-        json_buf_append(",\"header\":\"");
-        for (int i = 0; i < hdr_len; i++)
-            json_buf_append("%02x", hdr[i]);
-        json_buf_append("\"");
+        jw_key(&jw, "header");
+        jw_hex(&jw, hdr, hdr_len);
     }
 
     /* ACARS fields -- match libacars la_acars_format_json field names */
-    json_buf_append(",\"acars\":{\"err\":false,\"crc_ok\":true");
-    json_buf_append(",\"more\":%s", cont ? "true" : "false");
-    json_buf_append(",\"reg\":\"%s\"", esc_reg);
-    json_buf_append(",\"mode\":\"%c\"", mode);
-    json_buf_append(",\"label\":\"%s\"", esc_label);
-    json_buf_append(",\"blk_id\":\"%c\"", blk_id);
-    json_buf_append(",\"ack\":\"%c\"", ack);
+    jw_key(&jw, "acars");
+    jw_object_begin(&jw);
+    jw_kv_bool(&jw, "err", 0);
+    jw_kv_bool(&jw, "crc_ok", 1);
+    jw_kv_bool(&jw, "more", cont);
+    jw_kv_string(&jw, "reg", reg);
+    jw_key(&jw, "mode");
+    jw_char(&jw, mode);
+    jw_kv_string(&jw, "label", label);
+    jw_key(&jw, "blk_id");
+    jw_char(&jw, blk_id);
+    jw_key(&jw, "ack");
+    jw_char(&jw, ack);
 
     if (ul && flight[0]) {
-        json_buf_append(",\"flight\":\"%s\"", esc_flight);
-        json_buf_append(",\"msg_num\":\"%s\"", esc_msgnum);
-        if (msg_num_seq)
-            json_buf_append(",\"msg_num_seq\":\"%c\"", msg_num_seq);
+        jw_kv_string(&jw, "flight", flight);
+        jw_kv_string(&jw, "msg_num", msg_num);
+        if (msg_num_seq) {
+            jw_key(&jw, "msg_num_seq");
+            jw_char(&jw, msg_num_seq);
+        }
     }
 
-    if (esc_text[0])
-        json_buf_append(",\"msg_text\":\"%s\"", esc_text);
+    if (txt && txt_len > 0) {
+        jw_key(&jw, "msg_text");
+        jw_string_n(&jw, (const char *)txt, txt_len);
+    }
+
+    jw_object_end(&jw);     /* acars */
+    jw_object_end(&jw);     /* iridium */
+    jw_object_end(&jw);
 
-    json_buf_append("}}}");
-    json_buf_emit();
+    if (jw_ok(&jw))
+        json_emit(o, buf, jw_len(&jw));
+    else
+        log_msg(LOGC_ACARS, LOGL_WARN,
+                "ACARS: JSON over %d bytes dropped", JSON_BUF_SIZE);
 }
 
-static void acars_output_text(const uint8_t *data, int len, int ul,
+static void acars_output_text(acars_out_t *o,
+                               const uint8_t *data, int len, int ul,
                                uint64_t timestamp, double frequency,
                                float magnitude, const uint8_t *hdr, int hdr_len,
                                int errors)
@@ -808,56 +780,56 @@ static void acars_output_text(const uint8_t *data, int len, int ul,
         }
     }
 
-    printf("ACARS: %s %s Mode:%c REG:%-7s ",
-           ts_buf, ul ? "UL" : "DL", mode, reg);
+    out_printf(o, "ACARS: %s %s Mode:%c REG:%-7s ",
+               ts_buf, ul ? "UL" : "DL", mode, reg);
 
     if (is_nak)
-        printf("NAK  ");
+        out_printf(o, "NAK  ");
     else
-        printf("ACK:%c ", ack);
+        out_printf(o, "ACK:%c ", ack);
 
-    printf("Label:%s bID:%c ", label, bid);
+    out_printf(o, "Label:%s bID:%c ", label, bid);
 
     if (rest_len > 0 && rest[0] == 0x02) {
         if (ul && rest_len >= 11) {
-            printf("SEQ:%.4s FNO:%.6s ", rest + 1, rest + 5);
+            out_printf(o, "SEQ:%.4s FNO:%.6s ", rest + 1, rest + 5);
             if (rest_len > 11) {
-                printf("[");
+                out_printf(o, "[");
                 for (int i = 11; i < rest_len; i++) {
                     char c = (char)rest[i];
                     if (c >= 0x20 && c < 0x7f)
-                        putchar(c);
+                        out_putc(o, c);
                     else
-                        putchar('.');
+                        out_putc(o, '.');
                 }
-                printf("]");
+                out_printf(o, "]");
             }
         } else {
             if (rest_len > 1) {
-                printf("[");
+                out_printf(o, "[");
                 for (int i = 1; i < rest_len; i++) {
                     char c = (char)rest[i];
                     if (c >= 0x20 && c < 0x7f)
-                        putchar(c);
+                        out_putc(o, c);
                     else
-                        putchar('.');
+                        out_putc(o, '.');
                 }
-                printf("]");
+                out_printf(o, "]");
             }
         }
     }
 
     if (cont)
-        printf(" CONT'd");
+        out_printf(o, " CONT'd");
 
     if (errors > 0)
-        printf(" ERRORS");
+        out_printf(o, " ERRORS");
 
-    printf("\n");
-    fflush(stdout);
+    out_printf(o, "\n");
 }
 
-static void acars_parse_fallback(const uint8_t *data, int len, int ul,
+static void acars_parse_fallback(acars_out_t *o,
+                                  const uint8_t *data, int len, int ul,
                                   uint64_t timestamp, double frequency,
                                   float magnitude)
 {
@@ -922,22 +894,22 @@ static void acars_parse_fallback(const uint8_t *data, int len, int ul,
 
     int errors = crc_errors + (!parity_ok);
 
-    stat_acars_total++;
+    atomic_fetch_add(&stat_acars_total, 1);
     if (errors > 0)
-        stat_acars_errors++;
+        atomic_fetch_add(&stat_acars_errors, 1);
 
     if ((acars_json || udp_count > 0) && errors > 0)
         return;
 
     if (acars_json || udp_count > 0)
-        acars_output_json(stripped, len, ul, timestamp, frequency, magnitude,
+        acars_output_json(o, stripped, len, ul, timestamp, frequency, magnitude,
                           hdr, hdr_len);
     if (!acars_json)
-        acars_output_text(stripped, len, ul, timestamp, frequency, magnitude,
+        acars_output_text(o, stripped, len, ul, timestamp, frequency, magnitude,
                           hdr, hdr_len, errors);
 
     /* acarshub/airframes compat output (iridium-toolkit format) */
-    if ((hub_fd >= 0 || airframes_fd >= 0 || airframes_saved_host) &&
+    if ((hub_fd >= 0 || airframes_feed_active()) &&
         errors == 0) {
         char mode_str[2] = { (char)stripped[0], '\0' };
 
@@ -988,7 +960,7 @@ static void acars_parse_fallback(const uint8_t *data, int len, int ul,
             }
         }
 
-        hub_emit_acars(mode_str, reg, ack_c, label, bid, block_end,
+        hub_emit_acars(o, mode_str, reg, ack_c, label, bid, block_end,
                        ul, txt, txt_len, flight, msg_num, msg_num_seq,
                        errors, timestamp, frequency, magnitude,
                        hdr, hdr_len);
@@ -999,7 +971,8 @@ static void acars_parse_fallback(const uint8_t *data, int len, int ul,
 
 /* ---- SBD extraction ---- */
 
-static void sbd_output_raw(const uint8_t *data, int len, int ul,
+static void sbd_output_raw(acars_out_t *o,
+                            const uint8_t *data, int len, int ul,
                             uint64_t timestamp, double frequency)
 {
     if (acars_enabled)
@@ -1008,39 +981,213 @@ static void sbd_output_raw(const uint8_t *data, int len, int ul,
     char ts_buf[32];
     format_timestamp(timestamp, ts_buf, sizeof(ts_buf));
 
-    printf("SBD: %s %s ", ts_buf, ul ? "UL" : "DL");
+    out_printf(o, "SBD: %s %s ", ts_buf, ul ? "UL" : "DL");
     for (int i = 0; i < len && i < 64; i++)
-        printf("%02x", data[i]);
+        out_printf(o, "%02x", data[i]);
     if (len > 64)
-        printf("...");
-    printf(" | ");
+        out_printf(o, "...");
+    out_printf(o, " | ");
     for (int i = 0; i < len && i < 64; i++) {
         char c = (char)data[i];
-        printf("%c", (c >= 0x20 && c < 0x7f) ? c : '.');
+        out_printf(o, "%c", (c >= 0x20 && c < 0x7f) ? c : '.');
     }
-    printf("\n");
-    fflush(stdout);
+    out_printf(o, "\n");
 }
 
-static void sbd_process(const uint8_t *sbd_data, int sbd_len, int ul,
-                         uint64_t timestamp, double frequency,
-                         float magnitude)
+/* ---- Decode worker pool ----
+ *
+ * Completed SBD payloads are copied into jobs and decoded (libacars
+ * parsing and all formatting) on a small pool of worker threads, so a
+ * heavy ARINC-622 message does not hold up IDA reassembly. Every job
+ * gets a sequence number; finished jobs wait in a reorder window and are
+ * flushed strictly in sequence, so output order is the order in which
+ * messages completed reassembly. ACARS jobs are routed to a worker by
+ * aircraft registration, which keeps all blocks of a multi-block message
+ * on the worker that owns its libacars reassembly context. With
+ * --acars-threads=0 jobs run inline on the caller's thread. */
+
+#define ACARS_POOL_MAX   8
+#define ACARS_REORDER    256    /* jobs in flight, power of two */
+
+#ifdef HAVE_LIBACARS
+#define ACARS_POOL_DEFAULT 2
+#else
+#define ACARS_POOL_DEFAULT 0    /* the fallback parser is cheap */
+#endif
+
+typedef struct {
+    uint64_t seq;
+    int ul;
+    uint64_t timestamp;
+    double frequency;
+    float magnitude;
+    int len;
+    acars_out_t out;
+    uint8_t data[SBD_MAX_DATA];
+} acars_job_t;
+
+typedef struct {
+    pthread_t thread;
+    Blocking_Queue queue;
+#ifdef HAVE_LIBACARS
+    la_reasm_ctx *reasm;
+#endif
+} acars_worker_t;
+
+static acars_worker_t workers[ACARS_POOL_MAX];
+static int n_workers = 0;
+static acars_worker_t inline_worker;
+static acars_job_t inline_job;
+
+static pthread_mutex_t seq_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t seq_cond = PTHREAD_COND_INITIALIZER;
+static acars_job_t *reorder[ACARS_REORDER];
+static uint64_t next_seq = 0;
+static uint64_t next_emit = 0;
+static int flushing = 0;            /* a job_done() is writing a run */
+
+static void job_run(acars_job_t *job, acars_worker_t *w)
 {
+    acars_out_t *o = &job->out;
+
     /* Try ACARS first (marker byte 0x01) */
-    if (sbd_len > 2 && sbd_data[0] == 0x01) {
+    if (job->len > 2 && job->data[0] == 0x01) {
 #ifdef HAVE_LIBACARS
-        acars_parse_libacars(sbd_data, sbd_len, ul, timestamp,
-                             frequency, magnitude);
+        acars_parse_libacars(o, w->reasm, job->data, job->len, job->ul,
+                             job->timestamp, job->frequency, job->magnitude);
 #else
-        acars_parse_fallback(sbd_data, sbd_len, ul, timestamp,
-                             frequency, magnitude);
+        (void)w;
+        acars_parse_fallback(o, job->data, job->len, job->ul,
+                             job->timestamp, job->frequency, job->magnitude);
 #endif
         return;
     }
 
     /* Non-ACARS SBD: show raw in text mode */
-    if (sbd_len > 0)
-        sbd_output_raw(sbd_data, sbd_len, ul, timestamp, frequency);
+    if (job->len > 0)
+        sbd_output_raw(o, job->data, job->len, job->ul,
+                       job->timestamp, job->frequency);
+}
+
+/* Sequencer: park a finished job, then flush every job that is next.
+ * One thread at a time is the flusher. It detaches the ready run under
+ * seq_lock and writes it (stdout, UDP, feed) after unlocking, so other
+ * workers can park their jobs meanwhile; a worker that finds a flusher
+ * active leaves its job for it. next_emit only advances once a run is
+ * written, which keeps its slots reserved and acars_shutdown() waiting
+ * for the output. */
+static void job_done(acars_job_t *job)
+{
+    acars_job_t *run[ACARS_REORDER];
+
+    pthread_mutex_lock(&seq_lock);
+    reorder[job->seq & (ACARS_REORDER - 1)] = job;
+    if (flushing) {
+        pthread_mutex_unlock(&seq_lock);
+        return;
+    }
+    flushing = 1;
+
+    for (;;) {
+        int n = 0;
+        acars_job_t *j;
+        while (n < ACARS_REORDER &&
+               (j = reorder[(next_emit + n) & (ACARS_REORDER - 1)]) != NULL) {
+            reorder[(next_emit + n) & (ACARS_REORDER - 1)] = NULL;
+            run[n++] = j;
+        }
+        if (n == 0)
+            break;
+        pthread_mutex_unlock(&seq_lock);
+
+        for (int i = 0; i < n; i++) {
+            out_flush(&run[i]->out);
+            free(run[i]->out.buf);
+            free(run[i]);
+        }
+
+        pthread_mutex_lock(&seq_lock);
+        next_emit += n;
+        pthread_cond_broadcast(&seq_cond);
+    }
+
+    flushing = 0;
+    pthread_mutex_unlock(&seq_lock);
+}
+
+static void *acars_worker_thread(void *arg)
+{
+    acars_worker_t *w = (acars_worker_t *)arg;
+    while (1) {
+        acars_job_t *job;
+        if (blocking_queue_take(&w->queue, &job) != 0)
+            break;
+        job_run(job, w);
+        job_done(job);
+    }
+    return NULL;
+}
+
+/* Registration bytes pick the worker; other SBD spreads round-robin */
+static int job_worker(const acars_job_t *job)
+{
+    const uint8_t *p = job->data + 1;
+    int n = job->len - 1;
+    if (job->data[0] != 0x01)
+        return (int)(job->seq % n_workers);
+    if (n >= 8 && p[0] == 0x03) {
+        p += 8;
+        n -= 8;
+    }
+    uint32_t h = 2166136261u;
+    for (int i = 1; i < 8 && i < n; i++)
+        h = (h ^ (p[i] & 0x7f)) * 16777619u;
+    return (int)(h % n_workers);
+}
+
+static void sbd_process(const uint8_t *sbd_data, int sbd_len, int ul,
+                         uint64_t timestamp, double frequency,
+                         float magnitude)
+{
+    if (sbd_len <= 0 || sbd_len > SBD_MAX_DATA)
+        return;
+
+    /* A copy from another beam or a retransmission: already output */
+    if (sbd_len > 2 && sbd_data[0] == 0x01 &&
+        acars_dedup_check(sbd_data, sbd_len, ul, timestamp)) {
+        log_msg(LOGC_ACARS, LOGL_DEBUG,
+                "ACARS: duplicate %s message at %.0f Hz suppressed",
+                ul ? "uplink" : "downlink", frequency);
+        return;
+    }
+
+    /* Pin the wall-clock reference here, before workers format times */
+    ts_ensure_init(timestamp);
+
+    acars_job_t *job = n_workers > 0 ? calloc(1, sizeof(*job)) : &inline_job;
+    if (!job)
+        return;
+    job->ul = ul;
+    job->timestamp = timestamp;
+    job->frequency = frequency;
+    job->magnitude = magnitude;
+    job->len = sbd_len;
+    memcpy(job->data, sbd_data, sbd_len);
+
+    if (n_workers == 0) {
+        job_run(job, &inline_worker);
+        out_flush(&job->out);
+        return;
+    }
+
+    job->out.last = SIZE_MAX;
+    pthread_mutex_lock(&seq_lock);
+    while (next_seq - next_emit >= ACARS_REORDER)
+        pthread_cond_wait(&seq_cond, &seq_lock);
+    job->seq = next_seq++;
+    pthread_mutex_unlock(&seq_lock);
+
+    blocking_queue_put(&workers[job_worker(job)].queue, job);
 }
 
 static void sbd_expire(uint64_t now_ns)
@@ -1224,6 +1371,7 @@ void acars_init(const char *station_id, const char **udp_hosts,
 {
     station = station_id;
     memset(sbd_multi, 0, sizeof(sbd_multi));
+    acars_dedup_init(acars_dedup_sec);
     if (!crc_initialized)
         crc16_init();
 
@@ -1246,7 +1394,7 @@ void acars_init(const char *station_id, const char **udp_hosts,
             continue;
         }
         udp_fds[udp_count] = fd;
-        udp_addrs[udp_count] = addr;
+        udp_batch_init(&udp_batches[udp_count], fd, &addr);
         udp_count++;
         fprintf(stderr, "ACARS: UDP JSON stream -> %s:%d\n",
                 udp_hosts[i], udp_ports[i]);
@@ -1267,6 +1415,7 @@ void acars_init(const char *station_id, const char **udp_hosts,
                 close(hub_fd);
                 hub_fd = -1;
             } else {
+                udp_batch_init(&hub_batch, hub_fd, &hub_addr);
                 fprintf(stderr, "ACARS: acarshub UDP stream -> %s:%d\n",
                         hub_host, hub_port);
             }
@@ -1275,48 +1424,99 @@ void acars_init(const char *station_id, const char **udp_hosts,
 
     /* airframes.io direct feed (iridium-toolkit format, TCP) */
     if (af_host && af_port > 0) {
-        airframes_saved_host = strdup(af_host);
-        airframes_saved_port = af_port;
-        airframes_fd = airframes_connect(af_host, af_port);
-        if (airframes_fd >= 0)
-            fprintf(stderr, "ACARS: airframes TCP stream -> %s:%d\n",
-                    af_host, af_port);
-        else
-            fprintf(stderr, "ACARS: airframes %s:%d connect failed "
-                    "(will retry on first message)\n", af_host, af_port);
+        if (airframes_feed_init(af_host, af_port) != 0)
+            fprintf(stderr, "acars_init: cannot start airframes feeder\n");
     }
 
 #ifdef HAVE_LIBACARS
     la_config_set_int("acars_bearer", LA_ACARS_BEARER_SATCOM);
-    reasm_ctx = la_reasm_ctx_new();
+    inline_worker.reasm = la_reasm_ctx_new();
     fprintf(stderr, "ACARS: libacars %s (ARINC-622/ADS-C/CPDLC decoding)\n",
             LA_VERSION);
 #endif
+
+    /* Decode worker pool (see "Decode worker pool" above) */
+    inline_job.out.last = SIZE_MAX;
+    n_workers = acars_threads < 0 ? ACARS_POOL_DEFAULT : acars_threads;
+    if (n_workers > ACARS_POOL_MAX)
+        n_workers = ACARS_POOL_MAX;
+    for (int i = 0; i < n_workers; i++) {
+        acars_worker_t *w = &workers[i];
+        blocking_queue_init(&w->queue, ACARS_REORDER);
+#ifdef HAVE_LIBACARS
+        w->reasm = la_reasm_ctx_new();
+#endif
+        if (pthread_create(&w->thread, NULL, acars_worker_thread, w) != 0) {
+            perror("acars_init: pthread_create");
+            blocking_queue_destroy(&w->queue);
+            n_workers = i;
+            break;
+        }
+#ifdef __linux__
+        char name[16];
+        snprintf(name, sizeof(name), "acars-%d", i);
+        pthread_setname_np(w->thread, name);
+#endif
+    }
+    if (n_workers > 0)
+        fprintf(stderr, "ACARS: %d decode worker%s\n", n_workers,
+                n_workers == 1 ? "" : "s");
+}
+
+void acars_tick(void)
+{
+    for (int i = 0; i < udp_count; i++) {
+        if (udp_fds[i] >= 0)
+            udp_batch_tick(&udp_batches[i]);
+    }
+    if (hub_fd >= 0)
+        udp_batch_tick(&hub_batch);
 }
 
 void acars_shutdown(void)
 {
+    /* Finish queued decodes while the outputs are still open. Closed
+     * queues refuse takes, so wait until the sequencer has flushed every
+     * job first. */
+    pthread_mutex_lock(&seq_lock);
+    while (n_workers > 0 && next_emit != next_seq)
+        pthread_cond_wait(&seq_cond, &seq_lock);
+    pthread_mutex_unlock(&seq_lock);
+
+    for (int i = 0; i < n_workers; i++) {
+        acars_worker_t *w = &workers[i];
+        blocking_queue_close(&w->queue);
+        pthread_join(w->thread, NULL);
+        blocking_queue_destroy(&w->queue);
+#ifdef HAVE_LIBACARS
+        la_reasm_ctx_destroy(w->reasm);
+        w->reasm = NULL;
+#endif
+    }
+    n_workers = 0;
+    free(inline_job.out.buf);
+    inline_job.out.buf = NULL;
+    inline_job.out.len = inline_job.out.cap = 0;
+
     for (int i = 0; i < udp_count; i++) {
         if (udp_fds[i] >= 0) {
+            udp_batch_destroy(&udp_batches[i]);
             close(udp_fds[i]);
             udp_fds[i] = -1;
         }
     }
     udp_count = 0;
     if (hub_fd >= 0) {
+        udp_batch_destroy(&hub_batch);
         close(hub_fd);
         hub_fd = -1;
     }
-    if (airframes_fd >= 0) {
-        close(airframes_fd);
-        airframes_fd = -1;
-    }
-    free(airframes_saved_host);
-    airframes_saved_host = NULL;
+    airframes_feed_shutdown();
+    acars_dedup_shutdown();
 #ifdef HAVE_LIBACARS
-    if (reasm_ctx) {
-        la_reasm_ctx_destroy(reasm_ctx);
-        reasm_ctx = NULL;
+    if (inline_worker.reasm) {
+        la_reasm_ctx_destroy(inline_worker.reasm);
+        inline_worker.reasm = NULL;
     }
     la_config_destroy();
 #endif
@@ -1342,8 +1542,19 @@ void acars_print_stats(void)
     if (stat_sbd_multi_frag > 0 || stat_sbd_broken > 0)
         fprintf(stderr, "SBD: %d multi-pkt fragments, %d broken/orphan\n",
                 stat_sbd_multi_frag, stat_sbd_broken);
-    fprintf(stderr, "ACARS: %d messages decoded", stat_acars_total);
-    if (stat_acars_errors > 0)
-        fprintf(stderr, " (%d with errors)", stat_acars_errors);
+    fprintf(stderr, "ACARS: %d messages decoded", atomic_load(&stat_acars_total));
+    if (atomic_load(&stat_acars_errors) > 0)
+        fprintf(stderr, " (%d with errors)", atomic_load(&stat_acars_errors));
     fprintf(stderr, "\n");
+
+    uint64_t lookups, hits, evicted;
+    acars_dedup_stats(&lookups, &hits, &evicted);
+    if (lookups > 0) {
+        fprintf(stderr, "ACARS: %llu duplicates suppressed of %llu messages",
+                (unsigned long long)hits, (unsigned long long)lookups);
+        if (evicted > 0)
+            fprintf(stderr, " (%llu cache evictions)",
+                    (unsigned long long)evicted);
+        fprintf(stderr, "\n");
+    }
 }
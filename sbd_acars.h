@@ -31,7 +31,11 @@ void acars_ida_cb(const uint8_t *data, int len,
                   ir_direction_t direction, float magnitude,
                   void *user);
 
-/* Shut down ACARS subsystem (free libacars resources). */
+/* Send queued UDP datagrams once they are older than the batch deadline.
+ * Called periodically from the stats thread. */
+void acars_tick(void);
+
+/* Shut down ACARS subsystem (flush UDP, free libacars resources). */
 void acars_shutdown(void);
 
 /* Print SBD/ACARS stats summary to stderr. */
@@ -0,0 +1,191 @@
+/*
+ * Shared-memory frame ring for local consumers (--shm)
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Shared-memory frame ring -- writer side (single producer)
+ */
+
+#define _GNU_SOURCE
+#include <inttypes.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "shm_ring.h"
+#include "frame_bin.h"
+
+static shm_ring_header_t *ring = NULL;
+static uint8_t *ring_data = NULL;
+static size_t ring_map_size = 0;
+static char *ring_name = NULL;
+
+/* Does a running writer still own the object? A ring its writer closed,
+ * or whose writer process is gone, may be replaced. */
+static int name_in_use(const char *name)
+{
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0)
+        return 0;
+
+    struct stat st;
+    int in_use = 0;
+    if (fstat(fd, &st) == 0 && st.st_size >= SHM_RING_HEADER_SIZE) {
+        void *map = mmap(NULL, SHM_RING_HEADER_SIZE, PROT_READ, MAP_SHARED,
+                         fd, 0);
+        if (map != MAP_FAILED) {
+            shm_ring_header_t *h = map;
+            pid_t pid = (pid_t)h->writer_pid;
+            in_use = memcmp(h->magic, SHM_RING_MAGIC, 4) == 0 &&
+                     !atomic_load(&h->closed) && pid > 0 &&
+                     (kill(pid, 0) == 0 || errno == EPERM);
+            munmap(map, SHM_RING_HEADER_SIZE);
+        }
+    }
+    close(fd);
+    return in_use;
+}
+
+int shm_ring_writer_open(const char *name, size_t capacity,
+                         const char *file_info)
+{
+    size_t cap = 4096;
+    while (cap < capacity)
+        cap <<= 1;
+
+    if (name_in_use(name)) {
+        errno = EADDRINUSE;
+        return -1;
+    }
+
+    /* A stale object from a crashed run would have the wrong layout */
+    shm_unlink(name);
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0)
+        return -1;
+
+    ring_map_size = SHM_RING_HEADER_SIZE + cap;
+    if (ftruncate(fd, ring_map_size) != 0) {
+        int e = errno;
+        close(fd);
+        shm_unlink(name);
+        errno = e;
+        return -1;
+    }
+
+    void *map = mmap(NULL, ring_map_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        int e = errno;
+        shm_unlink(name);
+        errno = e;
+        return -1;
+    }
+
+    ring = (shm_ring_header_t *)map;
+    ring_data = (uint8_t *)map + SHM_RING_HEADER_SIZE;
+    ring_name = strdup(name);
+
+    memset(ring, 0, sizeof(*ring));
+    ring->version = SHM_RING_VERSION;
+    ring->capacity = cap;
+    ring->writer_pid = (uint32_t)getpid();
+    if (file_info)
+        snprintf(ring->file_info, sizeof(ring->file_info), "%s", file_info);
+
+    /* Magic last: readers reject a half-initialised header */
+    atomic_thread_fence(memory_order_release);
+    memcpy(ring->magic, SHM_RING_MAGIC, 4);
+    return 0;
+}
+
+void shm_ring_writer_publish(const uint8_t *rec, uint32_t len)
+{
+    if (!ring)
+        return;
+
+    uint64_t cap = ring->capacity;
+    uint64_t esize = shm_ring_entry_size(len);
+    if (esize > cap / 2)
+        return;
+
+    /* Stream t0 and file_info follow the same rule as frame_output.c */
+    if (!atomic_load_explicit(&ring->ready, memory_order_relaxed)) {
+        uint64_t ts = fb_get64(rec + 4);
+        ring->t0 = (ts / 1000000000ULL) * 1000000000ULL;
+        if (ring->file_info[0] == '\0')
+            snprintf(ring->file_info, sizeof(ring->file_info),
+                     "i-%" PRIu64 "-t1", (uint64_t)(ring->t0 / 1000000000ULL));
+        atomic_store_explicit(&ring->ready, 1, memory_order_release);
+    }
+
+    uint64_t pos = atomic_load_explicit(&ring->write_pos, memory_order_relaxed);
+    uint64_t off = pos & (cap - 1);
+    uint64_t pad = (off + esize > cap) ? cap - off : 0;
+    uint64_t end = pos + pad + esize;
+
+    /* Step the tail past the entries this one overwrites, so a lapped
+     * reader can resume at the oldest one left */
+    if (end > cap) {
+        uint64_t tail = atomic_load_explicit(&ring->tail_pos,
+                                             memory_order_relaxed);
+        while (tail < pos && tail < end - cap) {
+            uint64_t t_off = tail & (cap - 1);
+            uint32_t t_len;
+            memcpy(&t_len, ring_data + t_off, 4);
+            tail += t_len == SHM_RING_WRAP ? cap - t_off
+                                           : shm_ring_entry_size(t_len);
+        }
+        atomic_store_explicit(&ring->tail_pos, tail, memory_order_release);
+    }
+
+    /* Claim the space first so readers can detect being overwritten */
+    atomic_store_explicit(&ring->reserve_pos, end, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    if (pad) {
+        uint32_t wrap = SHM_RING_WRAP;
+        memcpy(ring_data + off, &wrap, 4);
+        off = 0;
+    }
+    memcpy(ring_data + off, &len, 4);
+    memcpy(ring_data + off + 4, rec, len);
+
+    atomic_store_explicit(&ring->write_pos, end, memory_order_release);
+    atomic_fetch_add_explicit(&ring->n_records, 1, memory_order_relaxed);
+
+    atomic_fetch_add(&ring->seq, 1);
+#ifdef __linux__
+    if (atomic_load(&ring->waiters) > 0)
+        shm_ring_futex_wake(&ring->seq);
+#endif
+}
+
+uint64_t shm_ring_writer_count(void)
+{
+    return ring ? atomic_load(&ring->n_records) : 0;
+}
+
+void shm_ring_writer_close(void)
+{
+    if (!ring)
+        return;
+
+    atomic_store(&ring->closed, 1);
+    atomic_fetch_add(&ring->seq, 1);
+#ifdef __linux__
+    shm_ring_futex_wake(&ring->seq);
+#endif
+
+    /* Attached readers keep their mapping; new ones can no longer open */
+    shm_unlink(ring_name);
+    munmap(ring, ring_map_size);
+    free(ring_name);
+    ring = NULL;
+    ring_data = NULL;
+    ring_name = NULL;
+}
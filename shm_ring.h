@@ -0,0 +1,277 @@
+/*
+ * Shared-memory frame ring for local consumers (--shm)
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Shared-memory frame ring for local consumers
+ *
+ * iridium-sniffer publishes every demodulated frame into a POSIX shared
+ * memory object (shm_open) as a binary frame record (frame_bin.h). Any
+ * number of readers on the same host can attach; each keeps its own read
+ * position. The writer never waits for readers: a reader that falls more
+ * than one ring behind is resynchronised to the oldest entry still in
+ * the ring and told how many bytes it missed.
+ *
+ * Layout: a 4 KiB header page followed by `capacity` bytes of data
+ * (a power of two). Each entry is a u32 record length followed by the
+ * frame_bin record, padded to 8 bytes. An entry never wraps; a length of
+ * SHM_RING_WRAP means "continue at offset 0".
+ *
+ * The writer advances tail_pos past every entry it is about to overwrite,
+ * then reserve_pos, before touching the data, and write_pos after it. A reader copies an entry out, then checks reserve_pos to see
+ * whether the writer could have overwritten it meanwhile (seqlock style).
+ * On Linux readers sleep on the `seq` futex; the writer only issues a
+ * wake-up when a reader has announced itself in `waiters`.
+ *
+ * This header also contains the reader API, so a consumer needs only
+ * shm_ring.h and frame_bin.h (see examples/shm_reader.c):
+ *
+ *   shm_ring_reader_t r;
+ *   if (shm_ring_reader_open(&r, "/iridium-sniffer") == 0)
+ *       while ((n = shm_ring_reader_next(&r, rec, sizeof(rec), 1000)) >= 0)
+ *           if (n > 0) frame_bin_decode_frame(rec, n, &frame);
+ */
+
+#ifndef __SHM_RING_H__
+#define __SHM_RING_H__
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#define SHM_RING_MAGIC          "IRSH"
+#define SHM_RING_VERSION        1
+#define SHM_RING_DEFAULT_NAME   "/iridium-sniffer"
+#define SHM_RING_DEFAULT_SIZE   (16 * 1024 * 1024)
+#define SHM_RING_HEADER_SIZE    4096
+#define SHM_RING_WRAP           0xffffffffu
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint64_t capacity;              /* data bytes, power of two */
+    uint64_t t0;                    /* stream t0 (ns), as in frame_bin.h */
+    char file_info[256];
+    uint32_t writer_pid;
+    atomic_uint closed;             /* set when the writer exits */
+    atomic_uint ready;              /* t0/file_info are valid */
+    uint8_t pad0[60];
+
+    /* Writer cache line */
+    atomic_uint_least64_t reserve_pos;
+    atomic_uint_least64_t write_pos;
+    atomic_uint_least64_t n_records;
+    atomic_uint_least64_t tail_pos; /* oldest entry not yet overwritten */
+    uint8_t pad1[32];
+
+    /* Wake-up: readers futex-wait on seq */
+    atomic_uint seq;
+    atomic_uint waiters;
+} shm_ring_header_t;
+
+static inline uint64_t shm_ring_entry_size(uint32_t rec_len)
+{
+    return (4 + (uint64_t)rec_len + 7) & ~(uint64_t)7;
+}
+
+#ifdef __linux__
+static inline void shm_ring_futex_wait(atomic_uint *addr, unsigned val,
+                                       int timeout_ms)
+{
+    struct timespec ts = { timeout_ms / 1000, (timeout_ms % 1000) * 1000000L };
+    syscall(SYS_futex, (unsigned *)addr, FUTEX_WAIT, val, &ts, NULL, 0);
+}
+
+static inline void shm_ring_futex_wake(atomic_uint *addr)
+{
+    syscall(SYS_futex, (unsigned *)addr, FUTEX_WAKE, 0x7fffffff, NULL, NULL, 0);
+}
+#endif
+
+/* ---- Reader ---- */
+
+typedef struct {
+    shm_ring_header_t *hdr;
+    const uint8_t *data;
+    size_t map_size;
+    uint64_t capacity;
+    uint64_t pos;
+    int writable;               /* can register as a futex waiter */
+    uint64_t overruns;          /* times the writer lapped us */
+    uint64_t skipped_bytes;     /* data lost to overruns */
+} shm_ring_reader_t;
+
+/* Attach to a ring. Reading starts at the newest data. Returns 0 on
+ * success, -1 with errno set (EPROTO for a layout mismatch). */
+static inline int shm_ring_reader_open(shm_ring_reader_t *r, const char *name)
+{
+    memset(r, 0, sizeof(*r));
+
+    /* Read-write when permitted so we can sleep on the futex; read-only
+     * readers poll instead */
+    int fd = shm_open(name, O_RDWR, 0);
+    r->writable = fd >= 0;
+    if (fd < 0)
+        fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0)
+        return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < SHM_RING_HEADER_SIZE) {
+        close(fd);
+        errno = EPROTO;
+        return -1;
+    }
+
+    int prot = PROT_READ | (r->writable ? PROT_WRITE : 0);
+    void *map = mmap(NULL, st.st_size, prot, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return -1;
+
+    r->hdr = (shm_ring_header_t *)map;
+    r->map_size = st.st_size;
+    r->capacity = r->hdr->capacity;
+    if (memcmp(r->hdr->magic, SHM_RING_MAGIC, 4) != 0 ||
+        r->hdr->version != SHM_RING_VERSION ||
+        SHM_RING_HEADER_SIZE + r->capacity != (uint64_t)st.st_size ||
+        (r->capacity & (r->capacity - 1)) != 0) {
+        munmap(map, st.st_size);
+        errno = EPROTO;
+        return -1;
+    }
+
+    r->data = (const uint8_t *)map + SHM_RING_HEADER_SIZE;
+    r->pos = atomic_load_explicit(&r->hdr->write_pos, memory_order_acquire);
+    return 0;
+}
+
+/* The writer lapped us: continue at the oldest entry it has not yet
+ * overwritten, or at the newest data if that is somehow behind us */
+static inline void shm_ring_reader_resync(shm_ring_reader_t *r)
+{
+    uint64_t to = atomic_load_explicit(&r->hdr->tail_pos, memory_order_acquire);
+    if (to <= r->pos)
+        to = atomic_load_explicit(&r->hdr->write_pos, memory_order_acquire);
+    r->overruns++;
+    r->skipped_bytes += to - r->pos;
+    r->pos = to;
+}
+
+/* Copy the next frame_bin record into buf. Returns its length, 0 if
+ * nothing arrived within timeout_ms, or -1 once the writer has closed
+ * the ring and everything has been read. */
+static inline int shm_ring_reader_next(shm_ring_reader_t *r, uint8_t *buf,
+                                       size_t buf_size, int timeout_ms)
+{
+    shm_ring_header_t *h = r->hdr;
+    uint64_t mask = r->capacity - 1;
+    int waited = 0;
+
+    for (;;) {
+        uint64_t wp = atomic_load_explicit(&h->write_pos, memory_order_acquire);
+
+        if (wp == r->pos) {
+            if (atomic_load(&h->closed))
+                return -1;
+            if (waited)
+                return 0;
+            waited = 1;
+#ifdef __linux__
+            if (r->writable) {
+                unsigned seq = atomic_load(&h->seq);
+                atomic_fetch_add(&h->waiters, 1);
+                if (atomic_load(&h->write_pos) == r->pos && !atomic_load(&h->closed))
+                    shm_ring_futex_wait(&h->seq, seq, timeout_ms);
+                atomic_fetch_sub(&h->waiters, 1);
+                continue;
+            }
+#endif
+            /* Poll for up to timeout_ms */
+            for (int t = 0; t < timeout_ms; t++) {
+                usleep(1000);
+                if (atomic_load(&h->write_pos) != r->pos || atomic_load(&h->closed))
+                    break;
+            }
+            continue;
+        }
+
+        if (wp - r->pos > r->capacity) {
+            shm_ring_reader_resync(r);
+            continue;
+        }
+
+        uint64_t off = r->pos & mask;
+        uint32_t len;
+        memcpy(&len, r->data + off, 4);
+
+        if (len == SHM_RING_WRAP) {
+            r->pos += r->capacity - off;
+            continue;
+        }
+
+        uint64_t esize = shm_ring_entry_size(len);
+        int fits = off + esize <= r->capacity && len <= buf_size;
+        if (fits)
+            memcpy(buf, r->data + off + 4, len);
+
+        /* Did the writer reserve space over what we just copied? */
+        atomic_thread_fence(memory_order_acquire);
+        uint64_t res = atomic_load_explicit(&h->reserve_pos, memory_order_relaxed);
+        if (res - r->pos > r->capacity || off + esize > r->capacity) {
+            shm_ring_reader_resync(r);
+            continue;
+        }
+
+        r->pos += esize;
+        if (!fits) {
+            /* Intact, but larger than the caller's buffer */
+            r->skipped_bytes += esize;
+            continue;
+        }
+        return (int)len;
+    }
+}
+
+static inline void shm_ring_reader_close(shm_ring_reader_t *r)
+{
+    if (r->hdr)
+        munmap(r->hdr, r->map_size);
+    r->hdr = NULL;
+}
+
+/* ---- Writer (iridium-sniffer side, shm_ring.c) ---- */
+
+/* Create the shared-memory object, replacing one left by a writer that
+ * has exited. capacity is rounded up to a power of two. Returns 0 on
+ * success, -1 with errno set (EADDRINUSE if a running writer owns the
+ * name). */
+int shm_ring_writer_open(const char *name, size_t capacity,
+                         const char *file_info);
+
+/* Publish one frame_bin record; never blocks. The first record fixes
+ * the stream t0 (and file_info, if none was given) like the binary
+ * stdout stream does. */
+void shm_ring_writer_publish(const uint8_t *rec, uint32_t len);
+
+/* Mark the ring closed, wake readers and unlink the object */
+void shm_ring_writer_close(void);
+
+/* Records published so far */
+uint64_t shm_ring_writer_count(void);
+
+#endif
@@ -16,6 +16,8 @@
 #include <SoapySDR/Version.h>
 
 #include "sdr.h"
+#include "sample_pool.h"
+#include "logging.h"
 
 extern sig_atomic_t running;
 extern pid_t self_pid;
@@ -254,6 +256,13 @@ void *soapy_stream_thread(void *arg) {
     if (mtu == 0)
         mtu = 65536;
 
+    /* Sample size per IQ pair depends on format. The block size is only
+     * known now, still before the first sample, so size the pool here. */
+    size_t sample_size = (sample_mode == 0) ? 2 * sizeof(int8_t)
+                                            : 2 * sizeof(float);
+    if (sample_pool_init(mtu * sample_size) != 0)
+        errx(1, "Cannot allocate sample buffers");
+
     if (SoapySDRDevice_activateStream(device, stream, 0, 0, 0) != 0)
         errx(1, "Unable to activate SoapySDR stream: %s", SoapySDRDevice_lastError());
 
@@ -264,16 +273,15 @@ void *soapy_stream_thread(void *arg) {
             errx(1, "Unable to allocate CS16 buffer");
     }
 
-    /* Sample size per IQ pair depends on format */
-    size_t sample_size = (sample_mode == 0) ? 2 * sizeof(int8_t)
-                                            : 2 * sizeof(float);
+    /* Read target while the sample pool is exhausted, so the device
+     * keeps being drained */
+    void *overflow_buf = malloc(mtu * sample_size);
+    if (overflow_buf == NULL)
+        errx(1, "Unable to allocate SoapySDR receive buffer");
 
     while (running) {
-        sample_buf_t *s = malloc(sizeof(*s) + mtu * sample_size);
-        if (s == NULL) {
-            warnx("Unable to allocate sample buffer");
-            break;
-        }
+        sample_buf_t *s = sample_buf_get(mtu * sample_size, 0);
+        void *dst = s ? (void *)s->samples : overflow_buf;
 
         void *buffs[1];
         int ret;
@@ -283,44 +291,38 @@ void *soapy_stream_thread(void *arg) {
             buffs[0] = cs16_buf;
             ret = SoapySDRDevice_readStream(device, stream, buffs, mtu,
                                              &flags, &time_ns, 100000);
-            if (ret > 0)
-                soapy_cs16_to_float(cs16_buf, (float *)s->samples, ret);
-        } else if (sample_mode == 1) {
-            /* CF32 direct */
-            buffs[0] = s->samples;
-            ret = SoapySDRDevice_readStream(device, stream, buffs, mtu,
-                                             &flags, &time_ns, 100000);
+            if (ret > 0 && s)
+                soapy_cs16_to_float(cs16_buf, (float *)dst, ret);
         } else {
-            /* CS8 direct */
-            buffs[0] = s->samples;
+            /* CF32 or CS8 direct */
+            buffs[0] = dst;
             ret = SoapySDRDevice_readStream(device, stream, buffs, mtu,
                                              &flags, &time_ns, 100000);
         }
 
         if (ret < 0) {
-            if (ret == SOAPY_SDR_TIMEOUT) {
-                free(s);
+            sample_buf_release(s);
+            if (ret == SOAPY_SDR_TIMEOUT)
                 continue;
-            }
             if (ret == SOAPY_SDR_OVERFLOW) {
-                if (verbose)
-                    warnx("SoapySDR overflow");
-                free(s);
+                log_msg(LOGC_SDR, LOGL_INFO, "SoapySDR overflow");
                 continue;
             }
             warnx("SoapySDR read error: %d", ret);
-            free(s);
             break;
         }
+        if (s == NULL)
+            continue;
 
         s->format = (sample_mode == 0) ? SAMPLE_FMT_INT8 : SAMPLE_FMT_FLOAT;
         s->num = ret;
         if (running)
             push_samples(s);
         else
-            free(s);
+            sample_buf_release(s);
     }
 
+    free(overflow_buf);
     free(cs16_buf);
 
     SoapySDRDevice_deactivateStream(device, stream, 0, 0);
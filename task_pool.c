@@ -0,0 +1,301 @@
+/*
+ * Work-stealing task pool for the per-burst pipeline stages
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Work-stealing task pool -- fixed-size Chase-Lev deques (the C11
+ * formulation of Le, Pop, Cohen and Zappa Nardelli, PPoPP 2013)
+ */
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "task_pool.h"
+#include "lf_queue.h"
+#include "logging.h"
+#include "thread_place.h"
+
+#define DEQUE_MASK   (TASK_DEQUE_SIZE - 1)
+#define STEAL_RETRY  4
+
+typedef struct {
+    task_fn_t fn;
+    void *arg;
+} task_t;
+
+/* Returned by deque_steal() when it lost a race and should be retried */
+#define STEAL_ABORT ((task_t *)1)
+
+typedef struct {
+    _Atomic(task_t *) buf[TASK_DEQUE_SIZE];
+    atomic_llong top __attribute__((aligned(LFQ_CACHELINE)));
+    atomic_llong bottom __attribute__((aligned(LFQ_CACHELINE)));
+} task_deque_t;
+
+struct task_worker {
+    task_deque_t dq;
+    task_pool_t *pool;
+    void *ctx;
+    int id;
+    unsigned rng;
+    pthread_t thread;
+};
+
+struct task_pool {
+    task_worker_t *workers;
+    int n;
+    task_source_t source;
+    pthread_mutex_t start_lock;
+    pthread_cond_t start_cond;
+    int start;                  /* 0 until every worker exists, then 1; -1 aborts */
+    atomic_ulong n_tasks;
+    atomic_ulong n_stolen;
+};
+
+/* ---- Deque ---- */
+
+/* Owner only. Returns -1 when full. */
+static int deque_push(task_deque_t *d, task_t *t)
+{
+    long long b = atomic_load_explicit(&d->bottom, memory_order_relaxed);
+    long long top = atomic_load_explicit(&d->top, memory_order_acquire);
+    if (b - top >= TASK_DEQUE_SIZE)
+        return -1;
+    atomic_store_explicit(&d->buf[b & DEQUE_MASK], t, memory_order_relaxed);
+    atomic_store_explicit(&d->bottom, b + 1, memory_order_release);
+    return 0;
+}
+
+/* Owner only: newest task, or NULL */
+static task_t *deque_take(task_deque_t *d)
+{
+    long long b = atomic_load_explicit(&d->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&d->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long long t = atomic_load_explicit(&d->top, memory_order_relaxed);
+
+    task_t *x = NULL;
+    if (t <= b) {
+        x = atomic_load_explicit(&d->buf[b & DEQUE_MASK], memory_order_relaxed);
+        if (t == b) {
+            /* Last task: race any thief for it */
+            if (!atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1,
+                    memory_order_seq_cst, memory_order_relaxed))
+                x = NULL;
+            atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+        }
+    } else {
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+    }
+    return x;
+}
+
+/* Any thread: oldest task, NULL if empty, or STEAL_ABORT */
+static task_t *deque_steal(task_deque_t *d)
+{
+    long long t = atomic_load_explicit(&d->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long long b = atomic_load_explicit(&d->bottom, memory_order_acquire);
+    if (t >= b)
+        return NULL;
+
+    task_t *x = atomic_load_explicit(&d->buf[t & DEQUE_MASK],
+                                     memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1,
+            memory_order_seq_cst, memory_order_relaxed))
+        return STEAL_ABORT;
+    return x;
+}
+
+/* ---- Workers ---- */
+
+static void run_task(task_worker_t *w, task_t *t)
+{
+    task_fn_t fn = t->fn;
+    void *arg = t->arg;
+    free(t);
+    fn(w, arg);
+}
+
+/* Visit the other workers from a random start; NULL if all were empty */
+static task_t *steal_any(task_worker_t *w)
+{
+    task_pool_t *p = w->pool;
+    if (p->n < 2)
+        return NULL;
+
+    w->rng = w->rng * 1103515245u + 12345u;
+    int start = (int)((w->rng >> 16) % (unsigned)p->n);
+    for (int k = 0; k < p->n; k++) {
+        task_worker_t *v = &p->workers[(start + k) % p->n];
+        if (v == w)
+            continue;
+        for (int r = 0; r < STEAL_RETRY; r++) {
+            task_t *t = deque_steal(&v->dq);
+            if (t == STEAL_ABORT)
+                continue;
+            if (t) {
+                atomic_fetch_add_explicit(&p->n_stolen, 1,
+                                          memory_order_relaxed);
+                return t;
+            }
+            break;
+        }
+    }
+    return NULL;
+}
+
+static void *worker_thread(void *arg)
+{
+    task_worker_t *w = arg;
+    task_pool_t *p = w->pool;
+
+    pthread_mutex_lock(&p->start_lock);
+    while (p->start == 0)
+        pthread_cond_wait(&p->start_cond, &p->start_lock);
+    int start = p->start;
+    pthread_mutex_unlock(&p->start_lock);
+    if (start < 0)
+        return NULL;
+
+    for (;;) {
+        task_t *t = deque_take(&w->dq);
+        if (!t)
+            t = steal_any(w);
+        if (t) {
+            run_task(w, t);
+            continue;
+        }
+
+        task_fn_t fn;
+        void *fn_arg;
+        if (p->source(&fn, &fn_arg) != 0)
+            break;
+        atomic_fetch_add_explicit(&p->n_tasks, 1, memory_order_relaxed);
+        fn(w, fn_arg);
+    }
+
+    /* Source exhausted: help drain whatever the others still hold */
+    task_t *t;
+    while ((t = steal_any(w)) != NULL)
+        run_task(w, t);
+    return NULL;
+}
+
+/* ---- Public API ---- */
+
+void task_spawn(task_worker_t *w, task_fn_t fn, void *arg)
+{
+    atomic_fetch_add_explicit(&w->pool->n_tasks, 1, memory_order_relaxed);
+    task_t *t = malloc(sizeof(*t));
+    if (t) {
+        t->fn = fn;
+        t->arg = arg;
+        if (deque_push(&w->dq, t) == 0)
+            return;
+        free(t);
+    }
+    fn(w, arg);
+}
+
+void *task_worker_ctx(task_worker_t *w)
+{
+    return w->ctx;
+}
+
+static void pool_free(task_pool_t *p)
+{
+    pthread_cond_destroy(&p->start_cond);
+    pthread_mutex_destroy(&p->start_lock);
+    free(p->workers);
+    free(p);
+}
+
+task_pool_t *task_pool_create(int n, task_source_t source, void **ctx)
+{
+    task_pool_t *p = calloc(1, sizeof(*p));
+    if (!p)
+        return NULL;
+    if (posix_memalign((void **)&p->workers, LFQ_CACHELINE,
+                       sizeof(task_worker_t) * n) != 0) {
+        free(p);
+        return NULL;
+    }
+    p->n = n;
+    p->source = source;
+    pthread_mutex_init(&p->start_lock, NULL);
+    pthread_cond_init(&p->start_cond, NULL);
+    atomic_init(&p->n_tasks, 0);
+    atomic_init(&p->n_stolen, 0);
+
+    for (int i = 0; i < n; i++) {
+        task_worker_t *w = &p->workers[i];
+        for (int k = 0; k < TASK_DEQUE_SIZE; k++)
+            atomic_init(&w->dq.buf[k], NULL);
+        atomic_init(&w->dq.top, 0);
+        atomic_init(&w->dq.bottom, 0);
+        w->pool = p;
+        w->ctx = ctx ? ctx[i] : NULL;
+        w->id = i;
+        w->rng = 0x9e3779b9u * (unsigned)(i + 1);
+    }
+
+    /* Workers wait for the whole pool, so a failed create can still
+     * join the ones already running */
+    int started = 0;
+    for (; started < n; started++) {
+        task_worker_t *w = &p->workers[started];
+        if (pthread_create(&w->thread, NULL, worker_thread, w) != 0)
+            break;
+        /* Room for any int; at most TASK_POOL_MAX_WORKERS keeps it
+         * within the 15 characters a Linux thread name allows */
+        char name[24];
+        snprintf(name, sizeof(name), "worker-%d", started);
+#ifdef __linux__
+        pthread_setname_np(w->thread, name);
+#endif
+        thread_place_apply(w->thread, ROLE_WORKER, name);
+    }
+
+    pthread_mutex_lock(&p->start_lock);
+    p->start = started == n ? 1 : -1;
+    pthread_cond_broadcast(&p->start_cond);
+    pthread_mutex_unlock(&p->start_lock);
+    if (started == n)
+        return p;
+
+    log_msg(LOGC_MAIN, LOGL_ERROR, "task pool: cannot start worker %d of %d",
+            started, n);
+    for (int i = 0; i < started; i++)
+        pthread_join(p->workers[i].thread, NULL);
+    pool_free(p);
+    return NULL;
+}
+
+void task_pool_join(task_pool_t *p)
+{
+    for (int i = 0; i < p->n; i++)
+        pthread_join(p->workers[i].thread, NULL);
+    log_msg(LOGC_MAIN, LOGL_INFO, "task pool: %lu tasks on %d workers, "
+            "%lu stolen", atomic_load(&p->n_tasks), p->n,
+            atomic_load(&p->n_stolen));
+    pool_free(p);
+}
+
+int task_pool_default_workers(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN) - 1;
+    if (n < 1)
+        n = 1;
+    if (n > TASK_POOL_MAX_WORKERS)
+        n = TASK_POOL_MAX_WORKERS;
+    return (int)n;
+}
@@ -0,0 +1,59 @@
+/*
+ * Work-stealing task pool for the per-burst pipeline stages
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Work-stealing task pool for the per-burst pipeline stages
+ *
+ * A fixed set of worker threads, each with its own Chase-Lev deque of
+ * tasks. A running task hands its follow-up work (downmix -> demod ->
+ * decode) to task_spawn(), which pushes onto the calling worker's deque;
+ * the owner pops from the bottom, so the next stage of a burst runs on
+ * the same core while its data is still in cache. An idle worker steals
+ * from the top of another worker's deque, and only when every deque is
+ * empty does it ask the pool's source for new work (burst_queue). The
+ * source may block.
+ *
+ * Each worker carries one context pointer (its downmix state), fixed at
+ * creation, so tasks never share per-stage scratch buffers.
+ */
+
+#ifndef __TASK_POOL_H__
+#define __TASK_POOL_H__
+
+#include <stdatomic.h>
+
+#define TASK_POOL_MAX_WORKERS 64
+#define TASK_DEQUE_SIZE       256   /* per worker, power of two */
+
+typedef struct task_worker task_worker_t;
+typedef struct task_pool task_pool_t;
+
+typedef void (*task_fn_t)(task_worker_t *w, void *arg);
+
+/* Fetch the next external task. Returns 0 with fn and arg set, or -1
+ * once the source is exhausted; the worker then exits. */
+typedef int (*task_source_t)(task_fn_t *fn, void **arg);
+
+/* Start n workers; ctx[i] becomes worker i's context. Returns NULL if
+ * allocation fails or a worker thread cannot be started; any workers
+ * already started have exited by then. */
+task_pool_t *task_pool_create(int n, task_source_t source, void **ctx);
+
+/* Run fn(arg) later on this worker or a thief. If the deque is full the
+ * task runs immediately instead. */
+void task_spawn(task_worker_t *w, task_fn_t fn, void *arg);
+
+void *task_worker_ctx(task_worker_t *w);
+
+/* Wait for every worker to see the source exhausted and finish its
+ * tasks, then free the pool */
+void task_pool_join(task_pool_t *p);
+
+/* Default worker count: online CPUs less one for the detector, at least 1 */
+int task_pool_default_workers(void);
+
+#endif
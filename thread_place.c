@@ -0,0 +1,150 @@
+/*
+ * Thread placement: CPU affinity and real-time scheduling per role
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Thread placement: CPU affinity and real-time scheduling per role
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "thread_place.h"
+
+static const char *role_names[ROLE_COUNT] = {
+    "sdr", "detector", "worker", "stats", "output",
+};
+
+/* CPU list as given, for the report; NULL = not pinned */
+static char *role_cpus[ROLE_COUNT];
+#ifdef __linux__
+static cpu_set_t role_sets[ROLE_COUNT];
+#endif
+static int rt_prio = 0;
+
+/* ---- Parsing ---- */
+
+#ifdef __linux__
+static int parse_cpu_list(const char *s, cpu_set_t *set)
+{
+    CPU_ZERO(set);
+    while (*s) {
+        char *end;
+        long lo = strtol(s, &end, 10);
+        long hi = lo;
+        if (end == s || lo < 0)
+            return -1;
+        if (*end == '-') {
+            s = end + 1;
+            hi = strtol(s, &end, 10);
+            if (end == s || hi < lo)
+                return -1;
+        }
+        if (hi >= CPU_SETSIZE)
+            return -1;
+        for (long c = lo; c <= hi; c++)
+            CPU_SET((int)c, set);
+        if (*end == ',')
+            end++;
+        else if (*end != '\0')
+            return -1;
+        s = end;
+    }
+    return CPU_COUNT(set) > 0 ? 0 : -1;
+}
+#endif
+
+int thread_place_parse(const char *spec)
+{
+    const char *eq = strchr(spec, '=');
+    if (!eq || eq[1] == '\0')
+        return -1;
+
+    int role;
+    size_t len = (size_t)(eq - spec);
+    for (role = 0; role < ROLE_COUNT; role++)
+        if (strlen(role_names[role]) == len &&
+            strncmp(spec, role_names[role], len) == 0)
+            break;
+    if (role == ROLE_COUNT)
+        return -1;
+
+#ifdef __linux__
+    if (parse_cpu_list(eq + 1, &role_sets[role]) != 0)
+        return -1;
+#endif
+    free(role_cpus[role]);
+    role_cpus[role] = strdup(eq + 1);
+    return 0;
+}
+
+void thread_place_set_realtime(int prio)
+{
+    rt_prio = prio;
+}
+
+/* ---- Applying ---- */
+
+static int role_prio(thread_role_t role)
+{
+    if (rt_prio <= 0)
+        return 0;
+    if (role == ROLE_SDR)
+        return rt_prio;
+    if (role == ROLE_DETECTOR)
+        return rt_prio - 1;
+    return 0;
+}
+
+void thread_place_apply(pthread_t t, thread_role_t role, const char *name)
+{
+    int prio = role_prio(role);
+    if (!role_cpus[role] && prio == 0)
+        return;
+
+    /* One line per thread, kept whole if two threads report at once */
+    flockfile(stderr);
+    fprintf(stderr, "placement: %s (%s):", name, role_names[role]);
+
+    if (role_cpus[role]) {
+#ifdef __linux__
+        int r = pthread_setaffinity_np(t, sizeof(cpu_set_t), &role_sets[role]);
+        if (r == 0)
+            fprintf(stderr, " cpus %s", role_cpus[role]);
+        else
+            fprintf(stderr, " cpus %s not applied (%s)", role_cpus[role],
+                    strerror(r));
+#else
+        (void)t;
+        fprintf(stderr, " cpus %s not applied (unsupported on this "
+                "platform)", role_cpus[role]);
+#endif
+    }
+
+    if (prio > 0) {
+        struct sched_param sp = { .sched_priority = prio };
+        int r = pthread_setschedparam(t, SCHED_FIFO, &sp);
+        if (r == 0)
+            fprintf(stderr, " SCHED_FIFO %d", prio);
+        else
+            fprintf(stderr, " SCHED_FIFO %d not applied (%s%s)", prio,
+                    strerror(r),
+                    r == EPERM ? "; needs CAP_SYS_NICE or an rtprio limit"
+                               : "");
+    }
+
+    fprintf(stderr, "\n");
+    funlockfile(stderr);
+}
+
+void thread_place_self(thread_role_t role, const char *name)
+{
+    thread_place_apply(pthread_self(), role, name);
+}
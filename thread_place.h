@@ -0,0 +1,51 @@
+/*
+ * Thread placement: CPU affinity and real-time scheduling per role
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Thread placement: CPU affinity and real-time scheduling per role
+ *
+ * --cpu-affinity=ROLE=CPUS pins every thread of a role to a CPU set, and
+ * --realtime[=PRIO] runs the SDR reader at SCHED_FIFO PRIO and the burst
+ * detector at PRIO - 1, so a USB callback can always preempt the
+ * detector. Roles without a setting are left to the scheduler.
+ *
+ * Placement is best effort. A CPU set the system rejects, or SCHED_FIFO
+ * without CAP_SYS_NICE (or an RLIMIT_RTPRIO allowance), is reported and
+ * the thread carries on unplaced. Each placed thread reports what was
+ * actually applied when it starts.
+ */
+
+#ifndef __THREAD_PLACE_H__
+#define __THREAD_PLACE_H__
+
+#include <pthread.h>
+
+typedef enum {
+    ROLE_SDR = 0,       /* SDR reader or file reader */
+    ROLE_DETECTOR,
+    ROLE_WORKER,        /* task pool: downmix, demod, decode */
+    ROLE_STATS,
+    ROLE_OUTPUT,        /* output sink workers */
+    ROLE_COUNT
+} thread_role_t;
+
+#define THREAD_PLACE_DEFAULT_PRIO 50
+
+/* Parse one ROLE=CPUS spec, CPUS like 0-3,8. Returns 0 or -1. */
+int thread_place_parse(const char *spec);
+
+/* SCHED_FIFO priority for the SDR (prio) and detector (prio - 1) */
+void thread_place_set_realtime(int prio);
+
+/* Place thread t according to its role and report the result under
+ * name. Does nothing if the role has no setting. */
+void thread_place_apply(pthread_t t, thread_role_t role, const char *name);
+
+/* Same, for the calling thread (threads created by SDR libraries) */
+void thread_place_self(thread_role_t role, const char *name);
+
+#endif
@@ -0,0 +1,125 @@
+/*
+ * Batched UDP datagram sender
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Batched UDP datagram sender -- sendmmsg() with count/age/size triggers
+ */
+
+#define _GNU_SOURCE
+#include <string.h>
+#include <time.h>
+
+#include "udp_batch.h"
+
+static unsigned long batch_now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+void udp_batch_init(udp_batch_t *b, int fd, const struct sockaddr_in *addr)
+{
+    memset(b, 0, sizeof(*b));
+    b->fd = fd;
+    b->addr = *addr;
+    pthread_mutex_init(&b->lock, NULL);
+}
+
+/* ---- Sending ---- */
+
+static void batch_flush_locked(udp_batch_t *b)
+{
+    if (b->count == 0)
+        return;
+
+#ifdef __linux__
+    struct mmsghdr msgs[UDP_BATCH_MAX];
+    memset(msgs, 0, sizeof(msgs[0]) * b->count);
+    for (int i = 0; i < b->count; i++) {
+        msgs[i].msg_hdr.msg_name = &b->addr;
+        msgs[i].msg_hdr.msg_namelen = sizeof(b->addr);
+        msgs[i].msg_hdr.msg_iov = &b->iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int sent = 0;
+    while (sent < b->count) {
+        int r = sendmmsg(b->fd, &msgs[sent], b->count - sent, 0);
+        b->n_syscalls++;
+        /* Best effort, like sendto(): skip a datagram the kernel refuses */
+        sent += (r > 0) ? r : 1;
+    }
+#else
+    for (int i = 0; i < b->count; i++) {
+        sendto(b->fd, b->iov[i].iov_base, b->iov[i].iov_len, 0,
+               (struct sockaddr *)&b->addr, sizeof(b->addr));
+        b->n_syscalls++;
+    }
+#endif
+
+    b->n_datagrams += b->count;
+    b->count = 0;
+    b->used = 0;
+}
+
+void udp_batch_send(udp_batch_t *b, const void *data, size_t len)
+{
+    if (b->fd < 0)
+        return;
+
+    pthread_mutex_lock(&b->lock);
+
+    if (len > UDP_BATCH_BYTES) {
+        batch_flush_locked(b);
+        sendto(b->fd, data, len, 0,
+               (struct sockaddr *)&b->addr, sizeof(b->addr));
+        b->n_datagrams++;
+        b->n_syscalls++;
+        pthread_mutex_unlock(&b->lock);
+        return;
+    }
+
+    if (b->used + len > UDP_BATCH_BYTES)
+        batch_flush_locked(b);
+
+    unsigned long now = batch_now_ms();
+    if (b->count == 0)
+        b->first_ms = now;
+
+    memcpy(b->buf + b->used, data, len);
+    b->iov[b->count].iov_base = b->buf + b->used;
+    b->iov[b->count].iov_len = len;
+    b->used += len;
+    b->count++;
+
+    if (b->count == UDP_BATCH_MAX || now - b->first_ms >= UDP_BATCH_MS)
+        batch_flush_locked(b);
+
+    pthread_mutex_unlock(&b->lock);
+}
+
+void udp_batch_tick(udp_batch_t *b)
+{
+    pthread_mutex_lock(&b->lock);
+    if (b->count > 0 && batch_now_ms() - b->first_ms >= UDP_BATCH_MS)
+        batch_flush_locked(b);
+    pthread_mutex_unlock(&b->lock);
+}
+
+void udp_batch_flush(udp_batch_t *b)
+{
+    pthread_mutex_lock(&b->lock);
+    batch_flush_locked(b);
+    pthread_mutex_unlock(&b->lock);
+}
+
+void udp_batch_destroy(udp_batch_t *b)
+{
+    udp_batch_flush(b);
+    pthread_mutex_destroy(&b->lock);
+}
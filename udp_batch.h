@@ -0,0 +1,65 @@
+/*
+ * Batched UDP datagram sender
+ *
+ * Copyright (c) 2026 CEMAXECUTER LLC
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Batched UDP datagram sender
+ *
+ * Datagrams for one destination are copied into a per-socket batch and
+ * sent together with a single sendmmsg() call once UDP_BATCH_MAX are
+ * queued, the arena is full, or the oldest queued datagram is older than
+ * UDP_BATCH_MS. Datagram boundaries and order are preserved. Callers also
+ * tick the batch periodically so a quiet stream is not held back, and
+ * flush it before closing the socket. Platforms without sendmmsg() fall
+ * back to one sendto() per datagram.
+ */
+
+#ifndef __UDP_BATCH_H__
+#define __UDP_BATCH_H__
+
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#define UDP_BATCH_MAX    32             /* datagrams per sendmmsg() */
+#define UDP_BATCH_BYTES  (64 * 1024)    /* arena for queued payloads */
+#define UDP_BATCH_MS     20             /* max age of a queued datagram */
+
+typedef struct {
+    int fd;
+    struct sockaddr_in addr;
+    pthread_mutex_t lock;
+
+    int count;
+    size_t used;
+    unsigned long first_ms;
+    uint8_t buf[UDP_BATCH_BYTES];
+    struct iovec iov[UDP_BATCH_MAX];
+
+    unsigned long n_datagrams;
+    unsigned long n_syscalls;
+} udp_batch_t;
+
+/* Attach a batch to an open UDP socket and destination */
+void udp_batch_init(udp_batch_t *b, int fd, const struct sockaddr_in *addr);
+
+/* Queue one datagram, sending the batch if it is full or stale.
+ * Datagrams larger than UDP_BATCH_BYTES are sent on their own. */
+void udp_batch_send(udp_batch_t *b, const void *data, size_t len);
+
+/* Send the batch if its oldest datagram is older than UDP_BATCH_MS */
+void udp_batch_tick(udp_batch_t *b);
+
+/* Send everything queued now */
+void udp_batch_flush(udp_batch_t *b);
+
+/* Flush and release the batch (the socket is left open) */
+void udp_batch_destroy(udp_batch_t *b);
+
+#endif
@@ -14,6 +14,7 @@
 #include <uhd.h>
 
 #include "sdr.h"
+#include "sample_pool.h"
 
 extern sig_atomic_t running;
 extern pid_t self_pid;
@@ -181,21 +182,31 @@ void *usrp_stream_thread(void *arg) {
         errx(1, "Error opening RX stream: %u", error);
 
     uhd_rx_streamer_max_num_samps(rx_handle, &num_samples);
+    /* The block size is only known now, still before the first sample,
+     * so size the pool here */
+    if (sample_pool_init(num_samples * 2 * sizeof(int8_t)) != 0)
+        errx(1, "Cannot allocate sample buffers");
+    int8_t *overflow_buf = malloc(num_samples * 2 * sizeof(int8_t));
+    if (overflow_buf == NULL)
+        errx(1, "Unable to allocate USRP receive buffer");
     uhd_rx_streamer_issue_stream_cmd(rx_handle, &stream_cmd);
 
     while (running) {
-        sample_buf_t *s = malloc(sizeof(*s) + num_samples * 2 * sizeof(int8_t));
-        s->format = SAMPLE_FMT_INT8;
-        buf = s->samples;
+        sample_buf_t *s = sample_buf_get(num_samples * 2 * sizeof(int8_t), 0);
+        /* Pool exhausted: still read, so the device does not overflow */
+        buf = s ? (void *)s->samples : (void *)overflow_buf;
         uhd_rx_streamer_recv(rx_handle, &buf, num_samples, &md, 3.0, false, &num_rx_samples);
         uhd_rx_metadata_error_code(md, &error_code);
         if (error_code != UHD_RX_METADATA_ERROR_CODE_NONE && error_code != 8)
             errx(1, "Error during streaming: %u", error_code);
+        if (s == NULL)
+            continue;
+        s->format = SAMPLE_FMT_INT8;
         s->num = num_rx_samples;
         if (running)
             push_samples(s);
         else
-            free(s);
+            sample_buf_release(s);
     }
 
     stream_cmd.stream_mode = UHD_STREAM_MODE_STOP_CONTINUOUS;
@@ -203,6 +214,7 @@ void *usrp_stream_thread(void *arg) {
 
     uhd_rx_streamer_free(&rx_handle);
     uhd_rx_metadata_free(&md);
+    free(overflow_buf);
 
     return NULL;
 }
@@ -36,6 +36,7 @@
 
 #include "web_map.h"
 #include "ida_decode.h"
+#include "json_writer.h"
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -364,72 +365,77 @@ void mtpos_ida_cb(const uint8_t *data, int len,
 
 static int build_json(char *buf, int bufsize)
 {
+    json_writer_t jw;
+    jw_init(&jw, buf, bufsize);
+
     pthread_mutex_lock(&state.lock);
 
-    int off = 0;
-    off += snprintf(buf + off, bufsize - off,
-                    "{\"total_ira\":%lu,\"total_ibc\":%lu,\"total_pages\":%lu,"
-                    "\"total_beams\":%lu,\"total_mt\":%lu,",
-                    state.total_ira, state.total_ibc, state.total_pages,
-                    state.total_beams, state.total_mt);
+    jw_object_begin(&jw);
+    jw_kv_uint(&jw, "total_ira", state.total_ira);
+    jw_kv_uint(&jw, "total_ibc", state.total_ibc);
+    jw_kv_uint(&jw, "total_pages", state.total_pages);
+    jw_kv_uint(&jw, "total_beams", state.total_beams);
+    jw_kv_uint(&jw, "total_mt", state.total_mt);
 
     /* Satellite orbital positions (most recent first, max 500) */
-    off += snprintf(buf + off, bufsize - off, "\"ra\":[");
-    int n_out = 0;
-    for (int i = 0; i < state.ra_count && n_out < 500; i++) {
+    jw_key(&jw, "ra");
+    jw_array_begin(&jw);
+    for (int i = 0; i < state.ra_count && i < 500; i++) {
+        if (jw_avail(&jw) < 512) break;
         int idx = (state.ra_head - 1 - i + MAX_RA_POINTS) % MAX_RA_POINTS;
         ra_point_t *p = &state.ra[idx];
-        if (n_out > 0) off += snprintf(buf + off, bufsize - off, ",");
-        off += snprintf(buf + off, bufsize - off,
-            "{\"lat\":%.4f,\"lon\":%.4f,\"alt\":%d,"
-            "\"sat\":%d,\"beam\":%d,\"pages\":%d,"
-            "\"tmsi\":%u,\"freq\":%.0f,\"t\":%llu}",
-            p->lat, p->lon, p->alt,
-            p->sat_id, p->beam_id, p->n_pages,
-            p->tmsi, p->frequency,
-            (unsigned long long)(p->timestamp / 1000000000ULL));
-        n_out++;
-        if (off >= bufsize - 512) break;
+        jw_object_begin(&jw);
+        jw_kv_double(&jw, "lat", p->lat, 4);
+        jw_kv_double(&jw, "lon", p->lon, 4);
+        jw_kv_int(&jw, "alt", p->alt);
+        jw_kv_int(&jw, "sat", p->sat_id);
+        jw_kv_int(&jw, "beam", p->beam_id);
+        jw_kv_int(&jw, "pages", p->n_pages);
+        jw_kv_uint(&jw, "tmsi", p->tmsi);
+        jw_kv_double(&jw, "freq", p->frequency, 0);
+        jw_kv_uint(&jw, "t", p->timestamp / 1000000000ULL);
+        jw_object_end(&jw);
     }
-    off += snprintf(buf + off, bufsize - off, "],");
+    jw_array_end(&jw);
 
     /* Ground beam positions (most recent first, max 300) */
-    off += snprintf(buf + off, bufsize - off, "\"beams\":[");
-    n_out = 0;
-    for (int i = 0; i < state.beam_count && n_out < 300; i++) {
+    jw_key(&jw, "beams");
+    jw_array_begin(&jw);
+    for (int i = 0; i < state.beam_count && i < 300; i++) {
+        if (jw_avail(&jw) < 512) break;
         int idx = (state.beam_head - 1 - i + MAX_BEAM_POINTS) % MAX_BEAM_POINTS;
         beam_point_t *p = &state.beams[idx];
-        if (n_out > 0) off += snprintf(buf + off, bufsize - off, ",");
-        off += snprintf(buf + off, bufsize - off,
-            "{\"lat\":%.4f,\"lon\":%.4f,\"alt\":%d,"
-            "\"sat\":%d,\"beam\":%d,\"pages\":%d,"
-            "\"tmsi\":%u,\"freq\":%.0f,\"t\":%llu}",
-            p->lat, p->lon, p->alt,
-            p->sat_id, p->beam_id, p->n_pages,
-            p->tmsi, p->frequency,
-            (unsigned long long)(p->timestamp / 1000000000ULL));
-        n_out++;
-        if (off >= bufsize - 512) break;
+        jw_object_begin(&jw);
+        jw_kv_double(&jw, "lat", p->lat, 4);
+        jw_kv_double(&jw, "lon", p->lon, 4);
+        jw_kv_int(&jw, "alt", p->alt);
+        jw_kv_int(&jw, "sat", p->sat_id);
+        jw_kv_int(&jw, "beam", p->beam_id);
+        jw_kv_int(&jw, "pages", p->n_pages);
+        jw_kv_uint(&jw, "tmsi", p->tmsi);
+        jw_kv_double(&jw, "freq", p->frequency, 0);
+        jw_kv_uint(&jw, "t", p->timestamp / 1000000000ULL);
+        jw_object_end(&jw);
     }
-    off += snprintf(buf + off, bufsize - off, "],");
+    jw_array_end(&jw);
 
     /* MT phone/terminal positions (most recent first, max 200) */
-    off += snprintf(buf + off, bufsize - off, "\"mt\":[");
-    n_out = 0;
-    for (int i = 0; i < state.mt_count && n_out < 200; i++) {
+    jw_key(&jw, "mt");
+    jw_array_begin(&jw);
+    for (int i = 0; i < state.mt_count && i < 200; i++) {
+        if (jw_avail(&jw) < 512) break;
         int idx = (state.mt_head - 1 - i + MAX_MT_POINTS) % MAX_MT_POINTS;
         mt_point_t *p = &state.mt[idx];
-        if (n_out > 0) off += snprintf(buf + off, bufsize - off, ",");
-        off += snprintf(buf + off, bufsize - off,
-            "{\"lat\":%.4f,\"lon\":%.4f,\"alt\":%d,"
-            "\"type\":%u,\"freq\":%.0f,\"t\":%llu}",
-            p->lat, p->lon, p->alt,
-            (unsigned)p->msg_type, p->frequency,
-            (unsigned long long)(p->timestamp / 1000000000ULL));
-        n_out++;
-        if (off >= bufsize - 512) break;
+        jw_object_begin(&jw);
+        jw_kv_double(&jw, "lat", p->lat, 4);
+        jw_kv_double(&jw, "lon", p->lon, 4);
+        jw_kv_int(&jw, "alt", p->alt);
+        jw_kv_uint(&jw, "type", p->msg_type);
+        jw_kv_double(&jw, "freq", p->frequency, 0);
+        jw_kv_uint(&jw, "t", p->timestamp / 1000000000ULL);
+        jw_object_end(&jw);
     }
-    off += snprintf(buf + off, bufsize - off, "],");
+    jw_array_end(&jw);
 
     /* Active satellites (only those seen in last 15 minutes) */
     uint64_t max_ts = 0;
@@ -439,31 +445,34 @@ static int build_json(char *buf, int bufsize)
     }
     uint64_t sat_window = 15ULL * 60 * 1000000000ULL;  /* 15 minutes in ns */
 
-    off += snprintf(buf + off, bufsize - off, "\"sats\":[");
-    int first_sat = 1;
+    jw_key(&jw, "sats");
+    jw_array_begin(&jw);
     for (int i = 0; i < state.n_sats; i++) {
         if (max_ts > sat_window && state.sats[i].last_seen < max_ts - sat_window)
             continue;
-        if (!first_sat) off += snprintf(buf + off, bufsize - off, ",");
-        off += snprintf(buf + off, bufsize - off,
-            "{\"id\":%d,\"beam\":%d,\"count\":%d}",
-            state.sats[i].sat_id, state.sats[i].beam_id,
-            state.sats[i].count);
-        first_sat = 0;
+        if (jw_avail(&jw) < 512) break;
+        jw_object_begin(&jw);
+        jw_kv_int(&jw, "id", state.sats[i].sat_id);
+        jw_kv_int(&jw, "beam", state.sats[i].beam_id);
+        jw_kv_int(&jw, "count", state.sats[i].count);
+        jw_object_end(&jw);
     }
-    off += snprintf(buf + off, bufsize - off, "]");
+    jw_array_end(&jw);
 
     /* Receiver position estimate (Doppler positioning) */
     if (state.rx_valid) {
-        off += snprintf(buf + off, bufsize - off,
-            ",\"rx\":{\"lat\":%.6f,\"lon\":%.6f,\"hdop\":%.1f}",
-            state.rx_lat, state.rx_lon, state.rx_hdop);
+        jw_key(&jw, "rx");
+        jw_object_begin(&jw);
+        jw_kv_double(&jw, "lat", state.rx_lat, 6);
+        jw_kv_double(&jw, "lon", state.rx_lon, 6);
+        jw_kv_double(&jw, "hdop", state.rx_hdop, 1);
+        jw_object_end(&jw);
     }
 
-    off += snprintf(buf + off, bufsize - off, "}");
+    jw_object_end(&jw);
 
     pthread_mutex_unlock(&state.lock);
-    return off;
+    return (int)jw_len(&jw);
 }
 
 /* ---- Embedded HTML/JS ---- */